@@ -47,6 +47,7 @@ MainWindow::MainWindow(const string &modelPath):
 	//menu
 	menuFile= new wxMenu();
 	menuFile->Append(miFileLoad, "Load");
+	menuFile->Append(miFileSave, "Save optimized");
 	menu->Append(menuFile, "File");
 
 	//mode
@@ -151,6 +152,18 @@ void MainWindow::onMenuFileLoad(wxCommandEvent &event){
 	}
 }
 
+//writes the model in the optimized g3d version
+void MainWindow::onMenuFileSave(wxCommandEvent &event){
+	if(model==NULL){
+		return;
+	}
+	
+	wxFileDialog fileDialog(this, "Save optimized", "", "", "G3D files (*.g3d)|*.g3d", wxSAVE | wxOVERWRITE_PROMPT);
+	if(fileDialog.ShowModal()==wxID_OK){
+		model->save(fileDialog.GetPath().c_str());
+	}
+}
+
 void MainWindow::onMenuModeNormals(wxCommandEvent &event){
 	renderer->toggleNormals();
 	menuMode->Check(miModeNormals, renderer->getNormals());
@@ -233,6 +246,7 @@ BEGIN_EVENT_TABLE(MainWindow, wxFrame)
 	EVT_TIMER(-1, MainWindow::onTimer)
 	EVT_CLOSE(MainWindow::onClose)
 	EVT_MENU(miFileLoad, MainWindow::onMenuFileLoad)
+	EVT_MENU(miFileSave, MainWindow::onMenuFileSave)
 
 	EVT_MENU(miModeWireframe, MainWindow::onMenuModeWireframe)
 	EVT_MENU(miModeNormals, MainWindow::onMenuModeNormals)
@@ -276,6 +290,13 @@ END_EVENT_TABLE()
 
 bool App::OnInit(){
 	string modelPath;
+	
+	//g3d_viewer -optimize src.g3d dst.g3d converts without opening a window
+	if(argc==4 && string(argv[1])=="-optimize"){
+		optimizeModel(argv[2], argv[3]);
+		return false;
+	}
+	
 	if(argc==2){
 		modelPath= argv[1];
 	}
@@ -299,6 +320,20 @@ int App::OnExit(){
 	return 0;
 }
 
+//textures are not needed to convert, only their paths
+bool App::optimizeModel(const string &srcPath, const string &dstPath){
+	try{
+		ModelGl model;
+		model.load(srcPath);
+		model.save(dstPath);
+		return true;
+	}
+	catch(const exception &e){
+		wxMessageDialog(NULL, e.what(), "Exception", wxOK | wxICON_ERROR).ShowModal();
+		return false;
+	}
+}
+
 }}//end namespace
 
 IMPLEMENT_APP(Shared::G3dViewer::App)
@@ -34,6 +34,7 @@ public:
 
 	enum MenuId{
 		miFileLoad,
+		miFileSave,
 		miModeWireframe,
 		miModeNormals,
 		miModeGrid,
@@ -75,6 +76,7 @@ public:
 	void onPaint(wxPaintEvent &event);
 	void onClose(wxCloseEvent &event);
 	void onMenuFileLoad(wxCommandEvent &event);
+	void onMenuFileSave(wxCommandEvent &event);
 	void onMenuModeNormals(wxCommandEvent &event);
 	void onMenuModeWireframe(wxCommandEvent &event);
 	void onMenuModeGrid(wxCommandEvent &event);
@@ -120,6 +122,9 @@ public:
 	virtual bool OnInit();
 	virtual int MainLoop();
 	virtual int OnExit();
+
+private:
+	bool optimizeModel(const string &srcPath, const string &dstPath);
 };
 
 }}//end namespace
@@ -146,7 +146,9 @@ void Ai::update(){
 	for(AiRules::iterator it= aiRules.begin(); it!=aiRules.end(); ++it){
 		if((aiInterface->getTimer() % ((*it)->getTestInterval()*GameConstants::updateFps/1000))==0){
 			if((*it)->test()){
-				aiInterface->printLog(3, intToStr(1000*aiInterface->getTimer()/GameConstants::updateFps) + ": Executing rule: " + (*it)->getName() + '\n');
+				if(aiInterface->isLogging(3)){
+					aiInterface->printLog(3, intToStr(1000*aiInterface->getTimer()/GameConstants::updateFps) + ": Executing rule: " + (*it)->getName() + '\n');
+				}
 				(*it)->execute();
 			}
 		}
@@ -157,31 +159,19 @@ void Ai::update(){
 // ==================== state requests ==================== 
 
 int Ai::getCountOfType(const UnitType *ut){
-    int count= 0;
-	for(int i=0; i<aiInterface->getMyUnitCount(); ++i){
-		if(ut == aiInterface->getMyUnit(i)->getType()){
-			count++;
-		}
-	}
-    return count;
+    return aiInterface->getMyAliveUnitCount(ut);
 }
 
 int Ai::getCountOfClass(UnitClass uc){
-    int count= 0;
-    for(int i=0; i<aiInterface->getMyUnitCount(); ++i){
-		if(aiInterface->getMyUnit(i)->getType()->isOfClass(uc)){
-            ++count;
-		}
-    }
-    return count;
+    return aiInterface->getMyAliveUnitCount(uc);
 }
 
 float Ai::getRatioOfClass(UnitClass uc){
-	if(aiInterface->getMyUnitCount()==0){
+	if(aiInterface->getMyAliveUnitCount()==0){
 		return 0;
 	}
 	else{
-		return static_cast<float>(getCountOfClass(uc))/aiInterface->getMyUnitCount();
+		return static_cast<float>(getCountOfClass(uc))/aiInterface->getMyAliveUnitCount();
 	}
 }
 
@@ -212,8 +202,10 @@ bool Ai::beingAttacked(Vec2i &pos, Field &field, int radius){
         if(!aiInterface->isAlly(unit) && unit->isAlive()){
             pos= unit->getPos();
 			field= unit->getCurrField();
-            if(pos.dist(aiInterface->getHomeLocation())<radius){
-                aiInterface->printLog(2, "Being attacked at pos "+intToStr(pos.x)+","+intToStr(pos.y)+"\n");
+            if(pos.sqDist(aiInterface->getHomeLocation())<radius*radius){
+                if(aiInterface->isLogging(2)){
+                    aiInterface->printLog(2, "Being attacked at pos "+intToStr(pos.x)+","+intToStr(pos.y)+"\n");
+                }
                 return true; 
             }
         }
@@ -281,9 +273,12 @@ bool Ai::findPosForBuilding(const UnitType* building, const Vec2i &searchPos, Ve
     
 	const int spacing= 1;
 
+	//each square contains the previous one, so only its border is tested
     for(int currRadius=0; currRadius<maxBuildRadius; ++currRadius){
         for(int i=searchPos.x-currRadius; i<searchPos.x+currRadius; ++i){
-            for(int j=searchPos.y-currRadius; j<searchPos.y+currRadius; ++j){
+			bool borderColumn= i==searchPos.x-currRadius || i==searchPos.x+currRadius-1;
+			int step= borderColumn? 1: 2*currRadius-1;
+            for(int j=searchPos.y-currRadius; j<searchPos.y+currRadius; j+= step){
                 outPos= Vec2i(i, j);
                 if(aiInterface->isFreeCells(outPos-Vec2i(spacing), building->getSize()+spacing*2, fLand)){
                     return true;
@@ -301,7 +296,9 @@ bool Ai::findPosForBuilding(const UnitType* building, const Vec2i &searchPos, Ve
 
 void Ai::addTask(const Task *task){
 	tasks.push_back(task);
-	aiInterface->printLog(2, "Task added: " + task->toString());
+	if(aiInterface->isLogging(2)){
+		aiInterface->printLog(2, "Task added: " + task->toString());
+	}
 }
 
 void Ai::addPriorityTask(const Task *task){
@@ -309,7 +306,9 @@ void Ai::addPriorityTask(const Task *task){
 	tasks.clear();
 
 	tasks.push_back(task);
-	aiInterface->printLog(2, "Priority Task added: " + task->toString());
+	if(aiInterface->isLogging(2)){
+		aiInterface->printLog(2, "Priority Task added: " + task->toString());
+	}
 }
 
 bool Ai::anyTask(){
@@ -326,7 +325,9 @@ const Task *Ai::getTask() const{
 }
 
 void Ai::removeTask(const Task *task){
-	aiInterface->printLog(2, "Task removed: " + task->toString());
+	if(aiInterface->isLogging(2)){
+		aiInterface->printLog(2, "Task removed: " + task->toString());
+	}
 	tasks.remove(task);
 	delete task;
 }
@@ -341,7 +342,7 @@ void Ai::addExpansion(const Vec2i &pos){
 
 	//check if there is a nearby expansion
 	for(Positions::iterator it= expansionPositions.begin(); it!=expansionPositions.end(); ++it){
-		if((*it).dist(pos)<villageRadius){
+		if((*it).sqDist(pos)<villageRadius*villageRadius){
 			return;
 		}
 	}
@@ -376,7 +377,9 @@ void Ai::sendScoutPatrol(){
 	if(aiInterface->getFactionIndex()!=startLoc){
 		if(findAbleUnit(&unit, ccAttack, false)){
 			aiInterface->giveCommand(unit, ccAttack, pos);
-			aiInterface->printLog(2, "Scout patrol sent to: " + intToStr(pos.x)+","+intToStr(pos.y)+"\n"); 
+			if(aiInterface->isLogging(2)){
+				aiInterface->printLog(2, "Scout patrol sent to: " + intToStr(pos.x)+","+intToStr(pos.y)+"\n");
+			}
 		}
 	}
 
@@ -396,7 +399,9 @@ void Ai::massiveAttack(const Vec2i &pos, Field field, bool ultraAttack){
     if(minWarriors<maxMinWarriors){
 		minWarriors+= 3;
 	}
-	aiInterface->printLog(2, "Massive attack to pos: "+ intToStr(pos.x)+", "+intToStr(pos.y)+"\n");
+	if(aiInterface->isLogging(2)){
+		aiInterface->printLog(2, "Massive attack to pos: "+ intToStr(pos.x)+", "+intToStr(pos.y)+"\n");
+	}
 }
 
 void Ai::returnBase(int unitIndex){
@@ -19,6 +19,7 @@
 #include "object.h"
 #include "game.h"
 #include "config.h"
+#include "log_writer.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Util;
@@ -48,6 +49,7 @@ AiInterface::AiInterface(Game &game, int factionIndex, int teamIndex){
 
 	//clear log file
 	if(logLevel>0){
+		LogWriter::getInstance().flush();
 		FILE *f= fopen(getLogFilename().c_str(), "wt");
 		if(f==NULL){
 			throw runtime_error("Can't open file: "+getLogFilename());
@@ -61,9 +63,23 @@ AiInterface::AiInterface(Game &game, int factionIndex, int teamIndex){
 
 void AiInterface::update(){
 	timer++;
+
+	//costs reserved by the last update are spent or refused by now
+	reservations.clear();
 	ai.update();
 }
 
+//gives the commands queued by the last update, always in the world thread
+void AiInterface::flushCommands(){
+	commander->giveCommands(commands);
+	commands.clear();
+
+	for(size_t i=0; i<consoleLines.size(); ++i){
+		console->addLine(consoleLines[i]);
+	}
+	consoleLines.clear();
+}
+
 // ==================== misc ==================== 
 
 void AiInterface::printLog(int logLevel, const string &s){
@@ -71,16 +87,11 @@ void AiInterface::printLog(int logLevel, const string &s){
 		string logString= "(" + intToStr(factionIndex) + ") " + s;
 
 		//print log to file
-		FILE *f= fopen(getLogFilename().c_str(), "at");
-		if(f==NULL){
-			throw runtime_error("Can't open file: "+getLogFilename());
-		}
-		fprintf(f, "%s\n", logString.c_str());
-		fclose(f);
+		LogWriter::getInstance().add(getLogFilename(), logString);
 		
 		//redirect to console
 		if(redir) {
-			console->addLine(logString);
+			consoleLines.push_back(logString);
 		}
     }
 }
@@ -88,20 +99,20 @@ void AiInterface::printLog(int logLevel, const string &s){
 // ==================== interaction ==================== 
 
 CommandResult AiInterface::giveCommand(int unitIndex, CommandClass commandClass, const Vec2i &pos){
-    Command *c= new Command (world->getFaction(factionIndex)->getUnit(unitIndex)->getType()->getFirstCtOfClass(commandClass), pos);
-	return world->getFaction(factionIndex)->getUnit(unitIndex)->giveCommand(c); 
+	const Unit *unit= world->getFaction(factionIndex)->getUnit(unitIndex);
+    return queueCommand(unit, new Command(unit->getType()->getFirstCtOfClass(commandClass), pos));
 }
 
 CommandResult AiInterface::giveCommand(int unitIndex, const CommandType *commandType, const Vec2i &pos){
-    return world->getFaction(factionIndex)->getUnit(unitIndex)->giveCommand(new Command(commandType, pos));
+    return queueCommand(world->getFaction(factionIndex)->getUnit(unitIndex), new Command(commandType, pos));
 }
 
 CommandResult AiInterface::giveCommand(int unitIndex, const CommandType *commandType, const Vec2i &pos, const UnitType *ut){
-    return world->getFaction(factionIndex)->getUnit(unitIndex)->giveCommand(new Command(commandType, pos, ut));
+    return queueCommand(world->getFaction(factionIndex)->getUnit(unitIndex), new Command(commandType, pos, ut));
 }
 
 CommandResult AiInterface::giveCommand(int unitIndex, const CommandType *commandType, Unit *u){
-    return world->getFaction(factionIndex)->getUnit(unitIndex)->giveCommand(new Command(commandType, u));
+    return queueCommand(world->getFaction(factionIndex)->getUnit(unitIndex), new Command(commandType, u));
 }
 
 // ==================== get data ====================  
@@ -126,6 +137,18 @@ int AiInterface::getMyUnitCount() const{
 	return world->getFaction(factionIndex)->getUnitCount();
 }
 
+int AiInterface::getMyAliveUnitCount() const{
+	return world->getFaction(factionIndex)->getAliveUnitCount();
+}
+
+int AiInterface::getMyAliveUnitCount(const UnitType *ut) const{
+	return world->getFaction(factionIndex)->getAliveUnitCount(ut);
+}
+
+int AiInterface::getMyAliveUnitCount(UnitClass uc) const{
+	return world->getFaction(factionIndex)->getAliveUnitCount(uc);
+}
+
 int AiInterface::getMyUpgradeCount() const{
 	return world->getFaction(factionIndex)->getUpgradeManager()->getUpgradeCount();
 }
@@ -182,34 +205,7 @@ const TechTree *AiInterface::getTechTree(){
 }
 
 bool AiInterface::getNearestSightedResource(const ResourceType *rt, const Vec2i &pos, Vec2i &resultPos){
-	float tmpDist;
-
-	float nearestDist= infinity;
-	bool anyResource= false;
-
-	const Map *map= world->getMap();
-
-	for(int i=0; i<map->getW(); ++i){
-		for(int j=0; j<map->getH(); ++j){
-			Vec2i surfPos= Map::toSurfCoords(Vec2i(i, j));
-			
-			//if explored cell
-			if(map->getSurfaceCell(surfPos)->isExplored(teamIndex)){
-				Resource *r= map->getSurfaceCell(surfPos)->getResource(); 
-				
-				//if resource cell
-				if(r!=NULL && r->getType()==rt){
-					tmpDist= pos.dist(Vec2i(i, j));
-					if(tmpDist<nearestDist){
-						anyResource= true;
-						nearestDist= tmpDist;
-						resultPos= Vec2i(i, j);
-					}
-				}
-			}
-		}
-	}
-	return anyResource;
+	return world->getMap()->getResourceIndex()->findNearest(rt, pos, ResourceIndex::noRadius, teamIndex, resultPos);
 }
 
 bool AiInterface::isAlly(const Unit *unit) const{
@@ -224,11 +220,79 @@ bool AiInterface::reqsOk(const CommandType *ct){
 }
 
 bool AiInterface::checkCosts(const ProducibleType *pt){
-	return world->getFaction(factionIndex)->checkCosts(pt);
+	return checkReservedCosts(pt);
 }
 
 bool AiInterface::isFreeCells(const Vec2i &pos, int size, Field field){
-    return world->getMap()->isFreeCells(pos, size, field);
+	const Map *map= world->getMap();
+	map->updateOccupancy();
+    return map->isFreeCells(pos, size, field);
+}
+
+// ==================== PRIVATE ==================== 
+
+//checks the command against the current world and the costs reserved by 
+//the commands already queued, the unit checks it again when it is given
+CommandResult AiInterface::queueCommand(const Unit *unit, Command *command){
+	CommandResult result= unit->checkCommand(command);
+	
+	const ProducibleType *produced= command->getCommandType()->getProduced();
+	const UnitType *built= command->getCommandType()->getClass()==ccBuild? command->getUnitType(): NULL;
+	if(result==crSuccess){
+		if((produced!=NULL && !checkReservedCosts(produced)) || (built!=NULL && !checkReservedCosts(built))){
+			result= crFailRes;
+		}
+	}
+
+	if(result==crSuccess){
+		if(produced!=NULL){
+			reserveCosts(produced);
+		}
+		if(built!=NULL){
+			reserveCosts(built);
+		}
+
+		const UnitType *unitType= command->getUnitType();
+		const Unit *target= command->getUnit();
+		commands.push_back(NetworkCommand(
+			nctGiveCommand, unit->getId(), command->getCommandType()->getId(), command->getPos(), 
+			unitType==NULL? -1: unitType->getId(), target==NULL? Unit::invalidId: target->getId()));
+	}
+	delete command;
+	
+	return result;
+}
+
+//like Faction::checkCosts, but discounting what the queued commands will spend
+bool AiInterface::checkReservedCosts(const ProducibleType *pt) const{
+	const Faction *faction= world->getFaction(factionIndex);
+
+	for(int i=0; i<pt->getCostCount(); ++i){
+		const ResourceType *rt= pt->getCost(i)->getType();
+		int cost= pt->getCost(i)->getAmount();
+		if(cost>0){
+			int available= faction->getResource(rt)->getAmount();
+			Reservations::const_iterator it= reservations.find(rt);
+			if(it!=reservations.end()){
+				available-= it->second;
+			}
+			if(cost>available){
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+//like Faction::applyCosts, but only on the reservations
+void AiInterface::reserveCosts(const ProducibleType *pt){
+	for(int i=0; i<pt->getCostCount(); ++i){
+		const ResourceType *rt= pt->getCost(i)->getType();
+		int cost= pt->getCost(i)->getAmount();
+		if((cost>0 || rt->getClass()!=rcStatic) && rt->getClass()!=rcConsumable){
+			reservations[rt]+= cost;
+		}
+	}
 }
 
 }}//end namespace
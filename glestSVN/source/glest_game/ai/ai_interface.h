@@ -12,12 +12,18 @@
 #ifndef _GLEST_GAME_AIINTERFACE_H_
 #define _GLEST_GAME_AIINTERFACE_H_
 
+#include <vector>
+#include <map>
+
 #include "world.h"
 #include "commander.h"
 #include "command.h"
 #include "conversion.h"
+#include "network_types.h"
 #include "ai.h"
 
+using std::vector;
+using std::map;
 using Shared::Util::intToStr;
 
 namespace Glest{ namespace Game{
@@ -25,10 +31,18 @@ namespace Glest{ namespace Game{
 // =====================================================
 // 	class AiInterface  
 //
-///	The AI will interact with the game through this interface
+///	The AI will interact with the game through this interface. 
+/// update() may run in an AI worker thread, so it only reads the 
+/// world: commands and console lines are queued and given by 
+/// flushCommands() in the thread that updates the world
 // =====================================================
 
 class AiInterface{
+private:
+	typedef vector<NetworkCommand> Commands;
+	typedef vector<string> Lines;
+	typedef map<const ResourceType*, int> Reservations;
+
 private:
     World *world;
     Commander *commander;
@@ -39,6 +53,11 @@ private:
     int factionIndex;
     int teamIndex;
 
+	//queued output
+	Commands commands;
+	Lines consoleLines;
+	Reservations reservations;
+
 	//config
 	bool redir;
     int logLevel;
@@ -48,12 +67,14 @@ public:
 
 	//main
     void update();
+	void flushCommands();
 
 	//get
 	int getTimer() const		{return timer;}
 	int getFactionIndex() const	{return factionIndex;}
 
     //misc
+	bool isLogging(int logLevel) const	{return this->logLevel>=logLevel;}
     void printLog(int logLevel, const string &s);
     
     //interact
@@ -68,6 +89,9 @@ public:
     Vec2i getStartLocation(int locationIndex);
     int getFactionCount();
     int getMyUnitCount() const;
+	int getMyAliveUnitCount() const;
+	int getMyAliveUnitCount(const UnitType *ut) const;
+	int getMyAliveUnitCount(UnitClass uc) const;
 	int getMyUpgradeCount() const;
     int onSightUnitCount();
     const Resource *getResource(const ResourceType *rt);
@@ -85,6 +109,9 @@ public:
 
 private:
 	string getLogFilename() const	{return "ai"+intToStr(factionIndex)+".log";}
+	CommandResult queueCommand(const Unit *unit, Command *command);
+	bool checkReservedCosts(const ProducibleType *pt) const;
+	void reserveCosts(const ProducibleType *pt);
 };
 
 }}//end namespace
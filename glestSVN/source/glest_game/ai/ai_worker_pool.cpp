@@ -0,0 +1,138 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "ai_worker_pool.h"
+
+#include <stdexcept>
+
+#include "ai_interface.h"
+#include "leak_dumper.h"
+
+using namespace std;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class AiWorker
+// =====================================================
+
+AiWorker::AiWorker(AiWorkerPool *pool){
+	this->pool= pool;
+}
+
+void AiWorker::execute(){
+	while(pool->waitJobs()){
+		pool->runJobs();
+		pool->jobsDone();
+	}
+}
+
+// =====================================================
+// 	class AiWorkerPool
+// =====================================================
+
+AiWorkerPool::AiWorkerPool(){
+	stopRequested= false;
+	jobs= NULL;
+	nextJob= 0;
+	failed= false;
+}
+
+AiWorkerPool::~AiWorkerPool(){
+	stopRequested= true;
+	startSemaphore.v(workers.size());
+	for(int i=0; i<workers.size(); ++i){
+		workers[i]->join();
+		delete workers[i];
+	}
+}
+
+void AiWorkerPool::init(int workerCount){
+	for(int i=0; i<workerCount; ++i){
+		AiWorker *worker= new AiWorker(this);
+		worker->start();
+		workers.push_back(worker);
+	}
+}
+
+//updates all the AIs and waits for them, this thread takes jobs too
+void AiWorkerPool::update(const AiInterfaces &aiInterfaces){
+	
+	//not worth waking anyone
+	if(workers.empty() || aiInterfaces.size()<2){
+		for(int i=0; i<aiInterfaces.size(); ++i){
+			aiInterfaces[i]->update();
+		}
+		return;
+	}
+
+	jobs= &aiInterfaces;
+	nextJob= 0;
+	failed= false;
+
+	int wakeCount= aiInterfaces.size()-1;
+	if(wakeCount>workers.size()){
+		wakeCount= workers.size();
+	}
+	startSemaphore.v(wakeCount);
+	runJobs();
+	for(int i=0; i<wakeCount; ++i){
+		doneSemaphore.p();
+	}
+	jobs= NULL;
+
+	if(failed){
+		throw runtime_error("AI error: " + errorMessage);
+	}
+}
+
+bool AiWorkerPool::waitJobs(){
+	startSemaphore.p();
+	return !stopRequested;
+}
+
+void AiWorkerPool::runJobs(){
+	AiInterface *aiInterface;
+	
+	while((aiInterface= takeJob())!=NULL){
+		try{
+			aiInterface->update();
+		}
+		catch(const exception &e){
+			jobMutex.p();
+			if(!failed){
+				failed= true;
+				errorMessage= e.what();
+			}
+			jobMutex.v();
+		}
+	}
+}
+
+void AiWorkerPool::jobsDone(){
+	doneSemaphore.v();
+}
+
+// ==================== PRIVATE ==================== 
+
+AiInterface *AiWorkerPool::takeJob(){
+	AiInterface *aiInterface= NULL;
+	
+	jobMutex.p();
+	if(nextJob<jobs->size()){
+		aiInterface= (*jobs)[nextJob++];
+	}
+	jobMutex.v();
+	
+	return aiInterface;
+}
+
+}}//end namespace
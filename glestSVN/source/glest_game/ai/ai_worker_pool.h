@@ -0,0 +1,91 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_AIWORKERPOOL_H_
+#define _GLEST_GAME_AIWORKERPOOL_H_
+
+#include <vector>
+#include <string>
+
+#include "thread.h"
+
+using std::vector;
+using std::string;
+
+namespace Glest{ namespace Game{
+
+using Shared::Platform::Thread;
+using Shared::Platform::Mutex;
+using Shared::Platform::Semaphore;
+
+class AiInterface;
+class AiWorkerPool;
+
+// =====================================================
+// 	class AiWorker
+// =====================================================
+
+class AiWorker: public Thread{
+private:
+	AiWorkerPool *pool;
+
+public:
+	AiWorker(AiWorkerPool *pool);
+	virtual void execute();
+};
+
+// =====================================================
+// 	class AiWorkerPool
+//
+///	Updates the AIs of a frame in parallel. The world is not 
+/// modified until every AI is done, so all of them decide on the 
+/// same state, their commands are given afterwards in faction order
+// =====================================================
+
+class AiWorkerPool{
+public:
+	typedef vector<AiInterface*> AiInterfaces;
+
+private:
+	typedef vector<AiWorker*> Workers;
+
+private:
+	Workers workers;
+	Semaphore startSemaphore;
+	Semaphore doneSemaphore;
+	volatile bool stopRequested;
+
+	//current frame
+	Mutex jobMutex;
+	const AiInterfaces *jobs;
+	int nextJob;
+	bool failed;
+	string errorMessage;
+
+public:
+	AiWorkerPool();
+	~AiWorkerPool();
+
+	void init(int workerCount);
+	void update(const AiInterfaces &aiInterfaces);
+	
+	//called by the workers
+	bool waitJobs();
+	void runJobs();
+	void jobsDone();
+
+private:
+	AiInterface *takeJob();
+};
+
+}}//end namespace
+
+#endif
@@ -239,12 +239,12 @@ Vec2i PathFinder::computeNearestFreePos(const Unit *unit, const Vec2i &finalPos)
 
 	//find nearest pos
 	Vec2i nearestPos= unitPos;
-	float nearestDist= unitPos.dist(finalPos);
+	int nearestDist= unitPos.sqDist(finalPos);
 	for(int i= -maxFreeSearchRadius; i<=maxFreeSearchRadius; ++i){
 		for(int j= -maxFreeSearchRadius; j<=maxFreeSearchRadius; ++j){
 			Vec2i currPos= finalPos + Vec2i(i, j);
 			if(map->isAproxFreeCells(currPos, size, field, teamIndex)){
-				float dist= currPos.dist(finalPos);
+				int dist= currPos.sqDist(finalPos);
 				
 				//if nearer from finalPos
 				if(dist<nearestDist){
@@ -253,7 +253,7 @@ Vec2i PathFinder::computeNearestFreePos(const Unit *unit, const Vec2i &finalPos)
 				}
 				//if the distance is the same compare distance to unit
 				else if(dist==nearestDist){
-					if(currPos.dist(unitPos)<nearestPos.dist(unitPos)){
+					if(currPos.sqDist(unitPos)<nearestPos.sqDist(unitPos)){
 						nearestPos= currPos;
 					}
 				}
@@ -263,8 +263,9 @@ Vec2i PathFinder::computeNearestFreePos(const Unit *unit, const Vec2i &finalPos)
 	return nearestPos;
 }
 
-float PathFinder::heuristic(const Vec2i &pos, const Vec2i &finalPos){
-	return pos.dist(finalPos);
+//squared distance, nodes are only compared so the order is the same as with dist
+int PathFinder::heuristic(const Vec2i &pos, const Vec2i &finalPos){
+	return pos.sqDist(finalPos);
 }
 
 //returns an iterator to the lowest heuristic node
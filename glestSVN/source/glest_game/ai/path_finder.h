@@ -41,7 +41,7 @@ public:
 		Vec2i pos;
 		Node *next;
 		Node *prev;
-		float heuristic;
+		int heuristic;
 		bool exploredCell;
 	};
 	typedef vector<Node*> Nodes;
@@ -69,7 +69,7 @@ private:
 	TravelState aStar(Unit *unit, const Vec2i &finalPos);
 	Node *newNode();
 	Vec2i computeNearestFreePos(const Unit *unit, const Vec2i &targetPos);
-	float heuristic(const Vec2i &pos, const Vec2i &finalPos);
+	int heuristic(const Vec2i &pos, const Vec2i &finalPos);
 	Nodes::iterator minHeuristic();
 	bool openPos(const Vec2i &sucPos);
 };
@@ -0,0 +1,94 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "log_writer.h"
+
+#include <cstdio>
+
+#include "platform_util.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Platform;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+//	class LogWriter
+// =====================================================
+
+const int LogWriter::flushInterval= 100;
+
+LogWriter::LogWriter(){
+	stopRequested= false;
+	start();
+}
+
+LogWriter &LogWriter::getInstance(){
+	static LogWriter logWriter;
+	return logWriter;
+}
+
+LogWriter::~LogWriter(){
+	stopRequested= true;
+	join();
+	flush();
+}
+
+void LogWriter::add(const string &fileName, const string &text){
+	Line line;
+	line.fileName= fileName;
+	line.text= text;
+
+	pendingMutex.p();
+	pending.push_back(line);
+	pendingMutex.v();
+}
+
+//writes all the pending lines, each file is opened once per run of lines
+void LogWriter::flush(){
+	Lines lines;
+	
+	writeMutex.p();
+
+	pendingMutex.p();
+	lines.swap(pending);
+	pendingMutex.v();
+
+	FILE *f= NULL;
+	string fileName;
+	for(int i=0; i<lines.size(); ++i){
+		if(f==NULL || lines[i].fileName!=fileName){
+			if(f!=NULL){
+				fclose(f);
+			}
+			fileName= lines[i].fileName;
+			f= fopen(fileName.c_str(), "at+");
+		}
+		if(f!=NULL){
+			fprintf(f, "%s\n", lines[i].text.c_str());
+		}
+	}
+	if(f!=NULL){
+		fclose(f);
+	}
+
+	writeMutex.v();
+}
+
+void LogWriter::execute(){
+	while(!stopRequested){
+		sleep(flushInterval);
+		flush();
+	}
+}
+
+}}//end namespace
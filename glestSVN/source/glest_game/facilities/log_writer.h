@@ -0,0 +1,67 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_LOGWRITER_H_
+#define _GLEST_GAME_LOGWRITER_H_
+
+#include <string>
+#include <vector>
+
+#include "thread.h"
+
+using std::string;
+using std::vector;
+
+namespace Glest{ namespace Game{
+
+using Shared::Platform::Thread;
+using Shared::Platform::Mutex;
+
+// =====================================================
+//	class LogWriter  
+//
+/// Appends log lines to their files from a background 
+/// thread, so logging does not wait for the disk. Lines are 
+/// written in the order they are added
+// =====================================================
+
+class LogWriter: public Thread{
+private:
+	static const int flushInterval;
+
+private:
+	struct Line{
+		string fileName;
+		string text;
+	};
+	typedef vector<Line> Lines;
+
+private:
+	Mutex pendingMutex;
+	Mutex writeMutex;
+	Lines pending;
+	volatile bool stopRequested;
+
+private:
+	LogWriter();
+
+public:
+	static LogWriter &getInstance();
+	~LogWriter();
+
+	void add(const string &fileName, const string &text);
+	void flush();
+	virtual void execute();
+};
+
+}}//end namespace
+
+#endif
@@ -16,6 +16,7 @@
 #include "core_data.h"
 #include "metrics.h"
 #include "lang.h"
+#include "log_writer.h"
 #include "leak_dumper.h"
 
 using namespace std;
@@ -28,11 +29,14 @@ namespace Glest{ namespace Game{
 // =====================================================
 
 const int Logger::logLineCount= 15;
+const int Logger::renderInterval= 50;
 
 // ===================== PUBLIC ======================== 
 
 Logger::Logger(){
 	fileName= "log.txt";
+	renderChrono.start();
+	lastRenderMillis= -renderInterval;
 }
 
 Logger & Logger::getInstance(){
@@ -40,21 +44,30 @@ Logger & Logger::getInstance(){
 	return logger;
 }
 
+//a new state is always shown with the next line
+void Logger::setState(const string &state){
+	this->state= state;
+	lastRenderMillis= -renderInterval;
+}
+
 void Logger::add(const string &str,  bool renderScreen){
-	FILE *f=fopen(fileName.c_str(), "at+");
-	if(f!=NULL){
-		fprintf(f, "%s\n", str.c_str());
-		fclose(f);
-	}
+	LogWriter::getInstance().add(fileName, str);
 	current= str;
 	if(renderScreen){
-		renderLoadingScreen();
+		int64 millis= renderChrono.getMillis();
+		if(millis-lastRenderMillis>=renderInterval){
+			lastRenderMillis= millis;
+			renderLoadingScreen();
+		}
 	}
 }
 
 void Logger::clear(){
     string s="Log file\n";
 
+	//lines added before clearing must not end up after it
+	LogWriter::getInstance().flush();
+
 	FILE *f= fopen(fileName.c_str(), "wt+");
 	if(f==NULL){
 		throw runtime_error("Error opening log file"+ fileName);
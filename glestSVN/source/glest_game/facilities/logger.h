@@ -15,20 +15,28 @@
 #include <string>
 #include <deque>
 
+#include "platform_util.h"
+
 using std::string;
 using std::deque;
 
 namespace Glest{ namespace Game{
 
+using Shared::Platform::Chrono;
+using Shared::Platform::int64;
+
 // =====================================================
 //	class Logger  
 //
-/// Interface to write log files
+/// Interface to write log files, the lines are written by the 
+/// LogWriter thread and the loading screen is rendered at most 
+/// once every renderInterval milliseconds
 // =====================================================
 
 class Logger{
 private:
 	static const int logLineCount;
+	static const int renderInterval;
 
 private:
 	typedef deque<string> Strings;
@@ -38,6 +46,8 @@ private:
 	string state;
 	string subtitle;
 	string current;
+	Chrono renderChrono;
+	int64 lastRenderMillis;
 
 private:
 	Logger();
@@ -46,7 +56,7 @@ public:
 	static Logger & getInstance();
 	
 	void setFile(const string &fileName)		{this->fileName= fileName;}
-	void setState(const string &state)			{this->state= state;}
+	void setState(const string &state);
 	void setSubtitle(const string &subtitle)	{this->subtitle= subtitle;}
 
 	void add(const string &str, bool renderScreen= false);
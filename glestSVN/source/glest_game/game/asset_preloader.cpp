@@ -0,0 +1,144 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "asset_preloader.h"
+
+#include <stdexcept>
+
+#include "xml_parser.h"
+#include "pixmap.h"
+#include "platform_util.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Util;
+using namespace Shared::Xml;
+using namespace Shared::Graphics;
+using namespace Shared::Platform;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class PreloadThread
+// =====================================================
+
+PreloadThread::PreloadThread(AssetPreloader *preloader){
+	this->preloader= preloader;
+}
+
+void PreloadThread::execute(){
+	preloader->run();
+}
+
+// =====================================================
+// 	class AssetPreloader
+// =====================================================
+
+AssetPreloader::AssetPreloader(){
+	thread= NULL;
+	stopRequested= false;
+}
+
+AssetPreloader &AssetPreloader::getInstance(){
+	static AssetPreloader assetPreloader;
+	return assetPreloader;
+}
+
+AssetPreloader::~AssetPreloader(){
+	stop();
+}
+
+//restarts only when the selection changed, so it can be called every frame
+void AssetPreloader::preload(const string &techName, const string &tilesetName){
+	if(thread!=NULL && this->techName==techName && this->tilesetName==tilesetName){
+		return;
+	}
+	stop();
+
+	this->techName= techName;
+	this->tilesetName= tilesetName;
+	stopRequested= false;
+	XmlIo::getInstance().setPreloadEnabled(true);
+	PixmapCache::getInstance().setEnabled(true);
+
+	thread= new PreloadThread(this);
+	thread->start();
+	thread->setPriority(Thread::pLow);
+}
+
+//waits for the file being decoded and drops everything nobody took
+void AssetPreloader::stop(){
+	if(thread!=NULL){
+		stopRequested= true;
+		thread->join();
+		delete thread;
+		thread= NULL;
+	}
+	techName.clear();
+	tilesetName.clear();
+	XmlIo::getInstance().setPreloadEnabled(false);
+	PixmapCache::getInstance().setEnabled(false);
+}
+
+//same order Game::load reads them, so the worker stays ahead
+void AssetPreloader::run(){
+	vector<string> paths;
+	collectPaths("tilesets/"+tilesetName, paths);
+	collectPaths("techs/"+techName, paths);
+
+	for(int i=0; i<paths.size() && !stopRequested; ++i){
+		try{
+			if(toLower(ext(paths[i]))=="xml"){
+				XmlIo::getInstance().preload(paths[i]);
+			}
+			else{
+				PixmapCache::getInstance().preload(paths[i]);
+			}
+		}
+		catch(const exception &){
+			//the real load reports broken files
+		}
+	}
+}
+
+// ==================== PRIVATE ==================== 
+
+void AssetPreloader::collectPaths(const string &dir, vector<string> &paths){
+	static const int extensionCount= 3;
+	static const char *extensions[extensionCount]= {"xml", "bmp", "tga"};
+
+	vector<string> fileNames;
+	for(int i=0; i<extensionCount; ++i){
+		try{
+			findAll(dir+"/*."+extensions[i], fileNames);
+		}
+		catch(const exception &){
+			continue;
+		}
+		for(int j=0; j<fileNames.size(); ++j){
+			paths.push_back(dir+"/"+fileNames[j]);
+		}
+	}
+
+	//names without extension are the subdirectories
+	try{
+		findAll(dir+"/*.", fileNames);
+	}
+	catch(const exception &){
+		return;
+	}
+	for(int i=0; i<fileNames.size() && !stopRequested; ++i){
+		collectPaths(dir+"/"+fileNames[i], paths);
+	}
+}
+
+}}//end namespace
@@ -0,0 +1,77 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _GLEST_GAME_ASSETPRELOADER_H_
+#define _GLEST_GAME_ASSETPRELOADER_H_
+
+#include <vector>
+#include <string>
+
+#include "thread.h"
+
+using std::vector;
+using std::string;
+
+namespace Glest{ namespace Game{
+
+using Shared::Platform::Thread;
+
+class AssetPreloader;
+
+// =====================================================
+// 	class PreloadThread
+// =====================================================
+
+class PreloadThread: public Thread{
+private:
+	AssetPreloader *preloader;
+
+public:
+	PreloadThread(AssetPreloader *preloader);
+	virtual void execute();
+};
+
+// =====================================================
+// 	class AssetPreloader
+//
+///	Decodes the xml files and images of a tech tree and 
+/// tileset on a worker thread while the match is set up. 
+/// The results wait in the XmlIo and PixmapCache caches, 
+/// Game::load takes them and only uploads them to GL
+// =====================================================
+
+class AssetPreloader{
+private:
+	PreloadThread *thread;
+	volatile bool stopRequested;
+	string techName;
+	string tilesetName;
+
+private:
+	AssetPreloader();
+
+public:
+	static AssetPreloader &getInstance();
+	~AssetPreloader();
+
+	void preload(const string &techName, const string &tilesetName);
+	void stop();
+
+	//called by the thread
+	void run();
+
+private:
+	void collectPaths(const string &dir, vector<string> &paths);
+};
+
+}}//end namespace
+
+#endif
@@ -37,6 +37,7 @@ namespace Glest{ namespace Game{
 
 void Commander::init(World *world){
 	this->world= world;
+	desyncDetector.init(world);
 }
 
 CommandResult Commander::tryGiveCommand(const Unit* unit, const CommandType *commandType, const Vec2i &pos, const UnitType* unitType) const{
@@ -230,8 +231,11 @@ void Commander::updateNetwork(){
 		
 		GameNetworkInterface *gameNetworkInterface= NetworkManager::getInstance().getGameNetworkInterface();
 
+		//the world hash is only exchanged in network games
+		int worldHash= networkManager.isNetworkGame()? desyncDetector.addKeyframe(): 0;
+
 		//update the keyframe
-		gameNetworkInterface->updateKeyframe(world->getFrameCount());
+		gameNetworkInterface->updateKeyframe(world->getFrameCount(), worldHash);
 
 		//give pending commands
 		for(int i= 0; i < gameNetworkInterface->getPendingCommandCount(); ++i){
@@ -241,6 +245,13 @@ void Commander::updateNetwork(){
 	}
 }
 
+//gives local commands that skip the network, used by the AI
+void Commander::giveCommands(const vector<NetworkCommand> &networkCommands) const{
+	for(int i=0; i<networkCommands.size(); ++i){
+		giveNetworkCommand(&networkCommands[i]);
+	}
+}
+
 void Commander::giveNetworkCommand(const NetworkCommand* networkCommand) const{
 	
 	Unit* unit= world->findUnitById(networkCommand->getUnitId());
@@ -17,6 +17,7 @@
 #include "vec.h"
 #include "selection.h"
 #include "command_type.h"
+#include "desync_detector.h"
 
 using std::vector;
 
@@ -42,10 +43,12 @@ private:
 
 private:
     World *world;
+	DesyncDetector desyncDetector;
 
 public:
     void init(World *world); 
 	void updateNetwork();
+	const DesyncDetector *getDesyncDetector() const	{return &desyncDetector;}
     
 	CommandResult tryGiveCommand(const Unit* unit, const CommandType *commandType, const Vec2i &pos, const UnitType* unitType) const;
 	CommandResult tryGiveCommand(const Selection *selection, CommandClass commandClass, const Vec2i &pos= Vec2i(0), const Unit *targetUnit= NULL) const; 
@@ -54,6 +57,7 @@ public:
 	CommandResult tryCancelCommand(const Selection *selection) const;
 	void trySetMeetingPoint(const Unit* unit, const Vec2i &pos) const;
 	CommandResult pushNetworkCommand(const NetworkCommand* networkCommand) const;
+	void giveCommands(const vector<NetworkCommand> &networkCommands) const;
 	
 private: 
     Vec2i computeRefPos(const Selection *selection) const;
@@ -0,0 +1,107 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#include "desync_detector.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+#include "world.h"
+#include "unit.h"
+#include "command.h"
+#include "leak_dumper.h"
+
+using namespace std;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class DesyncDetector
+// =====================================================
+
+DesyncDetector::DesyncDetector(){
+	world= NULL;
+	nextKeyframe= 0;
+	for(int i=0; i<keyframeCount; ++i){
+		keyframes[i].frameCount= -1;
+		keyframes[i].worldHash= 0;
+	}
+}
+
+void DesyncDetector::init(const World *world){
+	this->world= world;
+}
+
+//stores the unit states of the current frame and returns the world hash
+int DesyncDetector::addKeyframe(){
+	Keyframe &keyframe= keyframes[nextKeyframe];
+	nextKeyframe= (nextKeyframe+1) % keyframeCount;
+
+	keyframe.frameCount= world->getFrameCount();
+	keyframe.worldHash= world->getStateHash();
+	keyframe.unitStates.clear();
+
+	for(int i=0; i<world->getFactionCount(); ++i){
+		const Faction *faction= world->getFaction(i);
+		for(int j=0; j<faction->getUnitCount(); ++j){
+			const Unit *unit= faction->getUnit(j);
+
+			UnitState unitState;
+			unitState.id= unit->getId();
+			unitState.factionIndex= i;
+			unitState.pos= unit->getPos();
+			unitState.hp= unit->getHp();
+			unitState.ep= unit->getEp();
+			unitState.skillClass= unit->getCurrSkill()->getClass();
+			unitState.commandClass= unit->anyCommand()? unit->getCurrCommand()->getCommandType()->getClass(): -1;
+			unitState.hash= unit->getStateHash();
+			keyframe.unitStates.push_back(unitState);
+		}
+	}
+
+	return keyframe.worldHash;
+}
+
+//units are sorted by id, so the files of all the peers line up
+void DesyncDetector::dump(int frameCount, const string &path) const{
+	FILE *f= fopen(path.c_str(), "wt");
+	if(f==NULL){
+		throw runtime_error("Can't open file: " + path);
+	}
+
+	const Keyframe *keyframe= NULL;
+	for(int i=0; i<keyframeCount; ++i){
+		if(keyframes[i].frameCount==frameCount){
+			keyframe= &keyframes[i];
+		}
+	}
+
+	if(keyframe==NULL){
+		fprintf(f, "Frame %d is no longer in the keyframe history\n", frameCount);
+	}
+	else{
+		UnitStates unitStates= keyframe->unitStates;
+		sort(unitStates.begin(), unitStates.end());
+
+		fprintf(f, "Frame %d, world hash %d, %d units\n", frameCount, keyframe->worldHash, static_cast<int>(unitStates.size()));
+		for(int i=0; i<unitStates.size(); ++i){
+			const UnitState &us= unitStates[i];
+			fprintf(f, "unit %d faction %d pos %d,%d hp %d ep %d skill %d command %d hash %d\n",
+				us.id, us.factionIndex, us.pos.x, us.pos.y, us.hp, us.ep, us.skillClass, us.commandClass, us.hash);
+		}
+	}
+
+	fclose(f);
+}
+
+}}//end namespace
@@ -0,0 +1,78 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#ifndef _GLEST_GAME_DESYNCDETECTOR_H_
+#define _GLEST_GAME_DESYNCDETECTOR_H_
+
+#include <vector>
+#include <string>
+
+#include "vec.h"
+
+using std::vector;
+using std::string;
+
+namespace Glest{ namespace Game{
+
+using Shared::Graphics::Vec2i;
+
+class World;
+
+// =====================================================
+// 	class DesyncDetector
+//
+///	Keeps the unit states of the last keyframes, so when
+///	peers report different world hashes each one can dump
+/// the states of that keyframe and the files can be diffed
+// =====================================================
+
+class DesyncDetector{
+public:
+	static const int keyframeCount= 64;
+
+private:
+	struct UnitState{
+		int id;
+		int factionIndex;
+		Vec2i pos;
+		int hp;
+		int ep;
+		int skillClass;
+		int commandClass;
+		int hash;
+
+		bool operator<(const UnitState &unitState) const	{return id<unitState.id;}
+	};
+	typedef vector<UnitState> UnitStates;
+
+	struct Keyframe{
+		int frameCount;
+		int worldHash;
+		UnitStates unitStates;
+	};
+
+private:
+	const World *world;
+	Keyframe keyframes[keyframeCount];	//ring buffer, the server runs ahead of the clients
+	int nextKeyframe;
+
+public:
+	DesyncDetector();
+	void init(const World *world);
+
+	int addKeyframe();
+	void dump(int frameCount, const string &path) const;
+};
+
+}}//end namespace
+
+#endif
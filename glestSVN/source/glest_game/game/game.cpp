@@ -24,11 +24,16 @@
 #include "network_manager.h"
 #include "checksum.h"
 #include "auto_test.h"
+#include "simulation_thread.h"
+#include "interpolation.h"
+#include "buffer_manager_gl.h"
+#include "asset_preloader.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Graphics;
 using namespace Shared::Util;
 using namespace Shared::Platform;
+using Shared::Graphics::Gl::BufferManagerGl;
 
 namespace Glest{ namespace Game{
 
@@ -48,14 +53,26 @@ Game::Game(Program *program, const GameSettings *gameSettings):
 	mouse2d= 0;
 	loadingText="";
 	weatherParticleSystem= NULL;
+	simulationThread= NULL;
 	updateFps=0;
 	renderFps=0;
 	lastUpdateFps=0;
+	lastAnimatedVertices=0;
+	lastPoseHits=0;
+	lastUploadedBytes=0;
 	lastRenderFps=0;
 	paused= false;
 	gameOver= false;
 	renderNetworkStatus= false;
+	frameScriptMessageBoxEnabled= false;
+	frameSelectingPos= false;
 	speed= sNormal;
+
+	Config &config= Config::getInstance();
+	autoTest= config.getSetting("AutoTest");
+	debugMode= config.getSetting("DebugMode");
+	photoMode= config.getSetting("PhotoMode");
+	fastSpeedLoops= config.getSetting("FastSpeedLoops");
 }
 
 Game::~Game(){
@@ -64,6 +81,12 @@ Game::~Game(){
 
 	logger.setState(Lang::getInstance().get("Deleting"));
 	logger.add("Game", true);
+
+	//the simulation must stop before anything it touches is deleted
+	if(simulationThread!=NULL){
+		simulationThread->stop();
+		delete simulationThread;
+	}
 	
 	renderer.endGame();
 	SoundRenderer::getInstance().stopAllSounds();
@@ -107,6 +130,9 @@ void Game::load(){
 		Lang::getInstance().loadScenarioStrings(gameSettings.getScenarioDir(), scenarioName);
 		world.loadScenario(Scenario::getScenarioPath(gameSettings.getScenarioDir(), scenarioName), &checksum);
 	}
+
+	//everything was read, free what the lobby preloaded for nothing
+	AssetPreloader::getInstance().stop();
 }
 
 void Game::init(){
@@ -150,6 +176,7 @@ void Game::init(){
 			aiInterfaces[i]= NULL;
 		}
 	}
+	aiWorkerPool.init(Config::getInstance().getInt("AiThreads"));
 
 	//wheather particle systems
 	if(world.getTileset()->getWeather() == wRainy){
@@ -197,6 +224,13 @@ void Game::init(){
 	StrSound *gameMusic= world.getThisFaction()->getType()->getMusic();
 	soundRenderer.playMusic(gameMusic);
 
+	//simulation thread, network games keep updating in lockstep with the network
+	if(Config::getInstance().getBool("ThreadedSimulation") && !networkManager.isNetworkGame()){
+		logger.add("Starting simulation thread", true);
+		simulationThread= new SimulationThread(this, program->getStateMutex());
+		simulationThread->start();
+	}
+
 	logger.add("Launching game");
 }
 
@@ -217,25 +251,22 @@ void Game::update(){
 
 	// b) Updates depandant on speed
 
-	int updateLoops= getUpdateLoops();
+	int updateLoops= getUpdateLoops(updateFps);
+
+	//simulation errors are reported here
+	if(simulationThread!=NULL){
+		simulationThread->checkError();
+	}
 
 	//update
 	for(int i=0; i<updateLoops; ++i){
 		Renderer &renderer= Renderer::getInstance();
 
-		//AiInterface
-		for(int i=0; i<world.getFactionCount(); ++i){
-			if(world.getFaction(i)->getCpuControl() && scriptManager.getPlayerModifiers(i)->getAiEnabled()){
-				aiInterfaces[i]->update(); 
-			}
+		//world, unless the simulation thread does it
+		if(simulationThread==NULL){
+			updateWorld();
 		}
 
-		//World
-		world.update();
-
-		// Commander
-		commander.updateNetwork();
-
 		//Gui
 		gui.update();
 		
@@ -249,13 +280,24 @@ void Game::update(){
 	//call the chat manager
 	chatManager.updateNetwork();
 
+	//dump the unit states when the world diverges from a peer
+	GameNetworkInterface *gameNetworkInterface= NetworkManager::getInstance().getGameNetworkInterface();
+	int desyncFrame= gameNetworkInterface->getDesyncFrame();
+	if(desyncFrame!=-1){
+		Lang &lang= Lang::getInstance();
+		string path= "desync_" + intToStr(desyncFrame) + "_" + intToStr(world.getThisFactionIndex()) + ".log";
+		commander.getDesyncDetector()->dump(desyncFrame, path);
+		console.addLine(lang.get("DesyncDetected") + " " + intToStr(desyncFrame) + ": " + path);
+		gameNetworkInterface->clearDesyncFrame();
+	}
+
 	//check for quiting status
-	if(NetworkManager::getInstance().getGameNetworkInterface()->getQuit()){
+	if(gameNetworkInterface->getQuit()){
 		quitGame();
 	}
 
 	//update auto test
-	if(Config::getInstance().getBool("AutoTest")){
+	if(autoTest->getBool()){
 		AutoTest::getInstance().updateGame(this);
 	}
 }
@@ -264,15 +306,35 @@ void Game::updateCamera(){
 	gameCamera.update();
 }
 
+//called by the simulation thread with the program state mutex held
+void Game::updateSimulation(int tick){
+	int updateLoops= getUpdateLoops(tick);
+	for(int i=0; i<updateLoops; ++i){
+		updateWorld();
+	}
+}
+
 
 // ==================== render ==================== 
 
-//render
+//everything drawn is copied first, the simulation runs while the frame is rendered
 void Game::render(){
+	Mutex *stateMutex= program->getStateMutex();
+
 	renderFps++;
-	render3d();
-	render2d();
-	Renderer::getInstance().swapBuffers();
+	prepareRender();
+
+	stateMutex->v();
+	try{
+		render3d();
+		render2d();
+		Renderer::getInstance().swapBuffers();
+	}
+	catch(...){
+		stateMutex->p();
+		throw;
+	}
+	stateMutex->p();
 }
 
 // ==================== tick ==================== 
@@ -283,6 +345,16 @@ void Game::tick(){
 	updateFps= 0;
 	renderFps= 0;
 
+	//animation stats of the last second
+	int64 poseCount= InterpolationData::getPoseHits() + InterpolationData::getPoseMisses();
+	lastAnimatedVertices= static_cast<int>(InterpolationData::getInterpolatedVertices());
+	lastPoseHits= poseCount==0? 0: static_cast<int>(InterpolationData::getPoseHits()*100/poseCount);
+	InterpolationData::resetStats();
+
+	//buffer uploads per frame over the last second
+	lastUploadedBytes= lastRenderFps==0? 0: static_cast<int>(BufferManagerGl::getUploadedBytes()/lastRenderFps);
+	BufferManagerGl::resetStats();
+
 	//Win/lose check
 	checkWinner();
 	gui.tick();
@@ -516,6 +588,17 @@ void Game::keyDown(char key){
 			showMessageBox(lang.get("ExitGame?"), "", true);
 		}
 
+		//reload config
+		else if(key==vkF5 && debugMode->getBool()){
+			try{
+				Config::getInstance().reload();
+				console.addLine(lang.get("ConfigReloaded"));
+			}
+			catch(const exception &e){
+				console.addLine(e.what());
+			}
+		}
+
 		//group
 		else if(key>='0' && key<'0'+Selection::maxGroups){
 			gui.groupKey(key-'0');
@@ -591,15 +674,69 @@ void Game::quitGame(){
 
 // ==================== render ==================== 
 
-void Game::render3d(){
-
+//called with the program state mutex held, copies the world and gui state the frame draws
+void Game::prepareRender(){
 	Renderer &renderer= Renderer::getInstance();
 
-	//init
+	//take the latest units published by the world
+	world.getSnapshotBuffer()->acquire();
+
+	//3d
 	renderer.reset3d();
 	renderer.computeVisibleQuad();
+	renderer.computeRenderLists();
 	renderer.loadGameCameraMatrix();
 	renderer.setupLighting();
+	renderer.captureFrame();
+
+	//2d
+	frameConsole= console;
+	frameScriptMessageBoxEnabled= scriptManager.getMessageBoxEnabled();
+	if(frameScriptMessageBoxEnabled){
+		frameScriptMessageBox= *scriptManager.getMessageBox();
+	}
+	frameScriptDisplayText= scriptManager.getDisplayText();
+	frameSelectingPos= gui.isSelectingPos();
+
+	if(renderNetworkStatus){
+		frameNetworkStatus= NetworkManager::getInstance().getGameNetworkInterface()->getNetworkStatus();
+	}
+
+	//debug info of the world
+	frameDebugText.clear();
+	if(debugMode->getBool()){
+		string &str= frameDebugText;
+
+		str+= "Time: "+floatToStr(world.getTimeFlow()->getTime())+"\n";
+		str+= "Frame count:"+intToStr(world.getFrameCount())+"\n";
+
+		// resources
+        for(int i=0; i<world.getFactionCount(); ++i){
+            str+= "Player "+intToStr(i)+" res: ";
+            for(int j=0; j<world.getTechTree()->getResourceTypeCount(); ++j){
+                str+= intToStr(world.getFaction(i)->getResource(j)->getAmount());
+                str+=" ";
+            }
+            str+="\n";
+        }
+
+		//script handlers
+		for(int i=0; i<scriptManager.getHandlerCount(); ++i){
+			const ScriptHandler *handler= scriptManager.getHandler(i);
+			str+= "Script " + handler->getName() + ": " + intToStr(handler->getCallCount()) + " calls, ";
+			str+= intToStr(static_cast<int>(handler->getMicros()/1000)) + " ms";
+			if(handler->getAbortCount()>0){
+				str+= ", " + intToStr(handler->getAbortCount()) + " aborted";
+			}
+			str+= "\n";
+		}
+	}
+}
+
+//draws from the render lists and the frame copies only, the state mutex is released
+void Game::render3d(){
+
+	Renderer &renderer= Renderer::getInstance();
 
 	//shadow map
 	renderer.renderShadowsToTexture();
@@ -632,7 +769,6 @@ void Game::render3d(){
 
 void Game::render2d(){
 	Renderer &renderer= Renderer::getInstance();
-	Config &config= Config::getInstance();
 	CoreData &coreData= CoreData::getInstance();
 
 	//init
@@ -642,7 +778,7 @@ void Game::render2d(){
 	renderer.renderDisplay();
 	
 	//minimap
-	if(!config.getBool("PhotoMode")){
+	if(!photoMode->getBool()){
         renderer.renderMinimap();
 	}
 
@@ -655,14 +791,14 @@ void Game::render2d(){
 	}
 
 	//script message box
-	if(!mainMessageBox.getEnabled() && scriptManager.getMessageBoxEnabled()){
-		renderer.renderMessageBox(scriptManager.getMessageBox());
+	if(!mainMessageBox.getEnabled() && frameScriptMessageBoxEnabled){
+		renderer.renderMessageBox(&frameScriptMessageBox);
 	}
 
 	//script display text
-	if(!scriptManager.getDisplayText().empty() && !scriptManager.getMessageBoxEnabled()){
+	if(!frameScriptDisplayText.empty() && !frameScriptMessageBoxEnabled){
 		renderer.renderText(
-			scriptManager.getDisplayText(), coreData.getMenuFontNormal(),
+			frameScriptDisplayText, coreData.getMenuFontNormal(),
 			Vec3f(1.0f), 200, 680, false);
 	}
 
@@ -670,18 +806,20 @@ void Game::render2d(){
 	renderer.renderChatManager(&chatManager);
 
     //debug info
-	if(config.getBool("DebugMode")){
+	if(debugMode->getBool()){
         string str;
 
         str+= "MouseXY: " + intToStr(mouseX) + "," + intToStr(mouseY)+"\n";
 		str+= "PosObjWord: " + intToStr(gui.getPosObjWorld().x) + "," + intToStr(gui.getPosObjWorld().y)+"\n";
         str+= "Render FPS: "+intToStr(lastRenderFps)+"\n";
         str+= "Update FPS: "+intToStr(lastUpdateFps)+"\n";
-        str+= "GameCamera pos: "+floatToStr(gameCamera.getPos().x)+","+floatToStr(gameCamera.getPos().y)+","+floatToStr(gameCamera.getPos().z)+"\n";
-		str+= "Time: "+floatToStr(world.getTimeFlow()->getTime())+"\n";
+		str+= "Max frame time: "+intToStr(program->getFrameScheduler()->getMaxFrameMillis())+" ms, sleeping "+intToStr(program->getFrameScheduler()->getSleepPercent())+"%\n";
+		const Vec3f &cameraPos= renderer.getFrame()->cameraPos;
+        str+= "GameCamera pos: "+floatToStr(cameraPos.x)+","+floatToStr(cameraPos.y)+","+floatToStr(cameraPos.z)+"\n";
 		str+= "Triangle count: "+intToStr(renderer.getTriangleCount())+"\n";
 		str+= "Vertex count: "+intToStr(renderer.getPointCount())+"\n";
-		str+= "Frame count:"+intToStr(world.getFrameCount())+"\n";
+		str+= "Animated vertices/s: "+intToStr(lastAnimatedVertices)+" (pose cache hits "+intToStr(lastPoseHits)+"%)\n";
+		str+= "Buffer uploads/frame: "+intToStr(lastUploadedBytes)+" bytes\n";
 	
 		//visible quad
 		Quad2i visibleQuad= renderer.getVisibleQuad();
@@ -693,15 +831,8 @@ void Game::render2d(){
 		str+= "\n";
 		str+= "Visible quad area: " + floatToStr(visibleQuad.area()) +"\n";
 
-		// resources
-        for(int i=0; i<world.getFactionCount(); ++i){
-            str+= "Player "+intToStr(i)+" res: ";
-            for(int j=0; j<world.getTechTree()->getResourceTypeCount(); ++j){
-                str+= intToStr(world.getFaction(i)->getResource(j)->getAmount());
-                str+=" ";
-            }
-            str+="\n";
-        }
+		//world
+		str+= frameDebugText;
 
 		renderer.renderText(
 			str, coreData.getMenuFontNormal(),
@@ -711,22 +842,49 @@ void Game::render2d(){
 	//network status
 	if(renderNetworkStatus){
 		renderer.renderText(
-			NetworkManager::getInstance().getGameNetworkInterface()->getNetworkStatus(), 
+			frameNetworkStatus, 
 			coreData.getMenuFontNormal(),
 			Vec3f(1.0f), 20, 500, false);
 	}
 
     //resource info
-	if(!config.getBool("PhotoMode")){
+	if(!photoMode->getBool()){
         renderer.renderResourceStatus();
-		renderer.renderConsole(&console);
+		renderer.renderConsole(&frameConsole);
     }
 	
     //2d mouse
-	renderer.renderMouse2d(mouseX, mouseY, mouse2d, gui.isSelectingPos()? 1.f: 0.f);
+	renderer.renderMouse2d(mouseX, mouseY, mouse2d, frameSelectingPos? 1.f: 0.f);
 }
 
 
+// ==================== update ==================== 
+
+//one world frame: AI, world and network commands
+void Game::updateWorld(){
+
+	//AiInterface, the AIs decide in parallel and their commands are given in faction order
+	AiInterfaces updatedAiInterfaces;
+	for(int i=0; i<world.getFactionCount(); ++i){
+		if(world.getFaction(i)->getCpuControl() && scriptManager.getPlayerModifiers(i)->getAiEnabled()){
+			updatedAiInterfaces.push_back(aiInterfaces[i]); 
+		}
+	}
+	aiWorkerPool.update(updatedAiInterfaces);
+	for(int i=0; i<updatedAiInterfaces.size(); ++i){
+		updatedAiInterfaces[i]->flushCommands();
+	}
+
+	//World
+	world.update();
+
+	//deferred script events
+	scriptManager.update();
+
+	// Commander
+	commander.updateNetwork();
+}
+
 // ==================== misc ==================== 
 
 void Game::checkWinner(){	
@@ -837,15 +995,15 @@ void Game::decSpeed(){
 	}
 }
 
-int Game::getUpdateLoops(){
+int Game::getUpdateLoops(int tick){
 	if(paused){
 		return 0;
 	}
 	else if(speed==sFast){
-		return Config::getInstance().getInt("FastSpeedLoops");
+		return fastSpeedLoops->getInt();
 	}
 	else if(speed==sSlow){
-		return updateFps % 2 == 0? 1: 0;
+		return tick % 2 == 0? 1: 0;
 	}
 	return 1;
 }
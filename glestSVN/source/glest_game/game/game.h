@@ -18,6 +18,7 @@
 #include "game_camera.h"
 #include "world.h"
 #include "ai_interface.h"
+#include "ai_worker_pool.h"
 #include "program.h"
 #include "chat_manager.h"
 #include "script_manager.h"
@@ -28,6 +29,8 @@ using std::vector;
 namespace Glest{ namespace Game{
 
 class GraphicMessageBox;
+class SimulationThread;
+class Setting;
 
 // =====================================================
 // 	class Game
@@ -51,6 +54,7 @@ private:
 	//main data
 	World world;
     AiInterfaces aiInterfaces;
+	AiWorkerPool aiWorkerPool;
     Gui gui;
     GameCamera gameCamera;
     Commander commander;
@@ -65,14 +69,32 @@ private:
     int mouseX, mouseY; //coords win32Api
 	int updateFps, lastUpdateFps;
 	int renderFps, lastRenderFps;
+	int lastAnimatedVertices, lastPoseHits;
+	int lastUploadedBytes;
 	bool paused;
 	bool gameOver;
 	bool renderNetworkStatus;
 	Speed speed;
 	GraphicMessageBox mainMessageBox;
 
+	//copies drawn while the simulation runs
+	Console frameConsole;
+	GraphicMessageBox frameScriptMessageBox;
+	bool frameScriptMessageBoxEnabled;
+	string frameScriptDisplayText;
+	string frameNetworkStatus;
+	string frameDebugText;
+	bool frameSelectingPos;
+
+	//config read every frame
+	const Setting *autoTest;
+	const Setting *debugMode;
+	const Setting *photoMode;
+	const Setting *fastSpeedLoops;
+
 	//misc ptr
 	ParticleSystem *weatherParticleSystem;
+	SimulationThread *simulationThread;
 	GameSettings gameSettings;
 
 public:
@@ -101,6 +123,9 @@ public:
 	virtual void render();
 	virtual void tick();
 
+	//simulation
+	void updateSimulation(int tick);
+
     //event managing
     virtual void keyDown(char key);
     virtual void keyUp(char key);
@@ -114,9 +139,13 @@ public:
 	void quitGame();
 private:
 	//render
+	void prepareRender();
     void render3d();
     void render2d();
 
+	//update
+	void updateWorld();
+
 	//misc
 	void checkWinner();
 	void checkWinnerStandard();
@@ -124,7 +153,7 @@ private:
 	bool hasBuilding(const Faction *faction);
 	void incSpeed();
 	void decSpeed();
-	int getUpdateLoops();
+	int getUpdateLoops(int tick);
 	void showLoseMessageBox();
 	void showWinMessageBox();
 	void showMessageBox(const string &text, const string &header, bool toggle);
@@ -122,6 +122,16 @@ void GameCamera::update(){
 	}
 }
 
+//world space view axes, matching Renderer::loadGameCameraMatrix
+void GameCamera::computeAxes(Vec3f &forward, Vec3f &right, Vec3f &up) const{
+	float h= degToRad(hAng);
+	float v= degToRad(vAng);
+
+	forward= Vec3f(sinf(h)*cosf(v), sinf(v), -cosf(h)*cosf(v));
+	right= Vec3f(cosf(h), 0.f, sinf(h));
+	up= Vec3f(-sinf(h)*sinf(v), cosf(v), cosf(h)*sinf(v));
+}
+
 Quad2i GameCamera::computeVisibleQuad() const{
 	float aspectRatio = Metrics::getInstance().getAspectRatio();
 	Vec2i v= Vec2i(static_cast<int>(pos.x), static_cast<int>(pos.z));
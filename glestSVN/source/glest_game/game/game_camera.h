@@ -96,6 +96,7 @@ public:
     //other
     void update();
     Quad2i computeVisibleQuad() const;
+	void computeAxes(Vec3f &forward, Vec3f &right, Vec3f &up) const;
 	void switchState();
 
 	void centerXZ(float x, float z);
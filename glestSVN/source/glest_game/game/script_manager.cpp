@@ -14,6 +14,8 @@
 #include "world.h"
 #include "lang.h"
 #include "game_camera.h"
+#include "config.h"
+#include "platform_util.h"
 
 #include "leak_dumper.h"
 
@@ -31,6 +33,26 @@ PlayerModifiers::PlayerModifiers(){
 	aiEnabled= true;
 }
 
+// =====================================================
+//	class ScriptHandler
+// =====================================================
+
+ScriptHandler::ScriptHandler(const string &name, int ref){
+	this->name= name;
+	this->ref= ref;
+	callCount= 0;
+	abortCount= 0;
+	micros= 0;
+}
+
+void ScriptHandler::addCall(int64 micros, bool aborted){
+	++callCount;
+	if(aborted){
+		++abortCount;
+	}
+	this->micros+= micros;
+}
+
 // =====================================================
 //	class ScriptManager
 // =====================================================
@@ -61,6 +83,7 @@ void ScriptManager::init(World* world, GameCamera *gameCamera){
 	luaScript.registerFunction(disableAi, "disableAi");
 	luaScript.registerFunction(setPlayerAsWinner, "setPlayerAsWinner");
 	luaScript.registerFunction(endGame, "endGame");
+	luaScript.registerFunction(deferEvent, "deferEvent");
 
 	luaScript.registerFunction(getStartLocation, "startLocation");
 	luaScript.registerFunction(getUnitPosition, "unitPosition");
@@ -79,6 +102,10 @@ void ScriptManager::init(World* world, GameCamera *gameCamera){
 		const Script* script= scenario->getScript(i);
 		luaScript.loadCode("function " + script->getName() + "()" + script->getCode() + "end\n", script->getName());
 	}
+	initEventHandlers();
+
+	//limit the instructions of each call, so a bad script can't hang the game
+	luaScript.setInstructionBudget(Config::getInstance().getInt("ScriptInstructionBudget"));
 	
 	//setup message box
 	messageBox.init( Lang::getInstance().get("Ok") );
@@ -89,11 +116,23 @@ void ScriptManager::init(World* world, GameCamera *gameCamera){
 	lastDeadUnitId= -1;
 	gameOver= false;
 
+	//deferred events
+	resourceHarvestedDeferred= false;
+	resourceHarvestedPending= false;
+
 	//call startup function
 	luaScript.beginCall("startup");
 	luaScript.endCall();
 }
 
+//calls the deferred events once per world update
+void ScriptManager::update(){
+	if(resourceHarvestedPending){
+		resourceHarvestedPending= false;
+		callHandler(resourceHarvestedHandler);
+	}
+}
+
 // ========================== events ===============================================
 
 void ScriptManager::onMessageBoxOk(){
@@ -109,28 +148,80 @@ void ScriptManager::onMessageBoxOk(){
 }
 
 void ScriptManager::onResourceHarvested(){
-	luaScript.beginCall("resourceHarvested");
-	luaScript.endCall();
+	if(resourceHarvestedDeferred){
+		resourceHarvestedPending= true;
+	}
+	else{
+		callHandler(resourceHarvestedHandler);
+	}
 }
 
 void ScriptManager::onUnitCreated(const Unit* unit){
 	lastCreatedUnitName= unit->getType()->getName();
 	lastCreatedUnitId= unit->getId();
-	luaScript.beginCall("unitCreated");
-	luaScript.endCall();
-	luaScript.beginCall("unitCreatedOfType_"+unit->getType()->getName());
-	luaScript.endCall();
+	callHandler(unitCreatedHandler);
+	UnitTypeHandlers::const_iterator it= unitCreatedOfTypeHandlers.find(unit->getType());
+	if(it!=unitCreatedOfTypeHandlers.end()){
+		callHandler(it->second);
+	}
 }
 
 void ScriptManager::onUnitDied(const Unit* unit){
 	lastDeadUnitName= unit->getType()->getName();
 	lastDeadUnitId= unit->getId();
-	luaScript.beginCall("unitDied");
-	luaScript.endCall();
+	callHandler(unitDiedHandler);
 }
 
 // ========================== lua wrappers ===============================================
 
+//finds the event handlers once, so events the scenario does not handle cost nothing
+void ScriptManager::initEventHandlers(){
+	handlers.clear();
+	resourceHarvestedHandler= addHandler("resourceHarvested");
+	unitCreatedHandler= addHandler("unitCreated");
+	unitDiedHandler= addHandler("unitDied");
+
+	unitCreatedOfTypeHandlers.clear();
+	for(int i= 0; i<world->getFactionCount(); ++i){
+		const FactionType *factionType= world->getFaction(i)->getType();
+		for(int j= 0; j<factionType->getUnitTypeCount(); ++j){
+			const UnitType *unitType= factionType->getUnitType(j);
+			if(unitCreatedOfTypeHandlers.find(unitType)==unitCreatedOfTypeHandlers.end()){
+				int handlerIndex= addHandler("unitCreatedOfType_"+unitType->getName());
+				if(handlerIndex!=invalidHandler){
+					unitCreatedOfTypeHandlers[unitType]= handlerIndex;
+				}
+			}
+		}
+	}
+}
+
+//returns the handler index, or invalidHandler if the scenario does not define it
+int ScriptManager::addHandler(const string &name){
+	int ref= luaScript.getFunctionRef(name);
+	if(ref==LuaScript::invalidRef){
+		return invalidHandler;
+	}
+	handlers.push_back(ScriptHandler(name, ref));
+	return handlers.size()-1;
+}
+
+void ScriptManager::callHandler(int handlerIndex){
+	if(handlerIndex!=invalidHandler){
+		ScriptHandler *handler= &handlers[handlerIndex];
+		
+		//handlers called from inside another handler are already timed by the outermost one
+		bool outermost= luaScript.getCallDepth()==0;
+		Chrono chrono;
+		if(outermost){
+			chrono.start();
+		}
+		luaScript.beginCall(handler->getRef());
+		bool ok= luaScript.endCall();
+		handler->addCall(outermost? chrono.getMicros(): 0, !ok);
+	}
+}
+
 string ScriptManager::wrapString(const string &str, int wrapCount){
 
 	string returnString;
@@ -208,6 +299,16 @@ void ScriptManager::endGame(){
 	gameOver= true;
 }
 
+//only events whose order does not matter can be deferred
+void ScriptManager::deferEvent(const string &eventName){
+	if(eventName=="resourceHarvested"){
+		resourceHarvestedDeferred= true;
+	}
+	else{
+		throw runtime_error("Event can not be deferred: " + eventName);
+	}
+}
+
 Vec2i ScriptManager::getStartLocation(int factionIndex){
 	return world->getStartLocation(factionIndex);
 }
@@ -334,6 +435,12 @@ int ScriptManager::endGame(LuaHandle* luaHandle){
 	return luaArguments.getReturnCount();
 }
 
+int ScriptManager::deferEvent(LuaHandle* luaHandle){
+	LuaArguments luaArguments(luaHandle);
+	thisScriptManager->deferEvent(luaArguments.getString(-1));
+	return luaArguments.getReturnCount();
+}
+
 int ScriptManager::getStartLocation(LuaHandle* luaHandle){
 	LuaArguments luaArguments(luaHandle);
 	Vec2i pos= thisScriptManager->getStartLocation(luaArguments.getInt(-1));
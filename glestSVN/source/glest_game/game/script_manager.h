@@ -14,23 +14,30 @@
 
 #include <string>
 #include <queue>
+#include <map>
+#include <vector>
 
 #include "lua_script.h"
 #include "vec.h"
+#include "types.h"
 
 #include "components.h"
 #include "game_constants.h"
 
 using std::string;
 using std::queue;
+using std::map;
+using std::vector;
 using Shared::Graphics::Vec2i;
 using Shared::Lua::LuaScript;
 using Shared::Lua::LuaHandle;
+using Shared::Platform::int64;
 
 namespace Glest{ namespace Game{
 
 class World;
 class Unit;
+class UnitType;
 class GameCamera;
 
 // =====================================================
@@ -63,13 +70,45 @@ private:
 	bool aiEnabled;
 };
 
+// =====================================================
+//	class ScriptHandler
+//
+///	An event handler defined by the scenario, with its
+/// call statistics
+// =====================================================
+
+class ScriptHandler{
+private:
+	string name;
+	int ref;
+	int callCount;
+	int abortCount;
+	int64 micros;
+
+public:
+	ScriptHandler(const string &name, int ref);
+
+	const string &getName() const	{return name;}
+	int getRef() const				{return ref;}
+	int getCallCount() const		{return callCount;}
+	int getAbortCount() const		{return abortCount;}
+	int64 getMicros() const			{return micros;}
+
+	void addCall(int64 micros, bool aborted);
+};
+
 // =====================================================
 //	class ScriptManager
 // =====================================================
 
 class ScriptManager{
+public:
+	static const int invalidHandler= -1;
+
 private:
 	typedef queue<ScriptManagerMessage> MessageQueue;
+	typedef map<const UnitType*, int> UnitTypeHandlers;
+	typedef vector<ScriptHandler> ScriptHandlers;
 
 private:
 
@@ -77,6 +116,17 @@ private:
 	string code;
 	LuaScript luaScript;
 
+	//event handlers defined by the scenario, indices in handlers
+	ScriptHandlers handlers;
+	int resourceHarvestedHandler;
+	int unitCreatedHandler;
+	int unitDiedHandler;
+	UnitTypeHandlers unitCreatedOfTypeHandlers;
+
+	//deferred events, called at most once per world update
+	bool resourceHarvestedDeferred;
+	bool resourceHarvestedPending;
+
 	//world
 	World *world;
 	GameCamera *gameCamera;
@@ -107,6 +157,7 @@ private:
 
 public:
 	void init(World* world, GameCamera *gameCamera);
+	void update();
 
 	//message box functions
 	bool getMessageBoxEnabled() const									{return !messageQueue.empty();}
@@ -114,6 +165,8 @@ public:
 	string getDisplayText() const										{return displayText;}
 	bool getGameOver() const											{return gameOver;}
 	const PlayerModifiers *getPlayerModifiers(int factionIndex) const	{return &playerModifiers[factionIndex];}	
+	int getHandlerCount() const											{return handlers.size();}
+	const ScriptHandler *getHandler(int i) const						{return &handlers[i];}
 
 	//events
 	void onMessageBoxOk();
@@ -124,6 +177,9 @@ public:
 private:
 
 	string wrapString(const string &str, int wrapCount);
+	void initEventHandlers();
+	int addHandler(const string &name);
+	void callHandler(int handlerIndex);
 
 	//wrappers, commands
 	void showMessage(const string &text, const string &header);
@@ -138,6 +194,7 @@ private:
 	void disableAi(int factionIndex);
 	void setPlayerAsWinner(int factionIndex);
 	void endGame();
+	void deferEvent(const string &eventName);
 
 	//wrappers, queries
 	Vec2i getStartLocation(int factionIndex);
@@ -164,6 +221,7 @@ private:
 	static int disableAi(LuaHandle* luaHandle);
 	static int setPlayerAsWinner(LuaHandle* luaHandle);
 	static int endGame(LuaHandle* luaHandle);
+	static int deferEvent(LuaHandle* luaHandle);
 
 	//callbacks, queries
 	static int getStartLocation(LuaHandle* luaHandle);
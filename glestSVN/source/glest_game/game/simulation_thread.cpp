@@ -0,0 +1,90 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#include "simulation_thread.h"
+
+#include <stdexcept>
+
+#include "game.h"
+#include "game_constants.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Platform;
+using namespace std;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class SimulationThread
+// =====================================================
+
+const int SimulationThread::maxTimes= 10;
+
+SimulationThread::SimulationThread(Game *game, Mutex *stateMutex){
+	this->game= game;
+	this->stateMutex= stateMutex;
+	stopRequested= false;
+	failed= false;
+}
+
+void SimulationThread::execute(){
+	PerformanceTimer updateTimer;
+	int tick= 0;
+
+	updateTimer.init(GameConstants::updateFps, maxTimes);
+
+	while(!stopRequested){
+		if(updateTimer.isTime()){
+			stateMutex->p();
+			if(stopRequested){
+				stateMutex->v();
+				return;
+			}
+			try{
+				game->updateSimulation(tick++);
+			}
+			catch(const exception &e){
+				errorMessage= e.what();
+				failed= true;
+				stateMutex->v();
+				return;
+			}
+			stateMutex->v();
+		}
+		else{
+			//sleep until the next update is due, or until stopped
+			int64 waitMicros= updateTimer.getMicrosToNext();
+			if(waitMicros>0){
+				wakeSemaphore.p(static_cast<int>((waitMicros+999)/1000));
+			}
+		}
+	}
+}
+
+//called from the main thread holding the state mutex, which is released
+//while joining so a simulation step waiting for it can finish
+void SimulationThread::stop(){
+	stopRequested= true;
+	wakeSemaphore.v();
+	stateMutex->v();
+	join();
+	stateMutex->p();
+}
+
+//rethrows simulation errors on the main thread, where they can be reported
+void SimulationThread::checkError() const{
+	if(failed){
+		throw runtime_error("Simulation error: " + errorMessage);
+	}
+}
+
+}}//end namespace
@@ -0,0 +1,62 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#ifndef _GLEST_GAME_SIMULATIONTHREAD_H_
+#define _GLEST_GAME_SIMULATIONTHREAD_H_
+
+#include <string>
+
+#include "thread.h"
+#include "platform_util.h"
+
+using std::string;
+
+namespace Glest{ namespace Game{
+
+using Shared::Platform::Thread;
+using Shared::Platform::Mutex;
+using Shared::Platform::Semaphore;
+
+class Game;
+
+// =====================================================
+// 	class SimulationThread
+//
+///	Runs the world updates of a Game at GameConstants::updateFps, 
+/// away from the render loop. Every world step is done holding the 
+/// program state mutex, the renderer reads units from the published 
+/// render snapshots so it does not need the mutex for them.
+// =====================================================
+
+class SimulationThread: public Thread{
+private:
+	static const int maxTimes;
+
+private:
+	Game *game;
+	Mutex *stateMutex;
+	Semaphore wakeSemaphore;	//signaled by stop
+	volatile bool stopRequested;
+	volatile bool failed;
+	string errorMessage;
+
+public:
+	SimulationThread(Game *game, Mutex *stateMutex);
+
+	virtual void execute();
+	void stop();
+	void checkError() const;
+};
+
+}}//end namespace
+
+#endif
@@ -11,18 +11,150 @@
 
 #include "config.h"
 
+#include <algorithm>
+#include <stdexcept>
+
 #include "util.h"
+#include "conversion.h"
 
 #include "leak_dumper.h"
 
+using namespace std;
+using namespace Shared::Util;
+
 namespace Glest{ namespace Game{
 
+// =====================================================
+// 	class Setting
+// =====================================================
+
+Setting::Setting(){
+	type= tString;
+	min= 0.f;
+	max= 0.f;
+	boolValue= false;
+	intValue= 0;
+	floatValue= 0.f;
+}
+
+void Setting::init(const string &key, Type type, const string &defaultValue, float min, float max){
+	this->key= key;
+	this->type= type;
+	this->defaultValue= defaultValue;
+	this->min= min;
+	this->max= max;
+	setValue(defaultValue);
+}
+
+void Setting::load(const Properties *properties){
+	if(properties->hasKey(key)){
+		setValue(properties->getString(key));
+	}
+	else{
+		setValue(defaultValue);
+	}
+}
+
+void Setting::setValue(const string &value){
+	try{
+		switch(type){
+		case tBool:
+			boolValue= strToBool(value);
+			intValue= boolValue? 1: 0;
+			floatValue= static_cast<float>(intValue);
+			break;
+		case tInt:
+			intValue= strToInt(value);
+			if(intValue<min || intValue>max){
+				throw runtime_error("Value out of range, min: " + intToStr(static_cast<int>(min)) + ", max: " + intToStr(static_cast<int>(max)));
+			}
+			boolValue= intValue!=0;
+			floatValue= static_cast<float>(intValue);
+			break;
+		case tFloat:
+			floatValue= strToFloat(value);
+			if(floatValue<min || floatValue>max){
+				throw runtime_error("Value out of range, min: " + floatToStr(min) + ", max: " + floatToStr(max));
+			}
+			boolValue= floatValue!=0.f;
+			intValue= static_cast<int>(floatValue);
+			break;
+		case tString:
+			break;
+		}
+		stringValue= value;
+	}
+	catch(exception &e){
+		throw runtime_error("Invalid config value: " + key + "=" + value + "\n" + e.what());
+	}
+}
+
 // =====================================================
 // 	class Config
 // =====================================================
 
+const string Config::fileName= "glest.ini";
+
 Config::Config(){
-	properties.load("glest.ini");
+	declareInt("AiLog", 0, 0, 10);
+	declareBool("AiRedir", false);
+	declareInt("AiThreads", 3, 0, 32);
+	declareBool("AnimationNormalize", false);
+	declareInt("AnimationPoseSteps", 16, 1, 256);
+	declareBool("AutoTest", false);
+	declareBool("CheckGlCaps", true);
+	declareInt("ColorBits", 32, 8, 32);
+	declareInt("ConsoleMaxLines", 10, 1, 100);
+	declareInt("ConsoleTimeout", 20, 1, 3600);
+	declareFloat("DayTime", 1000.f, 1.f, 100000.f);
+	declareBool("DebugMode", false);
+	declareInt("DepthBits", 32, 0, 32);
+	declareString("FactoryGraphics", "OpenGL2");
+	declareString("FactorySound", "DirectSound8");
+	declareInt("FastSpeedLoops", 2, 1, 10);
+	declareString("Filter", "Bilinear");
+	declareInt("FilterMaxAnisotropy", 1, 1, 16);
+	declareBool("FirstTime", false);
+	declareBool("FocusArrows", true);
+	declareBool("FogOfWar", true);
+	declareBool("FogOfWarSmoothing", true);
+	declareInt("FogOfWarSmoothingFrameSkip", 3, 0, 100);
+	declareString("FontConsole", "Verdana");
+	declareString("FontDisplay", "Verdana");
+	declareString("FontMenu", "Verdana");
+	declareInt("IdleRenderFps", 10, 0, 1000);
+	declareString("Lang", "english");
+	declareInt("MaxLights", 4, 0, 8);
+	declareInt("MaxParticles", 5000, 0, 1000000);
+	declareInt("MaxRenderFps", 60, 0, 1000);
+	declareBool("NetworkConsistencyChecks", true);
+	declareFloat("ParticleLodDistance", 40.f, 0.f, 1000.f);
+	declareBool("PhotoMode", false);
+	declareInt("RefreshFrequency", 75, 0, 1000);
+	declareInt("ScreenHeight", 768, 1, 16384);
+	declareInt("ScreenWidth", 1024, 1, 16384);
+	declareInt("ScriptInstructionBudget", 1000000, 0, 1000000000);
+	declareString("ServerIp", "");
+	declareInt("ServerPort", 6666, 1, 65535);
+	declareFloat("ShadowAlpha", 0.2f, 0.f, 1.f);
+	declareInt("ShadowFrameSkip", 2, 0, 100);
+	declareInt("ShadowTextureSize", 512, 64, 4096);
+	declareString("Shadows", "Projected");
+	declareInt("SoundStaticBuffers", 16, 1, 256);
+	declareInt("SoundStreamingBuffers", 4, 1, 64);
+	declareInt("SoundVolumeAmbient", 80, 0, 100);
+	declareInt("SoundVolumeFx", 80, 0, 100);
+	declareInt("SoundVolumeMusic", 80, 0, 100);
+	declareInt("StencilBits", 0, 0, 32);
+	declareBool("Textures3D", true);
+	declareBool("ThreadedSimulation", false);
+	declareInt("TipCount", 3, 0, 1000);
+	declareInt("TipIndex", 0, 0, 1000);
+	declareBool("TipsEnabled", true);
+	declareBool("Windowed", true);
+
+	properties.load(fileName);
+	loadSettings();
 }
 
 Config &Config::getInstance(){
@@ -34,40 +166,116 @@ void Config::save(const string &path){
 	properties.save(path);
 }
 
+void Config::reload(){
+	Properties newProperties;
+	newProperties.load(fileName);
+
+	//validate everything before touching the live settings
+	for(Settings::const_iterator it= settings.begin(); it!=settings.end(); ++it){
+		Setting setting= it->second;
+		setting.load(&newProperties);
+	}
+
+	properties= newProperties;
+	loadSettings();
+	notifyObservers();
+}
+
+const Setting *Config::getSetting(const string &key) const{
+	Settings::const_iterator it= settings.find(key);
+	if(it==settings.end()){
+		throw runtime_error("Undeclared config key: " + key);
+	}
+	return &it->second;
+}
+
 int Config::getInt(const string &key) const{
-	return properties.getInt(key);
+	return getSetting(key)->getInt();
 }
 
 bool Config::getBool(const string &key) const{
-	return properties.getBool(key);
+	return getSetting(key)->getBool();
 }
 
 float Config::getFloat(const string &key) const{
-	return properties.getFloat(key);
+	return getSetting(key)->getFloat();
 }
 
 const string &Config::getString(const string &key) const{
-	return properties.getString(key);
+	return getSetting(key)->getString();
 }
 
 void Config::setInt(const string &key, int value){
-	properties.setInt(key, value);
+	setString(key, intToStr(value));
 }
 
 void Config::setBool(const string &key, bool value){
-	properties.setBool(key, value);
+	setString(key, boolToStr(value));
 }
 
 void Config::setFloat(const string &key, float value){
-	properties.setFloat(key, value);
+	setString(key, floatToStr(value));
 }
 
 void Config::setString(const string &key, const string &value){
+	findSetting(key)->setValue(value);
 	properties.setString(key, value);
 }
 
+void Config::addObserver(ConfigObserver *observer){
+	observers.push_back(observer);
+}
+
+void Config::removeObserver(ConfigObserver *observer){
+	observers.erase(remove(observers.begin(), observers.end(), observer), observers.end());
+}
+
+void Config::notifyObservers(){
+	for(int i=0; i<observers.size(); ++i){
+		observers[i]->configChanged();
+	}
+}
+
 string Config::toString(){
 	return properties.toString();
 }
 
+// ==================== PRIVATE ==================== 
+
+void Config::declareBool(const string &key, bool defaultValue){
+	settings[key].init(key, Setting::tBool, boolToStr(defaultValue), 0.f, 1.f);
+}
+
+void Config::declareInt(const string &key, int defaultValue, int min, int max){
+	settings[key].init(key, Setting::tInt, intToStr(defaultValue), static_cast<float>(min), static_cast<float>(max));
+}
+
+void Config::declareFloat(const string &key, float defaultValue, float min, float max){
+	settings[key].init(key, Setting::tFloat, floatToStr(defaultValue), min, max);
+}
+
+void Config::declareString(const string &key, const string &defaultValue){
+	settings[key].init(key, Setting::tString, defaultValue, 0.f, 0.f);
+}
+
+void Config::loadSettings(){
+	for(Settings::iterator it= settings.begin(); it!=settings.end(); ++it){
+		Setting &setting= it->second;
+		setting.load(&properties);
+
+		//write defaults back so saved files list every key
+		if(!properties.hasKey(setting.getKey())){
+			properties.setString(setting.getKey(), setting.getDefault());
+		}
+	}
+}
+
+Setting *Config::findSetting(const string &key){
+	Settings::iterator it= settings.find(key);
+	if(it==settings.end()){
+		throw runtime_error("Undeclared config key: " + key);
+	}
+	return &it->second;
+}
+
 }}// end namespace
@@ -12,12 +12,73 @@
 #ifndef _GLEST_GAME_CONFIG_H_
 #define _GLEST_GAME_CONFIG_H_
 
+#include <map>
+#include <vector>
+
 #include "properties.h"
 
+using std::map;
+using std::vector;
+
 namespace Glest{ namespace Game{
 
 using Shared::Util::Properties;
 
+// =====================================================
+// 	class Setting
+//
+///	A declared config key, parsed and validated once
+///	when loaded, so reading it is a plain field access
+// =====================================================
+
+class Setting{
+public:
+	enum Type{
+		tBool,
+		tInt,
+		tFloat,
+		tString
+	};
+
+private:
+	string key;
+	Type type;
+	string defaultValue;
+	float min;
+	float max;
+
+	bool boolValue;
+	int intValue;
+	float floatValue;
+	string stringValue;
+
+public:
+	Setting();
+	void init(const string &key, Type type, const string &defaultValue, float min, float max);
+
+	const string &getKey() const			{return key;}
+	Type getType() const					{return type;}
+	const string &getDefault() const		{return defaultValue;}
+
+	bool getBool() const					{return boolValue;}
+	int getInt() const						{return intValue;}
+	float getFloat() const					{return floatValue;}
+	const string &getString() const			{return stringValue;}
+
+	void load(const Properties *properties);
+	void setValue(const string &value);
+};
+
+// =====================================================
+// 	class ConfigObserver
+// =====================================================
+
+class ConfigObserver{
+public:
+	virtual ~ConfigObserver(){}
+	virtual void configChanged()=0;
+};
+
 // =====================================================
 // 	class Config
 //
@@ -25,8 +86,17 @@ using Shared::Util::Properties;
 // =====================================================
 
 class Config{
+private:
+	typedef map<string, Setting> Settings;
+	typedef vector<ConfigObserver*> Observers;
+
+private:
+	static const string fileName;
+
 private:
 	Properties properties;
+	Settings settings;
+	Observers observers;
 
 private:
 	Config();
@@ -34,6 +104,10 @@ private:
 public:
     static Config &getInstance();
 	void save(const string &path="glest.ini");
+	void reload();
+
+	//handles stay valid for the life of the program and follow reloads
+	const Setting *getSetting(const string &key) const;
 
 	int getInt(const string &key) const;
 	bool getBool(const string &key) const;
@@ -45,7 +119,19 @@ public:
 	void setFloat(const string &key, float value);
 	void setString(const string &key, const string &value);
 
+	void addObserver(ConfigObserver *observer);
+	void removeObserver(ConfigObserver *observer);
+	void notifyObservers();
+
 	string toString();
+
+private:
+	void declareBool(const string &key, bool defaultValue);
+	void declareInt(const string &key, int defaultValue, int min, int max);
+	void declareFloat(const string &key, float defaultValue, float min, float max);
+	void declareString(const string &key, const string &defaultValue);
+	void loadSettings();
+	Setting *findSetting(const string &key);
 };
 
 }}//end namespace
@@ -0,0 +1,318 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#include "picker.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "world.h"
+#include "game_camera.h"
+#include "metrics.h"
+#include "unit.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Graphics;
+using namespace Shared::Util;
+
+namespace Glest{ namespace Game{
+
+//units sorted as they are stored in the factions
+static bool compareUnits(const Unit *u1, const Unit *u2){
+	if(u1->getFactionIndex()!=u2->getFactionIndex()){
+		return u1->getFactionIndex()<u2->getFactionIndex();
+	}
+	return u1->getId()<u2->getId();
+}
+
+// =====================================================
+// 	class Picker
+// =====================================================
+
+const float Picker::marchStep= 0.5f;
+
+Picker::Picker(){
+	world= NULL;
+	minHeight= 0.f;
+	maxHeight= 0.f;
+	tanHalfFov= 0.f;
+	aspect= 1.f;
+	nearPlane= 0.f;
+	farPlane= 0.f;
+}
+
+void Picker::init(const World *world){
+	this->world= world;
+
+	//surface height range
+	const Map *map= world->getMap();
+	minHeight= infinity;
+	float maxSurfaceHeight= -infinity;
+	for(int sy=0; sy<map->getSurfaceH(); ++sy){
+		for(int sx=0; sx<map->getSurfaceW(); ++sx){
+			float height= map->getSurfaceCell(sx, sy)->getHeight();
+			minHeight= min(minHeight, height);
+			maxSurfaceHeight= max(maxSurfaceHeight, height);
+		}
+	}
+
+	//tallest unit type in the game
+	float maxUnitHeight= 0.f;
+	for(int i=0; i<world->getFactionCount(); ++i){
+		const FactionType *ft= world->getFaction(i)->getType();
+		for(int j=0; j<ft->getUnitTypeCount(); ++j){
+			maxUnitHeight= max(maxUnitHeight, static_cast<float>(ft->getUnitType(j)->getHeight()));
+		}
+	}
+	maxHeight= maxSurfaceHeight + World::airHeight + maxUnitHeight;
+}
+
+//same view as Renderer::loadGameCameraMatrix and the perspective projection
+void Picker::setCamera(const GameCamera *gameCamera, float fov, float aspect, float nearPlane, float farPlane){
+	eye= gameCamera->getPos();
+	gameCamera->computeAxes(forward, right, up);
+	
+	this->tanHalfFov= tanf(degToRad(fov)/2.f);
+	this->aspect= aspect;
+	this->nearPlane= nearPlane;
+	this->farPlane= farPlane;
+}
+
+bool Picker::computePosition(const Vec2i &screenPos, Vec2i &worldPos) const{
+	Vec3f hit;
+	
+	if(!intersectSurface(computeRay(static_cast<float>(screenPos.x), static_cast<float>(screenPos.y)), hit)){
+		return false;
+	}
+
+	worldPos= Vec2i(static_cast<int>(hit.x+0.5f), static_cast<int>(hit.z+0.5f));
+	return world->getMap()->isInside(worldPos);
+}
+
+//units whose bounding box is inside the frustum of the selection rectangle
+void Picker::computeSelected(Selection::UnitContainer &units, const Vec2i &posDown, const Vec2i &posUp, const Quad2i &visibleQuad) const{
+	const Map *map= world->getMap();
+
+	//compute center and dimensions of selection rectangle
+	int x= (posDown.x+posUp.x) / 2;
+	int y= (posDown.y+posUp.y) / 2;
+	int w= abs(posDown.x-posUp.x);
+	int h= abs(posDown.y-posUp.y);
+	if(w<1) w=1;
+	if(h<1) h=1;
+
+	float x0= x - w/2.f;
+	float x1= x + w/2.f;
+	float y0= y - h/2.f;
+	float y1= y + h/2.f;
+
+	//selection frustum, normals point inside
+	Vec3f corners[4]= {computeRay(x0, y0), computeRay(x1, y0), computeRay(x1, y1), computeRay(x0, y1)};
+	Vec3f center= computeRay(static_cast<float>(x), static_cast<float>(y));
+	Vec3f normals[planeCount];
+	float distances[planeCount];
+
+	for(int i=0; i<4; ++i){
+		Vec3f normal= corners[i].cross(corners[(i+1)%4]);
+		if(normal.dot(center)<0.f){
+			normal= -normal;
+		}
+		normals[i]= normal;
+		distances[i]= -normal.dot(eye);
+	}
+	normals[4]= forward;
+	distances[4]= -(forward.dot(eye) + nearPlane);
+	normals[5]= -forward;
+	distances[5]= forward.dot(eye) + farPlane;
+
+	//candidates from the cells under the frustum
+	Rect2i footprint= computeFootprint(corners);
+	Selection::UnitContainer candidates;
+	for(int j=footprint.p[0].y; j<=footprint.p[1].y; ++j){
+		for(int i=footprint.p[0].x; i<=footprint.p[1].x; ++i){
+			Cell *cell= map->getCell(i, j);
+			for(int f=0; f<fieldCount; ++f){
+				Unit *unit= cell->getUnit(f);
+				if(unit!=NULL){
+					candidates.push_back(unit);
+				}
+			}
+		}
+	}
+	sort(candidates.begin(), candidates.end(), compareUnits);
+	candidates.erase(unique(candidates.begin(), candidates.end()), candidates.end());
+
+	//test bounding boxes
+	for(int i=0; i<candidates.size(); ++i){
+		Unit *unit= candidates[i];
+		if(unit->isAlive() && world->toRenderUnit(unit, visibleQuad)){
+			const UnitType *ut= unit->getType();
+			Vec3f currVec= unit->getCurrVectorFlat();
+			float halfSize= ut->getSize()/2.f;
+			Vec3f boxMin(currVec.x-halfSize, currVec.y, currVec.z-halfSize);
+			Vec3f boxMax(currVec.x+halfSize, currVec.y+ut->getHeight(), currVec.z+halfSize);
+
+			if(!isBoxOutside(normals, distances, boxMin, boxMax)){
+				units.push_back(unit);
+			}
+		}
+	}
+}
+
+// ==================== PRIVATE ==================== 
+
+//ray from the eye through a virtual screen point, scaled to unit view depth
+Vec3f Picker::computeRay(float x, float y) const{
+	const Metrics &metrics= Metrics::getInstance();
+	float nx= 2.f*x/metrics.getVirtualW() - 1.f;
+	float ny= 2.f*y/metrics.getVirtualH() - 1.f;
+
+	return forward + right*(nx*tanHalfFov*aspect) + up*(ny*tanHalfFov);
+}
+
+//bilinear interpolation of the surface vertices
+float Picker::computeSurfaceHeight(float x, float z) const{
+	const Map *map= world->getMap();
+	float fx= clamp(x/Map::mapScale, 0.f, static_cast<float>(map->getSurfaceW()-1));
+	float fz= clamp(z/Map::mapScale, 0.f, static_cast<float>(map->getSurfaceH()-1));
+	int sx= min(static_cast<int>(fx), map->getSurfaceW()-2);
+	int sz= min(static_cast<int>(fz), map->getSurfaceH()-2);
+	float tx= fx-sx;
+	float tz= fz-sz;
+
+	float h00= map->getSurfaceCell(sx, sz)->getHeight();
+	float h10= map->getSurfaceCell(sx+1, sz)->getHeight();
+	float h01= map->getSurfaceCell(sx, sz+1)->getHeight();
+	float h11= map->getSurfaceCell(sx+1, sz+1)->getHeight();
+	
+	float h0= h00 + tx*(h10-h00);
+	float h1= h01 + tx*(h11-h01);
+	return h0 + tz*(h1-h0);
+}
+
+//marches the ray over the heightfield and refines the crossing by bisection
+bool Picker::intersectSurface(const Vec3f &ray, Vec3f &hit) const{
+	float t0, t1;
+	
+	if(!clipToHeights(ray, t0, t1)){
+		return false;
+	}
+
+	Vec3f p= eye + ray*t0;
+	if(p.y<=computeSurfaceHeight(p.x, p.z)){
+		hit= p;
+		return true;
+	}
+	
+	float step= marchStep/ray.length();
+	float tAbove= t0;
+	for(float t= t0+step; tAbove<t1; t+= step){
+		if(t>t1){
+			t= t1;
+		}
+		p= eye + ray*t;
+		if(p.y<=computeSurfaceHeight(p.x, p.z)){
+			float tBelow= t;
+			for(int i=0; i<refineSteps; ++i){
+				float tMid= (tAbove+tBelow)/2.f;
+				Vec3f pMid= eye + ray*tMid;
+				if(pMid.y<=computeSurfaceHeight(pMid.x, pMid.z)){
+					tBelow= tMid;
+				}
+				else{
+					tAbove= tMid;
+				}
+			}
+			hit= eye + ray*tBelow;
+			return true;
+		}
+		tAbove= t;
+	}
+	return false;
+}
+
+//map cells that can hold a unit inside the frustum given by its corner rays
+Rect2i Picker::computeFootprint(const Vec3f *corners) const{
+	const Map *map= world->getMap();
+	const int margin= 2;	//moving units are drawn up to a cell away from their pos
+	
+	Vec3f points[8];
+	for(int i=0; i<4; ++i){
+		float t0, t1;
+		if(!clipToHeights(corners[i], t0, t1)){
+			
+			//some edge misses the height range, use the whole frustum
+			for(int j=0; j<4; ++j){
+				points[j*2]= eye + corners[j]*nearPlane;
+				points[j*2+1]= eye + corners[j]*farPlane;
+			}
+			break;
+		}
+		points[i*2]= eye + corners[i]*t0;
+		points[i*2+1]= eye + corners[i]*t1;
+	}
+
+	float minX= points[0].x, maxX= points[0].x;
+	float minZ= points[0].z, maxZ= points[0].z;
+	for(int i=1; i<8; ++i){
+		minX= min(minX, points[i].x);
+		maxX= max(maxX, points[i].x);
+		minZ= min(minZ, points[i].z);
+		maxZ= max(maxZ, points[i].z);
+	}
+
+	Rect2i rect(
+		static_cast<int>(floorf(minX))-margin, static_cast<int>(floorf(minZ))-margin,
+		static_cast<int>(ceilf(maxX))+margin, static_cast<int>(ceilf(maxZ))+margin);
+	rect.clamp(0, 0, map->getW()-1, map->getH()-1);
+	return rect;
+}
+
+//clips the view depth range of the ray to the heights units and surface can have
+bool Picker::clipToHeights(const Vec3f &ray, float &t0, float &t1) const{
+	t0= nearPlane;
+	t1= farPlane;
+	
+	if(fabs(ray.y)<zero){
+		return eye.y>=minHeight && eye.y<=maxHeight;
+	}
+
+	float tMin= (minHeight-eye.y)/ray.y;
+	float tMax= (maxHeight-eye.y)/ray.y;
+	if(tMin>tMax){
+		swap(tMin, tMax);
+	}
+	t0= max(t0, tMin);
+	t1= min(t1, tMax);
+	return t0<=t1;
+}
+
+bool Picker::isBoxOutside(const Vec3f *normals, const float *distances, const Vec3f &boxMin, const Vec3f &boxMax){
+	for(int i=0; i<planeCount; ++i){
+		const Vec3f &n= normals[i];
+
+		//box corner furthest along the normal
+		Vec3f p(
+			n.x>=0.f? boxMax.x: boxMin.x,
+			n.y>=0.f? boxMax.y: boxMin.y,
+			n.z>=0.f? boxMax.z: boxMin.z);
+		
+		if(n.dot(p)+distances[i]<0.f){
+			return true;
+		}
+	}
+	return false;
+}
+
+}}//end namespace
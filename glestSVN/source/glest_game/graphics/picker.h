@@ -0,0 +1,80 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#ifndef _GLEST_GAME_PICKER_H_
+#define _GLEST_GAME_PICKER_H_
+
+#include "vec.h"
+#include "math_util.h"
+#include "selection.h"
+
+namespace Glest{ namespace Game{
+
+using Shared::Graphics::Vec2i;
+using Shared::Graphics::Vec3f;
+using Shared::Graphics::Quad2i;
+using Shared::Graphics::Rect2i;
+
+class World;
+class GameCamera;
+
+// =====================================================
+// 	class Picker
+//
+///	Resolves screen positions to map cells and units on 
+/// the CPU, casting rays from the game camera against the
+/// surface heightfield and unit bounding boxes, so picking
+/// never reads back from or waits for the GPU
+// =====================================================
+
+class Picker{
+private:
+	static const int planeCount= 6;
+	static const float marchStep;
+	static const int refineSteps= 8;
+
+private:
+	const World *world;
+	float minHeight;	//lowest surface vertex
+	float maxHeight;	//highest point a unit can reach
+
+	//camera
+	Vec3f eye;
+	Vec3f forward;
+	Vec3f right;
+	Vec3f up;
+	float tanHalfFov;
+	float aspect;
+	float nearPlane;
+	float farPlane;
+
+public:
+	Picker();
+
+	void init(const World *world);
+	void setCamera(const GameCamera *gameCamera, float fov, float aspect, float nearPlane, float farPlane);
+
+	bool computePosition(const Vec2i &screenPos, Vec2i &worldPos) const;
+	void computeSelected(Selection::UnitContainer &units, const Vec2i &posDown, const Vec2i &posUp, const Quad2i &visibleQuad) const;
+
+private:
+	Vec3f computeRay(float x, float y) const;
+	float computeSurfaceHeight(float x, float z) const;
+	bool intersectSurface(const Vec3f &ray, Vec3f &hit) const;
+	Rect2i computeFootprint(const Vec3f *corners) const;
+	bool clipToHeights(const Vec3f &ray, float &t0, float &t1) const;
+	static bool isBoxOutside(const Vec3f *normals, const float *distances, const Vec3f &boxMin, const Vec3f &boxMax);
+};
+
+}}//end namespace
+
+#endif
@@ -0,0 +1,113 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#ifndef _GLEST_GAME_RENDERFRAME_H_
+#define _GLEST_GAME_RENDERFRAME_H_
+
+#include <vector>
+#include <string>
+
+#include "vec.h"
+#include "model.h"
+#include "texture.h"
+#include "display.h"
+#include "water_effects.h"
+#include "game_camera.h"
+
+using std::vector;
+using std::string;
+
+namespace Glest{ namespace Game{
+
+using Shared::Graphics::Vec2i;
+using Shared::Graphics::Vec3f;
+using Shared::Graphics::Vec4f;
+using Shared::Graphics::Model;
+using Shared::Graphics::Texture2D;
+
+// =====================================================
+// 	class RenderFrame
+//
+///	What a frame draws from the world and the gui besides 
+/// the render lists. It is copied while the simulation is
+/// stopped, so the frame can be drawn while it runs
+// =====================================================
+
+class RenderFrame{
+public:
+	class Circle{
+	public:
+		Vec3f pos;
+		int size;
+		float radius;
+		Vec4f color;
+	};
+
+	class Arrow{
+	public:
+		Vec3f pos1;
+		Vec3f pos2;
+		Vec3f color;
+	};
+
+	class MinimapUnit{
+	public:
+		Vec2i pos;
+		int size;
+		Vec3f color;
+	};
+
+	class ResourceStatus{
+	public:
+		const Texture2D *image;
+		string text;
+	};
+
+	typedef vector<Circle> Circles;
+	typedef vector<Arrow> Arrows;
+	typedef vector<WaterSplash> WaterSplashes;
+	typedef vector<MinimapUnit> MinimapUnits;
+	typedef vector<ResourceStatus> ResourceStatuses;
+
+public:
+	//time of day
+	float time;
+	bool day;
+
+	//camera, scripts move it from the simulation
+	Vec3f cameraPos;
+	float cameraHAng;
+	GameCamera::State cameraState;
+
+	//3d
+	WaterSplashes waterSplashes;	//only the visible ones
+	Circles circles;
+	Arrows arrows;
+
+	//mouse 3d, the building model is NULL unless placing a building
+	bool mouse3dVisible;
+	Vec3f mouse3dPos;
+	float mouse3dFade;
+	int mouse3dRot;
+	const Model *buildingModel;
+	int buildingSize;
+	bool buildingPlaceable;
+
+	//2d
+	Display display;
+	MinimapUnits minimapUnits;
+	ResourceStatuses resourceStatuses;
+};
+
+}}//end namespace
+
+#endif
@@ -0,0 +1,210 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#include "render_list.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "world.h"
+#include "game_camera.h"
+#include "map.h"
+#include "object.h"
+#include "leak_dumper.h"
+
+using namespace std;
+using namespace Shared::Graphics;
+
+namespace Glest{ namespace Game{
+
+//same model together, then front to back
+static bool compareUnitEntries(const RenderList::UnitEntry &e1, const RenderList::UnitEntry &e2){
+	if(e1.unit.model!=e2.unit.model){
+		return e1.unit.model<e2.unit.model;
+	}
+	return e1.depth<e2.depth;
+}
+
+static bool compareObjectEntries(const RenderList::ObjectEntry &e1, const RenderList::ObjectEntry &e2){
+	if(e1.model!=e2.model){
+		return e1.model<e2.model;
+	}
+	return e1.depth<e2.depth;
+}
+
+//radius around the model origin that holds the model whatever its rotation
+static float computeBoundingRadius(const Model *model){
+	return model->getBoundingCenter().length() + model->getBoundingRadius();
+}
+
+// =====================================================
+// 	class ViewFrustum
+// =====================================================
+
+void ViewFrustum::init(const GameCamera *gameCamera, float fov, float aspect, float nearPlane, float farPlane){
+	Vec3f right, up;
+	
+	eye= gameCamera->getPos();
+	gameCamera->computeAxes(forward, right, up);
+
+	float tanHalfFov= tanf(degToRad(fov)/2.f);
+	Vec3f halfW= right*(tanHalfFov*aspect);
+	Vec3f halfH= up*tanHalfFov;
+
+	//side planes go through the eye
+	Vec3f corners[4]= {forward-halfW-halfH, forward+halfW-halfH, forward+halfW+halfH, forward-halfW+halfH};
+	for(int i=0; i<4; ++i){
+		Vec3f normal= corners[i].cross(corners[(i+1)%4]);
+		if(normal.dot(forward)<0.f){
+			normal= -normal;
+		}
+		normal.normalize();
+		normals[i]= normal;
+		distances[i]= -normal.dot(eye);
+	}
+	normals[4]= forward;
+	distances[4]= -(forward.dot(eye) + nearPlane);
+	normals[5]= -forward;
+	distances[5]= forward.dot(eye) + farPlane;
+}
+
+//planes of the clip volume of GL matrices, depth goes along the near plane normal
+void ViewFrustum::init(const Matrix4f &projection, const Matrix4f &modelview){
+	
+	//clip= projection*modelview, both column major
+	float clip[16];
+	for(int col=0; col<4; ++col){
+		for(int row=0; row<4; ++row){
+			float sum= 0.f;
+			for(int k=0; k<4; ++k){
+				sum+= projection[k*4+row]*modelview[col*4+k];
+			}
+			clip[col*4+row]= sum;
+		}
+	}
+
+	//each pair of planes is w+r and w-r for a row r of the clip matrix
+	for(int i=0; i<planeCount; ++i){
+		int row= i/2;
+		float sign= i%2==0? 1.f: -1.f;
+		Vec3f normal(
+			clip[3] + sign*clip[row], 
+			clip[7] + sign*clip[4+row], 
+			clip[11] + sign*clip[8+row]);
+		float distance= clip[15] + sign*clip[12+row];
+		float length= normal.length();
+		normals[i]= normal/length;
+		distances[i]= distance/length;
+	}
+
+	eye= Vec3f(0.f);
+	forward= normals[4];
+}
+
+bool ViewFrustum::isSphereOutside(const Vec3f &center, float radius) const{
+	for(int i=0; i<planeCount; ++i){
+		if(normals[i].dot(center)+distances[i] < -radius){
+			return true;
+		}
+	}
+	return false;
+}
+
+// =====================================================
+// 	class RenderList
+// =====================================================
+
+void RenderList::build(const World *world, const ViewFrustum &frustum, const Quad2i &visibleQuad){
+	buildUnits(world, frustum, visibleQuad);
+	buildObjects(world, frustum, visibleQuad);
+}
+
+void RenderList::clear(){
+	units.clear();
+	objects.clear();
+}
+
+// ==================== PRIVATE ==================== 
+
+//units come from the sectors of the current snapshot under the visible quad
+void RenderList::buildUnits(const World *world, const ViewFrustum &frustum, const Quad2i &visibleQuad){
+	SnapshotInterpolator interpolator(world->getSnapshotBuffer());
+	const RenderSnapshot *snapshot= interpolator.getCurrent();
+	
+	units.clear();
+	if(snapshot->getSectorW()==0){
+		return;
+	}
+
+	Rect2i rect= visibleQuad.computeBoundingRect();
+	int sx0= max(rect.p[0].x/RenderSnapshot::sectorSize, 0);
+	int sy0= max(rect.p[0].y/RenderSnapshot::sectorSize, 0);
+	int sx1= min(rect.p[1].x/RenderSnapshot::sectorSize, snapshot->getSectorW()-1);
+	int sy1= min(rect.p[1].y/RenderSnapshot::sectorSize, snapshot->getSectorH()-1);
+
+	UnitEntry entry;
+	for(int sy=sy0; sy<=sy1; ++sy){
+		for(int sx=sx0; sx<=sx1; ++sx){
+			int end= snapshot->getSectorEnd(sx, sy);
+			for(int i=snapshot->getSectorBegin(sx, sy); i<end; ++i){
+				const UnitSnapshot *us= snapshot->getSectorUnit(i);
+				if(!us->visible || !visibleQuad.isInside(us->pos)){
+					continue;
+				}
+
+				interpolator.interpolate(us, entry.unit);
+				
+				const Vec3f &v= entry.unit.vector;
+				if(!frustum.isSphereOutside(v, computeBoundingRadius(entry.unit.model))){
+					entry.depth= frustum.computeDepth(v);
+					units.push_back(entry);
+				}
+			}
+		}
+	}
+	sort(units.begin(), units.end(), compareUnitEntries);
+}
+
+void RenderList::buildObjects(const World *world, const ViewFrustum &frustum, const Quad2i &visibleQuad){
+	const Map *map= world->getMap();
+	const Pixmap2D *fowPixmap= world->getMinimap()->getFowTexture()->getPixmap();
+	int thisTeamIndex= world->getThisTeamIndex();
+
+	objects.clear();
+
+	PosQuadIterator pqi(map, visibleQuad, Map::cellScale);
+	while(pqi.next()){
+		const Vec2i pos= pqi.getPos();
+
+		if(map->isInside(pos)){
+			SurfaceCell *sc= map->getSurfaceCell(Map::toSurfCoords(pos));
+			Object *o= sc->getObject();
+			if(sc->isExplored(thisTeamIndex) && o!=NULL){
+
+				Vec3f v= o->getPos();
+				if(!frustum.isSphereOutside(v, computeBoundingRadius(o->getModel()))){
+					ObjectEntry entry;
+					entry.model= o->getModel();
+					entry.vector= v;
+					entry.rotation= o->getRotation();
+					entry.pos= pos;
+					entry.fowFactor= fowPixmap->getPixelf(pos.x/Map::cellScale, pos.y/Map::cellScale);
+					entry.depth= frustum.computeDepth(v);
+					objects.push_back(entry);
+				}
+			}
+		}
+	}
+	sort(objects.begin(), objects.end(), compareObjectEntries);
+}
+
+}}//end namespace
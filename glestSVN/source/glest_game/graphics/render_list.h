@@ -0,0 +1,106 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#ifndef _GLEST_GAME_RENDERLIST_H_
+#define _GLEST_GAME_RENDERLIST_H_
+
+#include <vector>
+
+#include "vec.h"
+#include "math_util.h"
+#include "matrix.h"
+#include "render_snapshot.h"
+
+using std::vector;
+
+namespace Glest{ namespace Game{
+
+using Shared::Graphics::Vec2i;
+using Shared::Graphics::Vec3f;
+using Shared::Graphics::Quad2i;
+using Shared::Graphics::Matrix4f;
+
+class World;
+class GameCamera;
+
+// =====================================================
+// 	class ViewFrustum
+//
+///	A camera or light view volume in world space
+// =====================================================
+
+class ViewFrustum{
+private:
+	static const int planeCount= 6;
+
+private:
+	Vec3f eye;
+	Vec3f forward;
+	Vec3f normals[planeCount];	//pointing inside
+	float distances[planeCount];
+
+public:
+	void init(const GameCamera *gameCamera, float fov, float aspect, float nearPlane, float farPlane);
+	void init(const Matrix4f &projection, const Matrix4f &modelview);
+
+	const Vec3f &getEye() const			{return eye;}
+	float computeDepth(const Vec3f &v) const	{return forward.dot(v-eye);}
+	bool isSphereOutside(const Vec3f &center, float radius) const;
+};
+
+// =====================================================
+// 	class RenderList
+//
+///	Units and objects inside the view frustum, sorted by 
+/// model and then front to back. Entries are copies, so
+/// they stay valid when the world changes after the build
+// =====================================================
+
+class RenderList{
+public:
+	class UnitEntry{
+	public:
+		UnitSnapshot unit;	//interpolated
+		float depth;
+	};
+
+	class ObjectEntry{
+	public:
+		const Model *model;
+		Vec3f vector;
+		float rotation;
+		Vec2i pos;
+		float fowFactor;	//fog of war at the object cell, between 0 and 1
+		float depth;
+	};
+
+private:
+	vector<UnitEntry> units;
+	vector<ObjectEntry> objects;
+
+public:
+	int getUnitCount() const							{return units.size();}
+	const UnitEntry *getUnit(int i) const				{return &units[i];}
+	int getObjectCount() const							{return objects.size();}
+	const ObjectEntry *getObject(int i) const			{return &objects[i];}
+
+	void build(const World *world, const ViewFrustum &frustum, const Quad2i &visibleQuad);
+	void clear();
+
+private:
+	void buildUnits(const World *world, const ViewFrustum &frustum, const Quad2i &visibleQuad);
+	void buildObjects(const World *world, const ViewFrustum &frustum, const Quad2i &visibleQuad);
+};
+
+}}//end namespace
+
+#endif
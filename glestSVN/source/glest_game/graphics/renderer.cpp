@@ -24,6 +24,10 @@
 #include "opengl.h"
 #include "faction.h"
 #include "factory_repository.h"
+#include "render_list.h"
+#include "water_geometry.h"
+#include "interpolation.h"
+#include "buffer_manager_gl.h"
 #include "leak_dumper.h"
 
 //#include "glprocs.h"
@@ -141,6 +145,9 @@ const Vec4f Renderer::defColor= Vec4f(1.f, 1.f, 1.f, 1.f);
 
 const float Renderer::maxLightDist= 50.f;
 
+const float Renderer::shadowAngleStep= 1.f;
+const int Renderer::shadowCasterMargin= 20;
+
 // ==================== constructor and destructor ==================== 
 
 Renderer::Renderer(){
@@ -148,6 +155,9 @@ Renderer::Renderer(){
 	FactoryRepository &fr= FactoryRepository::getInstance();
 	Config &config= Config::getInstance();
 	
+	game= NULL;
+	config.addObserver(this);
+
 	gi.setFactory(fr.getGraphicsFactory(config.getString("FactoryGraphics")));
 	GraphicsFactory *graphicsFactory= GraphicsInterface::getInstance().getFactory();
 
@@ -166,6 +176,8 @@ Renderer::Renderer(){
 }
 
 Renderer::~Renderer(){
+	Config::getInstance().removeObserver(this);
+
 	delete modelRenderer;
 	delete textRenderer;
 	delete particleRenderer;
@@ -213,11 +225,18 @@ void Renderer::init(){
 void Renderer::initGame(Game *game){
 	this->game= game;
 
+	//picking
+	picker.init(game->getWorld());
+
+	//water
+	waterGeometry.init(game->getWorld()->getMap(), isGlVersionSupported(1, 5, 0));
+
 	//check gl caps
 	checkGlOptionalCaps();
 
 	//vars
 	shadowMapFrame= 0;
+	staticShadowValid= false;
 	waterAnim= 0;
 
 	//shadows
@@ -250,6 +269,19 @@ void Renderer::initGame(Game *game){
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, 
 				shadowTextureSize, shadowTextureSize, 
 				0, GL_LUMINANCE, GL_UNSIGNED_BYTE, NULL);
+
+			//static layer, copied back before the moving units are added
+			glGenTextures(1, &staticShadowMapHandle);
+			glBindTexture(GL_TEXTURE_2D, staticShadowMapHandle);
+
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, 
+				shadowTextureSize, shadowTextureSize, 
+				0, GL_LUMINANCE, GL_UNSIGNED_BYTE, NULL);
 		}
 
 		shadowMapFrame= -1;
@@ -304,6 +336,7 @@ void Renderer::end(){
 	textureManager[rsGlobal]->end();
 	fontManager[rsGlobal]->end();
 	particleManager[rsGlobal]->end();
+	BufferManagerGl::getInstance().end();
 
 	//delete 2d list
 	glDeleteLists(list2d, 1);
@@ -311,6 +344,9 @@ void Renderer::end(){
 
 void Renderer::endGame(){
 	game= NULL;
+	renderList.clear();
+	shadowRenderList.clear();
+	waterGeometry.end();
 
 	//delete resources
 	modelManager[rsGame]->end();
@@ -321,6 +357,9 @@ void Renderer::endGame(){
 	if(shadows==sProjected || shadows==sShadowMapping){
 		glDeleteTextures(1, &shadowMapHandle);
 	}
+	if(shadows==sProjected){
+		glDeleteTextures(1, &staticShadowMapHandle);
+	}
 
 	glDeleteLists(list3d, 1);
 }
@@ -371,7 +410,18 @@ void Renderer::manageParticleSystem(ParticleSystem *particleSystem, ResourceScop
 	particleManager[rs]->manage(particleSystem);
 }
 
+void Renderer::fadeParticleSystem(ParticleSystem *particleSystem, ResourceScope rs){
+	particleManager[rs]->fade(particleSystem);
+}
+
+void Renderer::setParticleSystemActive(ParticleSystem *particleSystem, bool active, ResourceScope rs){
+	particleManager[rs]->setActive(particleSystem, active);
+}
+
 void Renderer::updateParticleManager(ResourceScope rs){
+	if(rs==rsGame && game!=NULL){
+		particleManager[rs]->setView(game->getGameCamera()->getPos(), particleLodDistance);
+	}
 	particleManager[rs]->update();
 }
 
@@ -426,7 +476,7 @@ void Renderer::setupLighting(){
             for(int j=0; j<world->getFaction(i)->getUnitCount() && lightCount<maxLights; ++j){
                 Unit *unit= world->getFaction(i)->getUnit(j);
 				if(world->toRenderUnit(unit) &&
-					unit->getCurrVector().dist(gameCamera->getPos())<maxLightDist &&
+					unit->getCurrVector().sqDist(gameCamera->getPos())<maxLightDist*maxLightDist &&
                     unit->getType()->getLight() && unit->isOperative()){
 
 					Vec4f pos= Vec4f(unit->getCurrVector());
@@ -445,7 +495,7 @@ void Renderer::setupLighting(){
                 
 					const GameCamera *gameCamera= game->getGameCamera();
 
-					if(Vec3f(pos).dist(gameCamera->getPos())<Vec3f(nearestLightPos).dist(gameCamera->getPos())){
+					if(Vec3f(pos).sqDist(gameCamera->getPos())<Vec3f(nearestLightPos).sqDist(gameCamera->getPos())){
 						nearestLightPos= pos;
 					}
                 }
@@ -481,6 +531,41 @@ void Renderer::computeVisibleQuad(){
 	visibleQuad= gameCamera->computeVisibleQuad();
 }
 
+//units and objects in the view frustum, used by all the passes of this frame
+void Renderer::computeRenderLists(){
+	const Metrics &metrics= Metrics::getInstance();
+	float clipping= photoMode ? perspFarPlane*100 : perspFarPlane;
+
+	viewFrustum.init(game->getGameCamera(), perspFov, metrics.getAspectRatio(), perspNearPlane, clipping);
+	renderList.build(game->getWorld(), viewFrustum, visibleQuad);
+}
+
+// ==================== frame capture ==================== 
+
+//copies what the frame draws from the world and the gui, called with the simulation 
+//stopped after the render lists and the lights, the frame is then drawn from the copies
+void Renderer::captureFrame(){
+	const World *world= game->getWorld();
+	const TimeFlow *timeFlow= world->getTimeFlow();
+	const GameCamera *gameCamera= game->getGameCamera();
+
+	frame.time= timeFlow->getTime();
+	frame.day= timeFlow->isDay();
+	frame.cameraPos= gameCamera->getPos();
+	frame.cameraHAng= gameCamera->getHAng();
+	frame.cameraState= gameCamera->getState();
+	frame.display= *game->getGui()->getDisplay();
+	waterAnim= world->getWaterEffects()->getAmin();
+
+	updateFowTexture();
+	captureSelectionEffects();
+	captureWaterEffects();
+	captureMouse3d();
+	captureMinimap();
+	captureResourceStatus();
+	captureShadows();
+}
+
 // =======================================
 // basic rendering
 // =======================================
@@ -520,17 +605,13 @@ void Renderer::renderMouse2d(int x, int y, int anim, float fade){
 }
 
 void Renderer::renderMouse3d(){   
-    
-	const Gui *gui= game->getGui();
-	const Mouse3d *mouse3d= gui->getMouse3d();
-	const Map *map= game->getWorld()->getMap();
 
 	GLUquadricObj *cilQuadric;
 	Vec4f color;
 	
 	assertGl();
 
-	if((mouse3d->isEnabled() || gui->isPlacingBuilding()) && gui->isValidPosObjWorld()){
+	if(frame.mouse3dVisible){
 
 		glMatrixMode(GL_MODELVIEW);
 		glPushMatrix();
@@ -541,19 +622,16 @@ void Renderer::renderMouse3d(){
 		glEnable(GL_COLOR_MATERIAL);
 		glDepthMask(GL_FALSE);
 
-		Vec2i pos= gui->getPosObjWorld();    
-		Vec3f pos3f= Vec3f(pos.x, map->getCell(pos)->getHeight(), pos.y); 
+		const Vec3f &pos3f= frame.mouse3dPos; 
 		
-		if(gui->isPlacingBuilding()){
-
-			const UnitType *building= gui->getBuilding();
+		if(frame.buildingModel!=NULL){
 
 			//selection building emplacement
-			float offset= building->getSize()/2.f-0.5f;
+			float offset= frame.buildingSize/2.f-0.5f;
 			glTranslatef(pos3f.x+offset, pos3f.y, pos3f.z+offset);
 
 			//choose color
-			if(map->isFreeCells(pos, building->getSize(), fLand)){
+			if(frame.buildingPlaceable){
 				color= Vec4f(1.f, 1.f, 1.f, 0.5f);
 			} 
 			else{
@@ -563,9 +641,8 @@ void Renderer::renderMouse3d(){
 			modelRenderer->begin(true, true, false);
 			glColor4fv(color.ptr());
 			glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, color.ptr());
-			const Model *buildingModel= building->getFirstStOfClass(scStop)->getAnimation();
-			buildingModel->updateInterpolationData(0.f, false);
-			modelRenderer->render(buildingModel);	
+			frame.buildingModel->updateInterpolationData(0.f, false);
+			modelRenderer->render(frame.buildingModel);	
 			glDisable(GL_COLOR_MATERIAL);
 			modelRenderer->end();
 
@@ -574,13 +651,13 @@ void Renderer::renderMouse3d(){
 			//standard mouse
 			glDisable(GL_TEXTURE_2D);
 			glDisable(GL_CULL_FACE);    
-			color= Vec4f(1.f, 0.f, 0.f, 1.f-mouse3d->getFade());
+			color= Vec4f(1.f, 0.f, 0.f, 1.f-frame.mouse3dFade);
 			glColor4fv(color.ptr());
 			glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, color.ptr());
 			
 			glTranslatef(pos3f.x, pos3f.y+2.f, pos3f.z);
 			glRotatef(90.f, 1.f, 0.f, 0.f);
-			glRotatef(static_cast<float>(mouse3d->getRot()), 0.f, 0.f, 1.f);
+			glRotatef(static_cast<float>(frame.mouse3dRot), 0.f, 0.f, 1.f);
 
 			cilQuadric= gluNewQuadric();
 			gluQuadricDrawStyle(cilQuadric, GLU_FILL);
@@ -671,55 +748,23 @@ void Renderer::renderChatManager(const ChatManager *chatManager){
 void Renderer::renderResourceStatus(){
 	
 	const Metrics &metrics= Metrics::getInstance();
-	const World *world= game->getWorld();
-	const Faction *thisFaction= world->getFaction(world->getThisFactionIndex());
 
 	assertGl();
 
 	glPushAttrib(GL_ENABLE_BIT);
 	
-	int j= 0; 
-	for(int i= 0; i<world->getTechTree()->getResourceTypeCount(); ++i){
-		const ResourceType *rt= world->getTechTree()->getResourceType(i);
-		const Resource *r= thisFaction->getResource(rt);
-		
-		//if any unit produces the resource
-		bool showResource= false;
-		for(int k=0; k<thisFaction->getType()->getUnitTypeCount(); ++k){
-			const UnitType *ut= thisFaction->getType()->getUnitType(k); 
-			if(ut->getCost(rt)!=NULL){
-				showResource= true;
-				break;
-			}
-		}
+	for(int j= 0; j<frame.resourceStatuses.size(); ++j){
+		const RenderFrame::ResourceStatus &resourceStatus= frame.resourceStatuses[j];
 
 		//draw resource status
-		if(showResource){
-		
-			string str= intToStr(r->getAmount());
-			
-			glEnable(GL_TEXTURE_2D);
-			renderQuad(j*100+200, metrics.getVirtualH()-30, 16, 16, rt->getImage());
-			
-			if(rt->getClass()!=rcStatic){
-				str+= "/" + intToStr(thisFaction->getStoreAmount(rt));
-			}	
-			if(rt->getClass()==rcConsumable){
-				str+= "(";
-				if(r->getBalance()>0){
-					str+= "+";
-				}
-				str+= intToStr(r->getBalance()) + ")";
-			}
-
-			glDisable(GL_TEXTURE_2D);
+		glEnable(GL_TEXTURE_2D);
+		renderQuad(j*100+200, metrics.getVirtualH()-30, 16, 16, resourceStatus.image);
 
-			renderTextShadow(
-				str, CoreData::getInstance().getMenuFontSmall(), 
-				j*100+220, metrics.getVirtualH()-30, false); 
-			++j;
-		}
+		glDisable(GL_TEXTURE_2D);
 
+		renderTextShadow(
+			resourceStatus.text, CoreData::getInstance().getMenuFontSmall(), 
+			j*100+220, metrics.getVirtualH()-30, false); 
 	}
 	
 	glPopAttrib();
@@ -748,14 +793,15 @@ void Renderer::renderSelectionQuad(){
     }
 }
 
-Vec2i computeCenteredPos(const string &text, const Font2D *font, int x, int y){
+//the text width comes from the cached layout of the string
+Vec2i computeCenteredPos(TextRenderer2D *textRenderer, const string &text, const Font2D *font, int x, int y){
 	Vec2i textPos;
 
 	const Metrics &metrics= Metrics::getInstance();
 	const FontMetrics *fontMetrics= font->getMetrics();
 	
 	textPos= Vec2i(
-		x-metrics.toVirtualX(static_cast<int>(fontMetrics->getTextWidth(text)/2.f)),
+		x-metrics.toVirtualX(static_cast<int>(textRenderer->getTextWidth(font, text)/2.f)),
 		y-metrics.toVirtualY(static_cast<int>(fontMetrics->getHeight()/2.f)));
 
 	return textPos;
@@ -766,7 +812,7 @@ void Renderer::renderText(const string &text, const Font2D *font, float alpha, i
 	glEnable(GL_BLEND);
 	glColor4fv(Vec4f(1.f, 1.f, 1.f, alpha).ptr());
 	
-	Vec2i pos= centered? computeCenteredPos(text, font, x, y): Vec2i(x, y);
+	Vec2i pos= centered? computeCenteredPos(textRenderer, text, font, x, y): Vec2i(x, y);
 
 	textRenderer->begin(font);
 	textRenderer->render(text, pos.x, pos.y);
@@ -779,7 +825,7 @@ void Renderer::renderText(const string &text, const Font2D *font, const Vec3f &c
 	glPushAttrib(GL_CURRENT_BIT);
 	glColor3fv(color.ptr());
 	
-	Vec2i pos= centered? computeCenteredPos(text, font, x, y): Vec2i(x, y);
+	Vec2i pos= centered? computeCenteredPos(textRenderer, text, font, x, y): Vec2i(x, y);
 
 	textRenderer->begin(font);
 	textRenderer->render(text, pos.x, pos.y);
@@ -791,7 +837,7 @@ void Renderer::renderText(const string &text, const Font2D *font, const Vec3f &c
 void Renderer::renderTextShadow(const string &text, const Font2D *font, int x, int y, bool centered){
 	glPushAttrib(GL_CURRENT_BIT);
 	
-	Vec2i pos= centered? computeCenteredPos(text, font, x, y): Vec2i(x, y);
+	Vec2i pos= centered? computeCenteredPos(textRenderer, text, font, x, y): Vec2i(x, y);
 
 	textRenderer->begin(font);
 	glColor3f(0.0f, 0.0f, 0.0f);
@@ -1017,10 +1063,6 @@ void Renderer::renderSurface(){
 	glActiveTexture(fowTexUnit);
 	glEnable(GL_TEXTURE_2D);
 	glBindTexture(GL_TEXTURE_2D, static_cast<const Texture2DGl*>(fowTex)->getHandle());
-	glTexSubImage2D(
-		GL_TEXTURE_2D, 0, 0, 0, 
-		fowTex->getPixmap()->getW(), fowTex->getPixmap()->getH(), 
-		GL_ALPHA, GL_UNSIGNED_BYTE, fowTex->getPixmap()->getPixels());    
 
 	//shadow texture
 	if(shadows==sProjected || shadows==sShadowMapping){
@@ -1048,40 +1090,44 @@ void Renderer::renderSurface(){
 			SurfaceCell *tc10= map->getSurfaceCell(pos.x+1, pos.y);
 			SurfaceCell *tc01= map->getSurfaceCell(pos.x, pos.y+1);
 			SurfaceCell *tc11= map->getSurfaceCell(pos.x+1, pos.y+1);
+			SurfaceCellRender *tcr00= map->getSurfaceCellRender(pos.x, pos.y);
+			SurfaceCellRender *tcr10= map->getSurfaceCellRender(pos.x+1, pos.y);
+			SurfaceCellRender *tcr01= map->getSurfaceCellRender(pos.x, pos.y+1);
+			SurfaceCellRender *tcr11= map->getSurfaceCellRender(pos.x+1, pos.y+1);
 	
 			triangleCount+= 2;
 			pointCount+= 4;
 
 			//set texture
-			currTex= static_cast<const Texture2DGl*>(tc00->getSurfaceTexture())->getHandle();
+			currTex= static_cast<const Texture2DGl*>(tcr00->getSurfaceTexture())->getHandle();
 			if(currTex!=lastTex){
 				lastTex=currTex;
 				glBindTexture(GL_TEXTURE_2D, lastTex);
 			}
 
-			Vec2f surfCoord= tc00->getSurfTexCoord();
+			Vec2f surfCoord= tcr00->getSurfTexCoord();
 
 			glBegin(GL_TRIANGLE_STRIP);
 
 			//draw quad using immediate mode
-			glMultiTexCoord2fv(fowTexUnit, tc01->getFowTexCoord().ptr());
+			glMultiTexCoord2fv(fowTexUnit, tcr01->getFowTexCoord().ptr());
 			glMultiTexCoord2f(baseTexUnit, surfCoord.x, surfCoord.y+coordStep);
-			glNormal3fv(tc01->getNormal().ptr());
+			glNormal3fv(tcr01->getNormal().ptr());
 			glVertex3fv(tc01->getVertex().ptr());
 
-			glMultiTexCoord2fv(fowTexUnit, tc00->getFowTexCoord().ptr());
+			glMultiTexCoord2fv(fowTexUnit, tcr00->getFowTexCoord().ptr());
 			glMultiTexCoord2f(baseTexUnit, surfCoord.x, surfCoord.y);
-			glNormal3fv(tc00->getNormal().ptr());
+			glNormal3fv(tcr00->getNormal().ptr());
 			glVertex3fv(tc00->getVertex().ptr());
 
-			glMultiTexCoord2fv(fowTexUnit, tc11->getFowTexCoord().ptr());
+			glMultiTexCoord2fv(fowTexUnit, tcr11->getFowTexCoord().ptr());
 			glMultiTexCoord2f(baseTexUnit, surfCoord.x+coordStep, surfCoord.y+coordStep);
-			glNormal3fv(tc11->getNormal().ptr());
+			glNormal3fv(tcr11->getNormal().ptr());
 			glVertex3fv(tc11->getVertex().ptr());
 
-			glMultiTexCoord2fv(fowTexUnit, tc10->getFowTexCoord().ptr());
+			glMultiTexCoord2fv(fowTexUnit, tcr10->getFowTexCoord().ptr());
 			glMultiTexCoord2f(baseTexUnit, surfCoord.x+coordStep, surfCoord.y);
-			glNormal3fv(tc10->getNormal().ptr());
+			glNormal3fv(tcr10->getNormal().ptr());
 			glVertex3fv(tc10->getVertex().ptr());
 
 			glEnd();
@@ -1100,11 +1146,9 @@ void Renderer::renderSurface(){
 
 void Renderer::renderObjects(){
 	const World *world= game->getWorld();
-	const Map *map= world->getMap();	
 
     assertGl();
-	const Texture2D *fowTex= world->getMinimap()->getFowTexture();
-	Vec3f baseFogColor= world->getTileset()->getFogColor()*computeLightColor(world->getTimeFlow()->getTime());
+	Vec3f baseFogColor= world->getTileset()->getFogColor()*computeLightColor(frame.time);
 
 	glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_FOG_BIT | GL_LIGHTING_BIT | GL_TEXTURE_BIT);
 
@@ -1124,43 +1168,31 @@ void Renderer::renderObjects(){
     glAlphaFunc(GL_GREATER, 0.5f);
 
 	modelRenderer->begin(true, true, false);
-	int thisTeamIndex= world->getThisTeamIndex();
-
-	PosQuadIterator pqi(map, visibleQuad, Map::cellScale);
-	while(pqi.next()){
-		const Vec2i pos= pqi.getPos();
 
-		if(map->isInside(pos)){
+	for(int i=0; i<renderList.getObjectCount(); ++i){
+		const RenderList::ObjectEntry *entry= renderList.getObject(i);
+		const Model *objModel= entry->model;
+		const Vec3f &v= entry->vector;
 
-			SurfaceCell *sc= map->getSurfaceCell(Map::toSurfCoords(pos));
-			Object *o= sc->getObject();
-			if(sc->isExplored(thisTeamIndex) && o!=NULL){
-
-				const Model *objModel= sc->getObject()->getModel();
-				Vec3f v= o->getPos();
-
-				//ambient and diffuse color is taken from cell color
-				float fowFactor= fowTex->getPixmap()->getPixelf(pos.x/Map::cellScale, pos.y/Map::cellScale);
-				Vec4f color= Vec4f(Vec3f(fowFactor), 1.f);
-				glColor4fv(color.ptr());
-				glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, (color*ambFactor).ptr());
-				glFogfv(GL_FOG_COLOR, (baseFogColor*fowFactor).ptr());
-
-				glMatrixMode(GL_MODELVIEW);
-				glPushMatrix();
-				glTranslatef(v.x, v.y, v.z);
-				glRotatef(o->getRotation(), 0.f, 1.f, 0.f);
+		//ambient and diffuse color is taken from cell color
+		float fowFactor= entry->fowFactor;
+		Vec4f color= Vec4f(Vec3f(fowFactor), 1.f);
+		glColor4fv(color.ptr());
+		glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT, (color*ambFactor).ptr());
+		glFogfv(GL_FOG_COLOR, (baseFogColor*fowFactor).ptr());
 
-				objModel->updateInterpolationData(0.f, true);
-				modelRenderer->render(objModel);
-				
-				triangleCount+= objModel->getTriangleCount();
-				pointCount+= objModel->getVertexCount();
+		glMatrixMode(GL_MODELVIEW);
+		glPushMatrix();
+		glTranslatef(v.x, v.y, v.z);
+		glRotatef(entry->rotation, 0.f, 1.f, 0.f);
 
-				glPopMatrix();
+		objModel->updateInterpolationData(0.f, true);
+		modelRenderer->render(objModel);
+		
+		triangleCount+= objModel->getTriangleCount();
+		pointCount+= objModel->getVertexCount();
 
-			}
-		}
+		glPopMatrix();
 	}
 
 	modelRenderer->end();
@@ -1172,12 +1204,9 @@ void Renderer::renderObjects(){
 
 void Renderer::renderWater(){
 	
-	bool closed= false;
 	const World *world= game->getWorld();
 	const Map *map= world->getMap();
 
-	float waterAnim= world->getWaterEffects()->getAmin();
-
 	//assert
     assertGl();
 
@@ -1213,81 +1242,23 @@ void Renderer::renderWater(){
 	Rect2i scaledRect= boundingRect/Map::cellScale;
 	scaledRect.clamp(0, 0, map->getSurfaceW()-1, map->getSurfaceH()-1);
 
-	float waterLevel= world->getMap()->getWaterLevel();
-    for(int j=scaledRect.p[0].y; j<scaledRect.p[1].y; ++j){
-        glBegin(GL_TRIANGLE_STRIP);
-        	
-		for(int i=scaledRect.p[0].x; i<=scaledRect.p[1].x; ++i){
-			
-			SurfaceCell *tc0= map->getSurfaceCell(i, j);
-            SurfaceCell *tc1= map->getSurfaceCell(i, j+1);
-			
-			int thisTeamIndex= world->getThisTeamIndex();
-			if(tc0->getNearSubmerged() && (tc0->isExplored(thisTeamIndex) || tc1->isExplored(thisTeamIndex))){
-				glNormal3f(0.f, 1.f, 0.f);
-                closed= false;
-
-                triangleCount+= 2;
-				pointCount+= 2;
-
-                //vertex 1
-				glMaterialfv(
-					GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, 
-					computeWaterColor(waterLevel, tc1->getHeight()).ptr());
-				glMultiTexCoord2fv(GL_TEXTURE1, tc1->getFowTexCoord().ptr());
-                glTexCoord3f(i, 1.f, waterAnim);
-				glVertex3f(
-					static_cast<float>(i)*Map::mapScale, 
-					waterLevel, 
-					static_cast<float>(j+1)*Map::mapScale);
-                
-                //vertex 2
-				glMaterialfv(
-					GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, 
-					computeWaterColor(waterLevel, tc0->getHeight()).ptr());
-				glMultiTexCoord2fv(GL_TEXTURE1, tc0->getFowTexCoord().ptr());
-                glTexCoord3f(i, 0.f, waterAnim); 
-                glVertex3f(
-					static_cast<float>(i)*Map::mapScale, 
-					waterLevel, 
-					static_cast<float>(j)*Map::mapScale);
+	//the geometry is static, the animation only moves the water texture
+	glMatrixMode(GL_TEXTURE);
+	glPushMatrix();
+	glLoadIdentity();
+	glTranslatef(0.f, 0.f, waterAnim);
+	glMatrixMode(GL_MODELVIEW);
 
-            }
-            else{
-				if(!closed){
-
-					pointCount+= 2;
-
-					//vertex 1
-					glMaterialfv(
-						GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, 
-						computeWaterColor(waterLevel, tc1->getHeight()).ptr());
-					glMultiTexCoord2fv(GL_TEXTURE1, tc1->getFowTexCoord().ptr());
-					glTexCoord3f(i, 1.f, waterAnim);
-					glVertex3f(
-						static_cast<float>(i)*Map::mapScale, 
-						waterLevel, 
-						static_cast<float>(j+1)*Map::mapScale);
-	                
-					//vertex 2
-					glMaterialfv(
-						GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, 
-						computeWaterColor(waterLevel, tc0->getHeight()).ptr());
-					glMultiTexCoord2fv(GL_TEXTURE1, tc0->getFowTexCoord().ptr());
-					glTexCoord3f(i, 0.f, waterAnim); 
-					glVertex3f(
-						static_cast<float>(i)*Map::mapScale, 
-						waterLevel, 
-						static_cast<float>(j)*Map::mapScale);
-
-					glEnd();
-					glBegin(GL_TRIANGLE_STRIP);
-					closed= true;
-				}
-           	}
-        }
-        glEnd();
-    }
+	//unexplored water is masked by the fow texture, with 3d textures the baked colors drive the material
+	glEnable(GL_COLOR_MATERIAL);
+	glNormal3f(0.f, 1.f, 0.f);
+	int waterTriangleCount= waterGeometry.render(scaledRect, textures3D);
+	triangleCount+= waterTriangleCount;
+	pointCount+= waterTriangleCount*2;
+
+	glMatrixMode(GL_TEXTURE);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
 
 	//restore
 	glPopAttrib();
@@ -1295,8 +1266,8 @@ void Renderer::renderWater(){
 	assertGl();
 }
 
+//renders the units of the render list, taken from the world snapshots, the world itself may be updating meanwhile
 void Renderer::renderUnits(){
-	Unit *unit;
 	const World *world= game->getWorld();
 	MeshCallbackTeamColor meshCallbackTeamColor;
 
@@ -1319,46 +1290,45 @@ void Renderer::renderUnits(){
 
 	modelRenderer->begin(true, true, true, &meshCallbackTeamColor);
 
-	for(int i=0; i<world->getFactionCount(); ++i){
-		meshCallbackTeamColor.setTeamTexture(world->getFaction(i)->getTexture());
-		for(int j=0; j<world->getFaction(i)->getUnitCount(); ++j){
-			unit= world->getFaction(i)->getUnit(j);
-			if(world->toRenderUnit(unit, visibleQuad)) {
-				
-				glMatrixMode(GL_MODELVIEW);
-				glPushMatrix();
-
-				//translate
-				Vec3f currVec= unit->getCurrVectorFlat();
-				glTranslatef(currVec.x, currVec.y, currVec.z);
-				
-				//rotate
-				glRotatef(unit->getRotation(), 0.f, 1.f, 0.f);
-				glRotatef(unit->getVerticalRotation(), 1.f, 0.f, 0.f);
-
-				//dead alpha
-				float alpha= 1.0f;
-				const SkillType *st= unit->getCurrSkill();
-				if(st->getClass()==scDie && static_cast<const DieSkillType*>(st)->getFade()){
-					alpha= 1.0f-unit->getAnimProgress();
-					glDisable(GL_COLOR_MATERIAL);
-					glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, Vec4f(1.0f, 1.0f, 1.0f, alpha).ptr());
-				}
-				else{
-					glEnable(GL_COLOR_MATERIAL);
-				}
-				
-				//render
-				const Model *model= unit->getCurrentModel();
-				model->updateInterpolationData(unit->getAnimProgress(), unit->isAlive());				
-				modelRenderer->render(model);
+	int factionIndex= -1;
+	for(int i=0; i<renderList.getUnitCount(); ++i){
+		const UnitSnapshot *us= &renderList.getUnit(i)->unit;
+			
+		if(us->factionIndex!=factionIndex){
+			factionIndex= us->factionIndex;
+			meshCallbackTeamColor.setTeamTexture(world->getFaction(factionIndex)->getTexture());
+		}
 
-				triangleCount+= model->getTriangleCount();
-				pointCount+= model->getVertexCount();
+		glMatrixMode(GL_MODELVIEW);
+		glPushMatrix();
 
-				glPopMatrix();
-			}
+		//translate
+		glTranslatef(us->vector.x, us->vector.y, us->vector.z);
+		
+		//rotate
+		glRotatef(us->rotation, 0.f, 1.f, 0.f);
+		glRotatef(us->verticalRotation, 1.f, 0.f, 0.f);
+
+		//dead alpha
+		float alpha= 1.0f;
+		if(us->fade){
+			alpha= 1.0f-us->animProgress;
+			glDisable(GL_COLOR_MATERIAL);
+			glMaterialfv(GL_FRONT_AND_BACK, GL_AMBIENT_AND_DIFFUSE, Vec4f(1.0f, 1.0f, 1.0f, alpha).ptr());
+		}
+		else{
+			glEnable(GL_COLOR_MATERIAL);
 		}
+		
+		//render
+		const Model *model= us->model;
+		model->updateInterpolationData(us->animProgress, us->alive);				
+		modelRenderer->render(model);
+
+		triangleCount+= model->getTriangleCount();
+		pointCount+= model->getVertexCount();
+
+		glPopMatrix();
 	}
 	modelRenderer->end();	
 
@@ -1370,12 +1340,9 @@ void Renderer::renderUnits(){
 	assertGl();
 }
 
+//selection circles and arrows, taken from the frame
 void Renderer::renderSelectionEffects(){
 
-	const World *world= game->getWorld();
-	const Map *map= world->getMap();
-	const Selection *selection= game->getGui()->getSelection();	
-
 	glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_DEPTH_BUFFER_BIT);
 	glDisable(GL_LIGHTING);
 	glDisable(GL_TEXTURE_2D);
@@ -1385,106 +1352,24 @@ void Renderer::renderSelectionEffects(){
 	glEnable(GL_BLEND);
 	glLineWidth(2.f);
 
-	//units
-	for(int i=0; i<selection->getCount(); ++i){
-		
-		const Unit *unit= selection->getUnit(i);
-
-		//translate
-		Vec3f currVec= unit->getCurrVectorFlat();
-		currVec.y+= 0.3f;
-				
-		//selection circle
-		if(world->getThisFactionIndex()==unit->getFactionIndex()){
-			glColor4f(0, unit->getHpRatio(), 0, 0.3f);
-		}
-		else{
-			glColor4f(unit->getHpRatio(), 0, 0, 0.3f);
-		}
-		renderSelectionCircle(currVec, unit->getType()->getSize(), selectionCircleRadius);
-		
-		//magic circle
-		if(world->getThisFactionIndex()==unit->getFactionIndex() && unit->getType()->getMaxEp()>0){
-			glColor4f(unit->getEpRatio()/2.f, unit->getEpRatio(), unit->getEpRatio(), 0.5f);	
-			renderSelectionCircle(currVec, unit->getType()->getSize(), magicCircleRadius);
-		}
-	}
-
-	//target arrow
-	if(selection->getCount()==1){
-		const Unit *unit= selection->getUnit(0);	
-		
-		//comand arrow
-		if(focusArrows && unit->anyCommand()){ 
-			const CommandType *ct= unit->getCurrCommand()->getCommandType();
-			if(ct->getClicks()!=cOne){
-				
-				//arrow color
-				Vec3f arrowColor;
-				switch(ct->getClass()){
-				case ccMove:
-					arrowColor= Vec3f(0.f, 1.f, 0.f);
-					break;
-				case ccAttack:
-				case ccAttackStopped:
-					arrowColor= Vec3f(1.f, 0.f, 0.f);
-					break;
-				default:
-					arrowColor= Vec3f(1.f, 1.f, 0.f);
-				}
-
-				//arrow target
-				Vec3f arrowTarget;
-				Command *c= unit->getCurrCommand();
-				if(c->getUnit()!=NULL){
-					arrowTarget= c->getUnit()->getCurrVectorFlat();
-				}
-				else{
-					Vec2i pos= c->getPos(); 
-					arrowTarget= Vec3f(pos.x, map->getCell(pos)->getHeight(), pos.y);
-				}
-
-				renderArrow(unit->getCurrVectorFlat(), arrowTarget, arrowColor, 0.3f);
-			}
-		}
-
-		//meeting point arrow
-		if(unit->getType()->getMeetingPoint()){
-			Vec2i pos= unit->getMeetingPos(); 
-			Vec3f arrowTarget= Vec3f(pos.x, map->getCell(pos)->getHeight(), pos.y);
-			renderArrow(unit->getCurrVectorFlat(), arrowTarget, Vec3f(0.f, 0.f, 1.f), 0.3f);
-		}
-	
+	//circles
+	for(int i=0; i<frame.circles.size(); ++i){
+		const RenderFrame::Circle &circle= frame.circles[i];
+		glColor4fv(circle.color.ptr());
+		renderSelectionCircle(circle.pos, circle.size, circle.radius);
 	}
 
-	//render selection hightlights
-	for(int i=0; i<world->getFactionCount(); ++i){
-		for(int j=0; j<world->getFaction(i)->getUnitCount(); ++j){
-			const Unit *unit= world->getFaction(i)->getUnit(j);
-
-			if(unit->isHighlighted()){
-				float highlight= unit->getHightlight();
-				if(game->getWorld()->getThisFactionIndex()==unit->getFactionIndex()){
-					glColor4f(0.f, 1.f, 0.f, highlight);
-				}
-				else{
-					glColor4f(1.f, 0.f, 0.f, highlight);
-				}
-
-				Vec3f v= unit->getCurrVectorFlat();
-				v.y+= 0.3f;
-				renderSelectionCircle(v, unit->getType()->getSize(), selectionCircleRadius);
-			}
-		}
+	//arrows
+	for(int i=0; i<frame.arrows.size(); ++i){
+		const RenderFrame::Arrow &arrow= frame.arrows[i];
+		renderArrow(arrow.pos1, arrow.pos2, arrow.color, 0.3f);
 	}
 
 	glPopAttrib();
 }
 
 void Renderer::renderWaterEffects(){
-	const World *world= game->getWorld();
-	const WaterEffects *we= world->getWaterEffects();
-	const Map *map= world->getMap();
+	const Map *map= game->getWorld()->getMap();
 	const CoreData &coreData= CoreData::getInstance();
 	float height= map->getWaterLevel()+0.001f;
 	
@@ -1501,31 +1386,21 @@ void Renderer::renderWaterEffects(){
 
 	//splashes
 	glBindTexture(GL_TEXTURE_2D, static_cast<Texture2DGl*>(coreData.getWaterSplashTexture())->getHandle());
-	for(int i=0; i<we->getWaterSplashCount(); ++i){
-		const WaterSplash *ws= we->getWaterSplash(i);
-		
-		//render only if enabled
-		if(ws->getEnabled()){
+	for(int i=0; i<frame.waterSplashes.size(); ++i){
+		const WaterSplash *ws= &frame.waterSplashes[i];
+		float scale= ws->getAnim();
 		
-			//render only if visible
-			Vec2i intPos= Vec2i(static_cast<int>(ws->getPos().x), static_cast<int>(ws->getPos().y));
-			if(map->getSurfaceCell(Map::toSurfCoords(intPos))->isVisible(world->getThisTeamIndex())){
-
-				float scale= ws->getAnim();
-				
-				glColor4f(1.f, 1.f, 1.f, 1.f-ws->getAnim()); 
-				glBegin(GL_TRIANGLE_STRIP);
-					glTexCoord2f(0.f, 1.f);
-					glVertex3f(ws->getPos().x-scale, height, ws->getPos().y+scale);
-					glTexCoord2f(0.f, 0.f);
-					glVertex3f(ws->getPos().x-scale, height, ws->getPos().y-scale);
-					glTexCoord2f(1.f, 1.f);
-					glVertex3f(ws->getPos().x+scale, height, ws->getPos().y+scale);
-					glTexCoord2f(1.f, 0.f);
-					glVertex3f(ws->getPos().x+scale, height, ws->getPos().y-scale);
-				glEnd();
-			}
-		}
+		glColor4f(1.f, 1.f, 1.f, 1.f-ws->getAnim()); 
+		glBegin(GL_TRIANGLE_STRIP);
+			glTexCoord2f(0.f, 1.f);
+			glVertex3f(ws->getPos().x-scale, height, ws->getPos().y+scale);
+			glTexCoord2f(0.f, 0.f);
+			glVertex3f(ws->getPos().x-scale, height, ws->getPos().y-scale);
+			glTexCoord2f(1.f, 1.f);
+			glVertex3f(ws->getPos().x+scale, height, ws->getPos().y+scale);
+			glTexCoord2f(1.f, 0.f);
+			glVertex3f(ws->getPos().x+scale, height, ws->getPos().y-scale);
+		glEnd();
 	}
 
 	glPopAttrib();
@@ -1536,7 +1411,6 @@ void Renderer::renderWaterEffects(){
 void Renderer::renderMinimap(){
     const World *world= game->getWorld();
 	const Minimap *minimap= world->getMinimap();
-	const GameCamera *gameCamera= game->getGameCamera();
 	const Pixmap2D *pixmap= minimap->getTexture()->getPixmap();
 	const Metrics &metrics= Metrics::getInstance();
 
@@ -1599,20 +1473,14 @@ void Renderer::renderMinimap(){
 	
 	//draw units
 	glBegin(GL_QUADS);
-	for(int i=0; i<world->getFactionCount(); ++i){
-		for(int j=0; j<world->getFaction(i)->getUnitCount(); ++j){
-			Unit *unit= world->getFaction(i)->getUnit(j);
-			if(world->toRenderUnit(unit)){
-				Vec2i pos= unit->getPos()/Map::cellScale;
-				int size= unit->getType()->getSize(); 
-				Vec3f color=  world->getFaction(i)->getTexture()->getPixmap()->getPixel3f(0, 0);
-				glColor3fv(color.ptr());
-				glVertex2f(mx + pos.x*zoom.x, my + mh - (pos.y*zoom.y));     
-				glVertex2f(mx + (pos.x+1)*zoom.x+size, my + mh - (pos.y*zoom.y));     
-				glVertex2f(mx + (pos.x+1)*zoom.x+size, my + mh - ((pos.y+size)*zoom.y));     
-				glVertex2f(mx + pos.x*zoom.x, my + mh - ((pos.y+size)*zoom.y));     
-			}
-		}
+	for(int i=0; i<frame.minimapUnits.size(); ++i){
+		const Vec2i &pos= frame.minimapUnits[i].pos;
+		int size= frame.minimapUnits[i].size; 
+		glColor3fv(frame.minimapUnits[i].color.ptr());
+		glVertex2f(mx + pos.x*zoom.x, my + mh - (pos.y*zoom.y));     
+		glVertex2f(mx + (pos.x+1)*zoom.x+size, my + mh - (pos.y*zoom.y));     
+		glVertex2f(mx + (pos.x+1)*zoom.x+size, my + mh - ((pos.y+size)*zoom.y));     
+		glVertex2f(mx + pos.x*zoom.x, my + mh - ((pos.y+size)*zoom.y));     
 	}
 	glEnd();
 
@@ -1620,10 +1488,10 @@ void Renderer::renderMinimap(){
 	float wRatio= static_cast<float>(metrics.getMinimapW()) / world->getMap()->getW();
 	float hRatio= static_cast<float>(metrics.getMinimapH()) / world->getMap()->getH();
 
-    int x= static_cast<int>(gameCamera->getPos().x * wRatio);
-    int y= static_cast<int>(gameCamera->getPos().z * hRatio);
+    int x= static_cast<int>(frame.cameraPos.x * wRatio);
+    int y= static_cast<int>(frame.cameraPos.z * hRatio);
 
-    float ang= degToRad(gameCamera->getHAng());
+    float ang= degToRad(frame.cameraHAng);
 
     glEnable(GL_BLEND);
     
@@ -1651,7 +1519,7 @@ void Renderer::renderDisplay(){
 	
 	CoreData &coreData= CoreData::getInstance();
 	const Metrics &metrics= Metrics::getInstance();
-	const Display *display= game->getGui()->getDisplay();
+	const Display *display= &frame.display;
 
 	glPushAttrib(GL_ENABLE_BIT);
 			
@@ -1870,99 +1738,22 @@ void Renderer::renderMenuBackground(const MenuBackground *menuBackground){
 // ==================== computing ==================== 
 
 bool Renderer::computePosition(const Vec2i &screenPos, Vec2i &worldPos){
-    
-	assertGl();
-	const Map* map= game->getWorld()->getMap();
-	const Metrics &metrics= Metrics::getInstance();
-	float depth= 0.0f;
-	GLdouble modelviewMatrix[16]; 
-	GLdouble projectionMatrix[16];
-	GLint viewport[4]= {0, 0, metrics.getScreenW(), metrics.getScreenH()};
-	GLdouble worldX;
-	GLdouble worldY;
-	GLdouble worldZ;
-	GLint screenX= (screenPos.x * metrics.getScreenW() / metrics.getVirtualW());
-	GLint screenY= (screenPos.y * metrics.getScreenH() / metrics.getVirtualH());	
-
-	//get the depth in the cursor pixel
-	glReadPixels(screenX, screenY, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, &depth);
-
-	//load matrices
-	loadProjectionMatrix();
-    loadGameCameraMatrix();
-
-	//get matrices
-	glGetDoublev(GL_MODELVIEW_MATRIX, modelviewMatrix);
-	glGetDoublev(GL_PROJECTION_MATRIX, projectionMatrix);
-
-	//get the world coordinates
-	gluUnProject(
-		screenX, screenY, depth, 
-		modelviewMatrix, projectionMatrix, viewport,
-		&worldX, &worldY, &worldZ);
-
-	//conver coords to int
-	worldPos= Vec2i(static_cast<int>(worldX+0.5f), static_cast<int>(worldZ+0.5f));
-	
-	//clamp coords to map size
-	return map->isInside(worldPos);
+	loadPickerCamera();
+	return picker.computePosition(screenPos, worldPos);
 }
 
 void Renderer::computeSelected(Selection::UnitContainer &units, const Vec2i &posDown, const Vec2i &posUp){
-	
-	//declarations
-	GLuint selectBuffer[Gui::maxSelBuff];
-	const Metrics &metrics= Metrics::getInstance();
+	loadPickerCamera();
+	picker.computeSelected(units, posDown, posUp, visibleQuad);
+}
 
-	//compute center and dimensions of selection rectangle
-	int x= (posDown.x+posUp.x) / 2;
-	int y= (posDown.y+posUp.y) / 2;
-	int w= abs(posDown.x-posUp.x);
-	int h= abs(posDown.y-posUp.y);
-	if(w<1) w=1;
-	if(h<1) h=1;
 
-	//setup matrices
-	glSelectBuffer(Gui::maxSelBuff, selectBuffer);
-	glMatrixMode(GL_PROJECTION);
-	glPushMatrix();
-	GLint view[]= {0, 0, metrics.getVirtualW(), metrics.getVirtualH()};
-	glRenderMode(GL_SELECT);
-	glLoadIdentity();
-	gluPickMatrix(x, y, w, h, view);
-	gluPerspective(perspFov, metrics.getAspectRatio(), perspNearPlane, perspFarPlane);
-	loadGameCameraMatrix();
+// ==================== shadows ==================== 
 
-	//render units
-	renderUnitsFast();
+//the shadow map frame and the casters were chosen by captureFrame
+void Renderer::renderShadowsToTexture(){
 
-	//pop matrices
-	glMatrixMode(GL_PROJECTION);
-	glPopMatrix();
-
-	//select units
-	int selCount= glRenderMode(GL_RENDER);
-	for(int i=1; i<=selCount; ++i){
-		int factionIndex= selectBuffer[i*5-2];
-		int unitIndex= selectBuffer[i*5-1];
-		const World *world= game->getWorld();
-		if(factionIndex<world->getFactionCount() && unitIndex<world->getFaction(factionIndex)->getUnitCount()){
-			Unit *unit= world->getFaction(factionIndex)->getUnit(unitIndex); 
-			if(unit->isAlive()){
-				units.push_back(unit);
-			}
-		}
-	}
-}
-
-
-// ==================== shadows ==================== 
-
-void Renderer::renderShadowsToTexture(){
-
-	if(shadows==sProjected || shadows==sShadowMapping){
-
-		shadowMapFrame= (shadowMapFrame + 1) % (shadowFrameSkip + 1);
+	if(shadows==sProjected || shadows==sShadowMapping){
 
 		if(shadowMapFrame==0){
 
@@ -1986,55 +1777,8 @@ void Renderer::renderShadowsToTexture(){
 			//set viewport, we leave one texel always in white to avoid problems
 			glViewport(1, 1, shadowTextureSize-2, shadowTextureSize-2);
 			
-			if(nearestLightPos.w==0.f){
-				//directional light
-		
-				//light pos
-				const TimeFlow *tf= game->getWorld()->getTimeFlow();
-				float ang= tf->isDay()? computeSunAngle(tf->getTime()): computeMoonAngle(tf->getTime());
-				ang= radToDeg(ang);	
-
-				//push and set projection
-				glMatrixMode(GL_PROJECTION);
-				glPushMatrix();
-				glLoadIdentity();
-				if(game->getGameCamera()->getState()==GameCamera::sGame){
-					glOrtho(-35, 5, -15, 15, -1000, 1000);
-				}
-				else{
-					glOrtho(-30, 30, -20, 20, -1000, 1000);
-				}
-
-				//push and set modelview
-				glMatrixMode(GL_MODELVIEW);
-				glPushMatrix();
-				glLoadIdentity();
-				
-				glRotatef(15, 0, 1, 0);
-				
-				glRotatef(ang, 1, 0, 0);
-				glRotatef(90, 0, 1, 0);
-				Vec3f pos= game->getGameCamera()->getPos();
-		
-				glTranslatef(static_cast<int>(-pos.x), 0, static_cast<int>(-pos.z));
-
-			}
-			else{
-				//non directional light
-				
-				//push projection
-				glMatrixMode(GL_PROJECTION);
-				glPushMatrix();
-				glLoadIdentity();
-				gluPerspective(150, 1.f, perspNearPlane, perspFarPlane);
-
-				//push modelview
-				glMatrixMode(GL_MODELVIEW);
-				glPushMatrix();
-				glLoadIdentity();
-				glRotatef(-90, -1, 0, 0);
-				glTranslatef(-nearestLightPos.x, -nearestLightPos.y-2, -nearestLightPos.z);
-			}
+			ShadowLayerKey key;
+			loadShadowMatrices(key);
 				
 			if(shadows==sShadowMapping){
 				glEnable(GL_POLYGON_OFFSET_FILL);
@@ -2042,8 +1786,29 @@ void Renderer::renderShadowsToTexture(){
 			}
 
 			//render 3d
-			renderUnitsFast();
-			renderObjectsFast();
+			if(shadows==sProjected){
+				
+				//static casters are rendered again only when the layer is stale
+				key.casters= computeStaticShadowSignature();
+				if(staticShadowValid && key==staticShadowKey){
+					renderShadowLayer(staticShadowMapHandle);
+				}
+				else{
+					renderObjectsFast();
+					renderUnitsFast(slStatic);
+					
+					glBindTexture(GL_TEXTURE_2D, staticShadowMapHandle);
+					glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, shadowTextureSize, shadowTextureSize);
+					
+					staticShadowKey= key;
+					staticShadowValid= true;
+				}
+				renderUnitsFast(slDynamic);
+			}
+			else{
+				renderUnitsFast(slAll);
+				renderObjectsFast();
+			}
 			
 			//read color buffer
 			glBindTexture(GL_TEXTURE_2D, shadowMapHandle);
@@ -2214,6 +1979,30 @@ void Renderer::loadConfig(){
 		textureManager[i]->setFilter(textureFilter);
 		textureManager[i]->setMaxAnisotropy(maxAnisotropy);
 	}
+
+	//animation pose cache
+	InterpolationData::setPoseSteps(config.getInt("AnimationPoseSteps"));
+	InterpolationData::setNormalize(config.getBool("AnimationNormalize"));
+
+	//particle budget and level of detail
+	int maxParticles= config.getInt("MaxParticles");
+	for(int i=0; i<rsCount; ++i){
+		particleManager[i]->setBudget(maxParticles);
+	}
+	particleLodDistance= config.getFloat("ParticleLodDistance");
+}
+
+void Renderer::configChanged(){
+	Shadows lastShadows= shadows;
+	int lastShadowTextureSize= shadowTextureSize;
+
+	loadConfig();
+
+	//shadow resources belong to the running game, keep them until it ends
+	if(game!=NULL){
+		shadows= lastShadows;
+		shadowTextureSize= lastShadowTextureSize;
+	}
 }
 
 void Renderer::saveScreen(const string &path){
@@ -2285,17 +2074,261 @@ Vec3f Renderer::computeLightColor(float time){
 	return color;
 }
 
-Vec4f Renderer::computeWaterColor(float waterLevel, float cellHeight){
-	const float waterFactor= 1.5f;
-	return Vec4f(1.f, 1.f, 1.f, clamp((waterLevel-cellHeight)*waterFactor, 0.f, 1.f));
+// ==================== frame capture ==================== 
+
+//uploads only the texels the simulation changed since the last frame
+void Renderer::updateFowTexture(){
+	const Minimap *minimap= game->getWorld()->getMinimap();
+	const Texture2D *fowTex= minimap->getFowTexture();
+
+	Rect2i fowRect= minimap->takeFowDirtyRect();
+	if(fowRect.p[0].x<fowRect.p[1].x && fowRect.p[0].y<fowRect.p[1].y){
+		const Pixmap2D *fowPixmap= fowTex->getPixmap();
+
+		glPushAttrib(GL_TEXTURE_BIT);
+		glBindTexture(GL_TEXTURE_2D, static_cast<const Texture2DGl*>(fowTex)->getHandle());
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, fowPixmap->getW());
+		glTexSubImage2D(
+			GL_TEXTURE_2D, 0, fowRect.p[0].x, fowRect.p[0].y, 
+			fowRect.p[1].x-fowRect.p[0].x, fowRect.p[1].y-fowRect.p[0].y, 
+			GL_ALPHA, GL_UNSIGNED_BYTE, fowPixmap->getPixels()+fowRect.p[0].y*fowPixmap->getW()+fowRect.p[0].x);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glPopAttrib();
+	}
+}
+
+static void addCircle(RenderFrame::Circles &circles, const Vec3f &pos, int size, float radius, const Vec4f &color){
+	RenderFrame::Circle circle;
+	circle.pos= pos;
+	circle.size= size;
+	circle.radius= radius;
+	circle.color= color;
+	circles.push_back(circle);
 }
 
-// ==================== fast render ==================== 
+static void addArrow(RenderFrame::Arrows &arrows, const Vec3f &pos1, const Vec3f &pos2, const Vec3f &color){
+	RenderFrame::Arrow arrow;
+	arrow.pos1= pos1;
+	arrow.pos2= pos2;
+	arrow.color= color;
+	arrows.push_back(arrow);
+}
 
-//render units for selection purposes
-void Renderer::renderUnitsFast(){
+//selection and magic circles, command arrows and highlights
+void Renderer::captureSelectionEffects(){
 	const World *world= game->getWorld();
-	
+	const Map *map= world->getMap();
+	const Selection *selection= game->getGui()->getSelection();	
+
+	frame.circles.clear();
+	frame.arrows.clear();
+
+	//units
+	for(int i=0; i<selection->getCount(); ++i){
+		const Unit *unit= selection->getUnit(i);
+		bool own= world->getThisFactionIndex()==unit->getFactionIndex();
+
+		Vec3f currVec= unit->getCurrVectorFlat();
+		currVec.y+= 0.3f;
+				
+		//selection circle
+		Vec4f color= own? Vec4f(0.f, unit->getHpRatio(), 0.f, 0.3f): Vec4f(unit->getHpRatio(), 0.f, 0.f, 0.3f);
+		addCircle(frame.circles, currVec, unit->getType()->getSize(), selectionCircleRadius, color);
+		
+		//magic circle
+		if(own && unit->getType()->getMaxEp()>0){
+			Vec4f magicColor(unit->getEpRatio()/2.f, unit->getEpRatio(), unit->getEpRatio(), 0.5f);
+			addCircle(frame.circles, currVec, unit->getType()->getSize(), magicCircleRadius, magicColor);
+		}
+	}
+
+	//target arrow
+	if(selection->getCount()==1){
+		const Unit *unit= selection->getUnit(0);	
+		
+		//comand arrow
+		if(focusArrows && unit->anyCommand()){ 
+			const CommandType *ct= unit->getCurrCommand()->getCommandType();
+			if(ct->getClicks()!=cOne){
+				
+				//arrow color
+				Vec3f arrowColor;
+				switch(ct->getClass()){
+				case ccMove:
+					arrowColor= Vec3f(0.f, 1.f, 0.f);
+					break;
+				case ccAttack:
+				case ccAttackStopped:
+					arrowColor= Vec3f(1.f, 0.f, 0.f);
+					break;
+				default:
+					arrowColor= Vec3f(1.f, 1.f, 0.f);
+				}
+
+				//arrow target
+				Vec3f arrowTarget;
+				Command *c= unit->getCurrCommand();
+				if(c->getUnit()!=NULL){
+					arrowTarget= c->getUnit()->getCurrVectorFlat();
+				}
+				else{
+					Vec2i pos= c->getPos(); 
+					arrowTarget= Vec3f(pos.x, map->getCell(pos)->getHeight(), pos.y);
+				}
+
+				addArrow(frame.arrows, unit->getCurrVectorFlat(), arrowTarget, arrowColor);
+			}
+		}
+
+		//meeting point arrow
+		if(unit->getType()->getMeetingPoint()){
+			Vec2i pos= unit->getMeetingPos(); 
+			Vec3f arrowTarget= Vec3f(pos.x, map->getCell(pos)->getHeight(), pos.y);
+			addArrow(frame.arrows, unit->getCurrVectorFlat(), arrowTarget, Vec3f(0.f, 0.f, 1.f));
+		}
+	}
+
+	//selection hightlights
+	for(int i=0; i<world->getFactionCount(); ++i){
+		for(int j=0; j<world->getFaction(i)->getUnitCount(); ++j){
+			const Unit *unit= world->getFaction(i)->getUnit(j);
+
+			if(unit->isHighlighted()){
+				float highlight= unit->getHightlight();
+				Vec4f color= world->getThisFactionIndex()==unit->getFactionIndex()? Vec4f(0.f, 1.f, 0.f, highlight): Vec4f(1.f, 0.f, 0.f, highlight);
+
+				Vec3f v= unit->getCurrVectorFlat();
+				v.y+= 0.3f;
+				addCircle(frame.circles, v, unit->getType()->getSize(), selectionCircleRadius, color);
+			}
+		}
+	}
+}
+
+//enabled splashes visible for this team
+void Renderer::captureWaterEffects(){
+	const World *world= game->getWorld();
+	const WaterEffects *we= world->getWaterEffects();
+	const Map *map= world->getMap();
+
+	frame.waterSplashes.clear();
+	for(int i=0; i<we->getWaterSplashCount(); ++i){
+		const WaterSplash *ws= we->getWaterSplash(i);
+		if(ws->getEnabled()){
+			Vec2i intPos= Vec2i(static_cast<int>(ws->getPos().x), static_cast<int>(ws->getPos().y));
+			if(map->getSurfaceCell(Map::toSurfCoords(intPos))->isVisible(world->getThisTeamIndex())){
+				frame.waterSplashes.push_back(*ws);
+			}
+		}
+	}
+}
+
+//the 3d cursor, or the building being placed and whether its cells are free
+void Renderer::captureMouse3d(){
+	const Gui *gui= game->getGui();
+	const Mouse3d *mouse3d= gui->getMouse3d();
+	const Map *map= game->getWorld()->getMap();
+
+	frame.mouse3dVisible= (mouse3d->isEnabled() || gui->isPlacingBuilding()) && gui->isValidPosObjWorld();
+	frame.buildingModel= NULL;
+
+	if(frame.mouse3dVisible){
+		Vec2i pos= gui->getPosObjWorld();
+		frame.mouse3dPos= Vec3f(pos.x, map->getCell(pos)->getHeight(), pos.y);
+		frame.mouse3dFade= mouse3d->getFade();
+		frame.mouse3dRot= mouse3d->getRot();
+
+		if(gui->isPlacingBuilding()){
+			const UnitType *building= gui->getBuilding();
+			frame.buildingModel= building->getFirstStOfClass(scStop)->getAnimation();
+			frame.buildingSize= building->getSize();
+			frame.buildingPlaceable= map->isFreeCells(pos, building->getSize(), fLand);
+		}
+	}
+}
+
+void Renderer::captureMinimap(){
+	const World *world= game->getWorld();
+
+	frame.minimapUnits.clear();
+	for(int i=0; i<world->getFactionCount(); ++i){
+		Vec3f color= world->getFaction(i)->getTexture()->getPixmap()->getPixel3f(0, 0);
+		for(int j=0; j<world->getFaction(i)->getUnitCount(); ++j){
+			Unit *unit= world->getFaction(i)->getUnit(j);
+			if(world->toRenderUnit(unit)){
+				RenderFrame::MinimapUnit minimapUnit;
+				minimapUnit.pos= unit->getPos()/Map::cellScale;
+				minimapUnit.size= unit->getType()->getSize(); 
+				minimapUnit.color= color;
+				frame.minimapUnits.push_back(minimapUnit);
+			}
+		}
+	}
+}
+
+//resources of this faction that any of its units costs
+void Renderer::captureResourceStatus(){
+	const World *world= game->getWorld();
+	const Faction *thisFaction= world->getFaction(world->getThisFactionIndex());
+
+	frame.resourceStatuses.clear();
+	for(int i= 0; i<world->getTechTree()->getResourceTypeCount(); ++i){
+		const ResourceType *rt= world->getTechTree()->getResourceType(i);
+		const Resource *r= thisFaction->getResource(rt);
+		
+		//if any unit produces the resource
+		bool showResource= false;
+		for(int k=0; k<thisFaction->getType()->getUnitTypeCount(); ++k){
+			const UnitType *ut= thisFaction->getType()->getUnitType(k); 
+			if(ut->getCost(rt)!=NULL){
+				showResource= true;
+				break;
+			}
+		}
+
+		if(showResource){
+			string str= intToStr(r->getAmount());
+			if(rt->getClass()!=rcStatic){
+				str+= "/" + intToStr(thisFaction->getStoreAmount(rt));
+			}	
+			if(rt->getClass()==rcConsumable){
+				str+= "(";
+				if(r->getBalance()>0){
+					str+= "+";
+				}
+				str+= intToStr(r->getBalance()) + ")";
+			}
+
+			RenderFrame::ResourceStatus resourceStatus;
+			resourceStatus.image= rt->getImage();
+			resourceStatus.text= str;
+			frame.resourceStatuses.push_back(resourceStatus);
+		}
+	}
+}
+
+//the casters of the shadow map, when this frame renders it
+void Renderer::captureShadows(){
+	if(shadows==sProjected || shadows==sShadowMapping){
+		shadowMapFrame= (shadowMapFrame + 1) % (shadowFrameSkip + 1);
+
+		if(shadowMapFrame==0){
+			ShadowLayerKey key;
+			loadShadowMatrices(key);
+			computeShadowRenderList();
+
+			glPopMatrix();
+			glMatrixMode(GL_PROJECTION);
+			glPopMatrix();
+			glMatrixMode(GL_MODELVIEW);
+		}
+	}
+}
+
+// ==================== fast render ==================== 
+
+//render units for shadow purposes
+void Renderer::renderUnitsFast(ShadowLayer layer){
 	assertGl();
 
 	glPushAttrib(GL_ENABLE_BIT);
@@ -2303,47 +2336,38 @@ void Renderer::renderUnitsFast(){
 	glDisable(GL_LIGHTING);
 
 	modelRenderer->begin(false, false, false);
-	glInitNames();
-	for(int i=0; i<world->getFactionCount(); ++i){
-		glPushName(i);
-		for(int j=0; j<world->getFaction(i)->getUnitCount(); ++j){
-			glPushName(j);
-			Unit *unit= world->getFaction(i)->getUnit(j);
-			if(world->toRenderUnit(unit, visibleQuad)) {
-				glMatrixMode(GL_MODELVIEW);
+	for(int i=0; i<shadowRenderList.getUnitCount(); ++i){
+		const UnitSnapshot *us= &shadowRenderList.getUnit(i)->unit;
 
-				//debuxar modelo
-				glPushMatrix();
+		if(layer!=slAll && us->staticShadow!=(layer==slStatic)){
+			continue;
+		}
 
-				//translate
-				Vec3f currVec= unit->getCurrVectorFlat();
-				glTranslatef(currVec.x, currVec.y, currVec.z);
-				
-				//rotate
-				glRotatef(unit->getRotation(), 0.f, 1.f, 0.f);
+		glMatrixMode(GL_MODELVIEW);
 
-				//render
-				const Model *model= unit->getCurrentModel();
-				model->updateInterpolationVertices(unit->getAnimProgress(), unit->isAlive());
-				modelRenderer->render(model);
+		//debuxar modelo
+		glPushMatrix();
 
-				glPopMatrix();
+		//translate
+		glTranslatef(us->vector.x, us->vector.y, us->vector.z);
+		
+		//rotate
+		glRotatef(us->rotation, 0.f, 1.f, 0.f);
 
-			}
-			glPopName();
-		}
-		glPopName();
+		//render
+		const Model *model= us->model;
+		model->updateInterpolationVertices(us->animProgress, us->alive);
+		modelRenderer->render(model);
+
+		glPopMatrix();
 	}
 	modelRenderer->end();
 
 	glPopAttrib();
 }
 
-//render objects for selection purposes
+//render objects for shadow purposes
 void Renderer::renderObjectsFast(){
-	const World *world= game->getWorld();
-	const Map *map= world->getMap();	
-
     assertGl();
 
 	glPushAttrib(GL_ENABLE_BIT| GL_TEXTURE_BIT);
@@ -2364,41 +2388,168 @@ void Renderer::renderObjectsFast(){
 	glTexEnvi(GL_TEXTURE_ENV, GL_OPERAND0_ALPHA, GL_SRC_ALPHA);
 
 	modelRenderer->begin(false, true, false);
-	int thisTeamIndex= world->getThisTeamIndex();
 
-	PosQuadIterator pqi(map, visibleQuad, Map::cellScale);
-	while(pqi.next()){
-		const Vec2i pos= pqi.getPos();
+	for(int i=0; i<shadowRenderList.getObjectCount(); ++i){
+		const RenderList::ObjectEntry *entry= shadowRenderList.getObject(i);
+		const Model *objModel= entry->model;
+		const Vec3f &v= entry->vector;
 
-		if(map->isInside(pos)){
+		glMatrixMode(GL_MODELVIEW);
+		glPushMatrix();
+		glTranslatef(v.x, v.y, v.z);
+		glRotatef(entry->rotation, 0.f, 1.f, 0.f);
 
-			SurfaceCell *sc= map->getSurfaceCell(Map::toSurfCoords(pos));
-			Object *o= sc->getObject();
-			if(sc->isExplored(thisTeamIndex) && o!=NULL){
+		modelRenderer->render(objModel);
+		
+		glPopMatrix();
+	}
 
-				const Model *objModel= sc->getObject()->getModel();
-				Vec3f v= o->getPos();
+	modelRenderer->end();
 
-				glMatrixMode(GL_MODELVIEW);
-				glPushMatrix();
-				glTranslatef(v.x, v.y, v.z);
-				glRotatef(o->getRotation(), 0.f, 1.f, 0.f);
+	glPopAttrib();
 
-				modelRenderer->render(objModel);
-				
-				glPopMatrix();
+	assertGl();
+}
 
-			}
-		}
-	}
+//copies a cached shadow layer to the whole shadow area of the color buffer
+void Renderer::renderShadowLayer(GLuint handle){
+	assertGl();
 
-	modelRenderer->end();
+	glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_VIEWPORT_BIT);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_ALPHA_TEST);
+	glDisable(GL_BLEND);
+	glEnable(GL_TEXTURE_2D);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_REPLACE);
+	glBindTexture(GL_TEXTURE_2D, handle);
+	glViewport(0, 0, shadowTextureSize, shadowTextureSize);
+
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	glBegin(GL_TRIANGLE_STRIP);
+		glTexCoord2f(0.f, 0.f);
+		glVertex2f(-1.f, -1.f);
+		glTexCoord2f(1.f, 0.f);
+		glVertex2f(1.f, -1.f);
+		glTexCoord2f(0.f, 1.f);
+		glVertex2f(-1.f, 1.f);
+		glTexCoord2f(1.f, 1.f);
+		glVertex2f(1.f, 1.f);
+	glEnd();
+
+	glPopMatrix();
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
 
 	glPopAttrib();
 
 	assertGl();
 }
 
+//pushes the projection and modelview matrices and loads the ones of the nearest light
+void Renderer::loadShadowMatrices(ShadowLayerKey &key){
+	if(nearestLightPos.w==0.f){
+		//directional light
+
+		//light pos
+		float ang= frame.day? computeSunAngle(frame.time): computeMoonAngle(frame.time);
+		ang= radToDeg(ang);	
+
+		//the static layer is cached, step the angle so it stays valid for a while
+		if(shadows==sProjected){
+			ang= floorf(ang/shadowAngleStep)*shadowAngleStep;
+		}
+
+		//push and set projection
+		glMatrixMode(GL_PROJECTION);
+		glPushMatrix();
+		glLoadIdentity();
+		if(frame.cameraState==GameCamera::sGame){
+			glOrtho(-35, 5, -15, 15, -1000, 1000);
+		}
+		else{
+			glOrtho(-30, 30, -20, 20, -1000, 1000);
+		}
+
+		//push and set modelview
+		glMatrixMode(GL_MODELVIEW);
+		glPushMatrix();
+		glLoadIdentity();
+		
+		glRotatef(15, 0, 1, 0);
+		
+		glRotatef(ang, 1, 0, 0);
+		glRotatef(90, 0, 1, 0);
+		const Vec3f &pos= frame.cameraPos;
+
+		glTranslatef(static_cast<int>(-pos.x), 0, static_cast<int>(-pos.z));
+
+		key.light= Vec4f(ang, static_cast<float>(frame.cameraState), 0.f, 0.f);
+		key.camera= Vec2i(static_cast<int>(-pos.x), static_cast<int>(-pos.z));
+	}
+	else{
+		//non directional light
+		
+		//push projection
+		glMatrixMode(GL_PROJECTION);
+		glPushMatrix();
+		glLoadIdentity();
+		gluPerspective(150, 1.f, perspNearPlane, perspFarPlane);
+
+		//push modelview
+		glMatrixMode(GL_MODELVIEW);
+		glPushMatrix();
+		glLoadIdentity();
+		glRotatef(-90, -1, 0, 0);
+		glTranslatef(-nearestLightPos.x, -nearestLightPos.y-2, -nearestLightPos.z);
+
+		key.light= nearestLightPos;
+		key.camera= Vec2i(0);
+	}
+}
+
+//casters in the light volume, with the current light matrices, the margin keeps the long 
+//shadows of casters just outside the view
+void Renderer::computeShadowRenderList(){
+	Matrix4f projection;
+	Matrix4f modelview;
+	glGetFloatv(GL_PROJECTION_MATRIX, projection.ptr());
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelview.ptr());
+	shadowFrustum.init(projection, modelview);
+
+	Rect2i casterRect= visibleQuad.computeBoundingRect();
+	casterRect.p[0]= casterRect.p[0] - Vec2i(shadowCasterMargin);
+	casterRect.p[1]= casterRect.p[1] + Vec2i(shadowCasterMargin);
+	shadowRenderList.build(game->getWorld(), shadowFrustum, Quad2i(casterRect));
+}
+
+//objects and standing buildings of the shadow render list, any change invalidates the static layer
+size_t Renderer::computeStaticShadowSignature() const{
+	size_t signature= shadowRenderList.getObjectCount();
+	for(int i=0; i<shadowRenderList.getObjectCount(); ++i){
+		const RenderList::ObjectEntry *entry= shadowRenderList.getObject(i);
+		signature= signature*31 + reinterpret_cast<size_t>(entry->model);
+		signature= signature*31 + entry->pos.x;
+		signature= signature*31 + entry->pos.y;
+	}
+	for(int i=0; i<shadowRenderList.getUnitCount(); ++i){
+		const UnitSnapshot *us= &shadowRenderList.getUnit(i)->unit;
+		if(us->staticShadow){
+			signature= signature*31 + us->factionIndex;
+			signature= signature*31 + us->id;
+			signature= signature*31 + reinterpret_cast<size_t>(us->model);
+		}
+	}
+	return signature;
+}
+
 // ==================== gl caps ==================== 
 
 void Renderer::checkGlCaps(){
@@ -2652,6 +2803,14 @@ void Renderer::loadProjectionMatrix(){
     assertGl();
 }
 
+//the picker uses the same view as loadGameCameraMatrix and loadProjectionMatrix
+void Renderer::loadPickerCamera(){
+	const Metrics &metrics= Metrics::getInstance();
+	float clipping= photoMode ? perspFarPlane*100 : perspFarPlane;
+
+	picker.setCamera(game->getGameCamera(), perspFov, metrics.getAspectRatio(), perspNearPlane, clipping);
+}
+
 void Renderer::enableProjectiveTexturing(){
 	glTexGenfv(GL_S, GL_EYE_PLANE, &shadowMapMatrix[0]);
 	glTexGenfv(GL_T, GL_EYE_PLANE, &shadowMapMatrix[4]);
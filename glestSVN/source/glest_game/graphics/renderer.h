@@ -20,12 +20,17 @@
 #include "font.h"
 #include "matrix.h"
 #include "selection.h"
+#include "picker.h"
+#include "render_list.h"
+#include "render_frame.h"
+#include "water_geometry.h"
 #include "components.h"
 #include "texture.h"
 #include "model_manager.h"
 #include "graphics_factory_gl.h"
 #include "font_manager.h"
 #include "camera.h"
+#include "config.h"
 
 namespace Glest{ namespace Game{
 
@@ -64,13 +69,35 @@ enum ResourceScope{
 	rsCount
 };
 
+// ===========================================================
+// 	class ShadowLayerKey
+//
+///	Light, view and casters a cached shadow layer was 
+/// rendered with
+// ===========================================================
+
+class ShadowLayerKey{
+public:
+	Vec4f light;	//light position, or light angle and camera state for the sun and moon
+	Vec2i camera;	//camera cell, only for the sun and moon
+	size_t casters;	//signature of the static casters
+
+public:
+	bool operator==(const ShadowLayerKey &key) const{
+		return 
+			light.x==key.light.x && light.y==key.light.y && light.z==key.light.z && light.w==key.light.w &&
+			camera.x==key.camera.x && camera.y==key.camera.y && 
+			casters==key.casters;
+	}
+};
+
 // ===========================================================
 // 	class Renderer
 //
 ///	OpenGL renderer, uses the shared library
 // ===========================================================
 
-class Renderer{
+class Renderer: public ConfigObserver{
 public:
 	//progress bar
 	static const int maxProgressBar;
@@ -112,6 +139,10 @@ public:
 	//light
 	static const float maxLightDist;
 
+	//shadows
+	static const float shadowAngleStep;
+	static const int shadowCasterMargin;
+
 public:
 	enum Shadows{
 		sDisabled,
@@ -121,6 +152,14 @@ public:
 		sCount
 	};
 
+private:
+	//static casters go to a cached layer with projected shadows
+	enum ShadowLayer{
+		slAll,
+		slStatic,
+		slDynamic
+	};
+
 private:   
 	//config
 	int maxLights;
@@ -130,6 +169,7 @@ private:
 	float shadowAlpha;
 	bool focusArrows;
 	bool textures3D;
+	float particleLodDistance;
 	Shadows shadows;
 
 	//game
@@ -140,6 +180,12 @@ private:
 	int pointCount;
 	Quad2i visibleQuad;
 	Vec4f nearestLightPos;
+	Picker picker;
+	ViewFrustum viewFrustum;
+	RenderList renderList;
+	ViewFrustum shadowFrustum;
+	RenderList shadowRenderList;	//casters in the light volume
+	RenderFrame frame;				//world and gui state drawn by this frame
 
 	//renderers
 	ModelRenderer *modelRenderer;
@@ -161,9 +207,13 @@ private:
 	GLuint shadowMapHandle;
 	Matrix4f shadowMapMatrix;
 	int shadowMapFrame;
+	GLuint staticShadowMapHandle;
+	bool staticShadowValid;
+	ShadowLayerKey staticShadowKey;
 
 	//water
 	float waterAnim;
+	WaterGeometry waterGeometry;
 
 private:
 	Renderer();
@@ -199,6 +249,8 @@ public:
 	Font2D *newFont(ResourceScope rs);
 	TextRenderer2D *getTextRenderer() const	{return textRenderer;}
 	void manageParticleSystem(ParticleSystem *particleSystem, ResourceScope rs);
+	void fadeParticleSystem(ParticleSystem *particleSystem, ResourceScope rs);
+	void setParticleSystemActive(ParticleSystem *particleSystem, bool active, ResourceScope rs);
 	void updateParticleManager(ResourceScope rs);
 	void renderParticleManager(ResourceScope rs);
 	void swapBuffers();
@@ -208,6 +260,8 @@ public:
 	void loadGameCameraMatrix();
 	void loadCameraMatrix(const Camera *camera);
 	void computeVisibleQuad();
+	void computeRenderLists();
+	void captureFrame();
 	
     //basic rendering
 	void renderMouse2d(int mouseX, int mouseY, int anim, float fade= 0.f);
@@ -257,8 +311,10 @@ public:
 
 	//misc
 	void loadConfig();
+	virtual void configChanged();
 	void saveScreen(const string &path);
 	Quad2i getVisibleQuad() const		{return visibleQuad;}
+	const RenderFrame *getFrame() const	{return &frame;}
 
 	//static
 	static Shadows strToShadows(const string &s);
@@ -271,12 +327,24 @@ private:
 	Vec4f computeSunPos(float time);
 	Vec4f computeMoonPos(float time);
 	Vec3f computeLightColor(float time);
-	Vec4f computeWaterColor(float waterLevel, float cellHeight);
 	void checkExtension(const string &extension, const string &msg);
 	
-	//selection render
+	//frame capture
+	void updateFowTexture();
+	void captureSelectionEffects();
+	void captureWaterEffects();
+	void captureMouse3d();
+	void captureMinimap();
+	void captureResourceStatus();
+	void captureShadows();
+
+	//shadow render
+	void loadShadowMatrices(ShadowLayerKey &key);
 	void renderObjectsFast();
-	void renderUnitsFast();
+	void renderUnitsFast(ShadowLayer layer);
+	void renderShadowLayer(GLuint handle);
+	void computeShadowRenderList();
+	size_t computeStaticShadowSignature() const;
 	
 	//gl requirements
 	void checkGlCaps();
@@ -289,6 +357,7 @@ private:
 
 	//misc
 	void loadProjectionMatrix();
+	void loadPickerCamera();
 	void enableProjectiveTexturing();
 
 	//private aux drawing
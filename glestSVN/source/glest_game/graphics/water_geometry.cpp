@@ -0,0 +1,155 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#include "water_geometry.h"
+
+#include <cstddef>
+
+#include "map.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Graphics;
+using namespace Shared::Util;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class WaterGeometry
+// =====================================================
+
+WaterGeometry::WaterGeometry(){
+	vertexBuffer= 0;
+}
+
+WaterGeometry::~WaterGeometry(){
+	end();
+}
+
+//height and water level never change during a game, so neither do the vertices
+void WaterGeometry::init(const Map *map, bool vertexBuffers){
+	end();
+
+	int surfaceW= map->getSurfaceW();
+	int surfaceH= map->getSurfaceH();
+
+	for(int cy=0; cy<surfaceH-1; cy+= chunkSize){
+		for(int cx=0; cx<surfaceW-1; cx+= chunkSize){
+			Chunk chunk;
+			chunk.area= Rect2i(cx, cy, cx+chunkSize, cy+chunkSize);
+			chunk.firstVertex= vertices.size();
+
+			for(int j=cy; j<cy+chunkSize && j<surfaceH-1; ++j){
+				for(int i=cx; i<cx+chunkSize && i<surfaceW-1; ++i){
+					if(map->getSurfaceCell(i, j)->getNearSubmerged()){
+						addVertex(map, i, j+1, 1.f);
+						addVertex(map, i, j, 0.f);
+						addVertex(map, i+1, j, 0.f);
+						addVertex(map, i+1, j+1, 1.f);
+					}
+				}
+			}
+
+			chunk.vertexCount= vertices.size()-chunk.firstVertex;
+			if(chunk.vertexCount>0){
+				chunks.push_back(chunk);
+			}
+		}
+	}
+
+	if(vertexBuffers && !vertices.empty()){
+		glGenBuffers(1, &vertexBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		glBufferData(GL_ARRAY_BUFFER, vertices.size()*sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+}
+
+void WaterGeometry::end(){
+	if(vertexBuffer!=0){
+		glDeleteBuffers(1, &vertexBuffer);
+		vertexBuffer= 0;
+	}
+	vertices.clear();
+	chunks.clear();
+}
+
+//draws the chunks touching the rect, returns the triangle count
+int WaterGeometry::render(const Rect2i &scaledRect, bool colors) const{
+	if(chunks.empty()){
+		return 0;
+	}
+
+	//pointers are offsets when a vertex buffer is bound
+	const char *base= NULL;
+	if(vertexBuffer!=0){
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	}
+	else{
+		base= reinterpret_cast<const char*>(&vertices[0]);
+	}
+
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, pos));
+
+	glClientActiveTexture(GL_TEXTURE1);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, fowTexCoord));
+
+	glClientActiveTexture(GL_TEXTURE0);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glTexCoordPointer(3, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, texCoord));
+
+	if(colors){
+		glEnableClientState(GL_COLOR_ARRAY);
+		glColorPointer(4, GL_FLOAT, sizeof(Vertex), base + offsetof(Vertex, color));
+	}
+
+	int triangleCount= 0;
+	for(int i=0; i<chunks.size(); ++i){
+		const Rect2i &area= chunks[i].area;
+		if(area.p[0].x<=scaledRect.p[1].x && area.p[1].x>scaledRect.p[0].x && area.p[0].y<=scaledRect.p[1].y && area.p[1].y>scaledRect.p[0].y){
+			glDrawArrays(GL_QUADS, chunks[i].firstVertex, chunks[i].vertexCount);
+			triangleCount+= chunks[i].vertexCount/2;
+		}
+	}
+
+	glPopClientAttrib();
+
+	if(vertexBuffer!=0){
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+
+	return triangleCount;
+}
+
+Vec4f WaterGeometry::computeWaterColor(float waterLevel, float cellHeight){
+	const float waterFactor= 1.5f;
+	return Vec4f(1.f, 1.f, 1.f, clamp((waterLevel-cellHeight)*waterFactor, 0.f, 1.f));
+}
+
+// ==================== PRIVATE ==================== 
+
+void WaterGeometry::addVertex(const Map *map, int sx, int sy, float texCoordY){
+	float waterLevel= map->getWaterLevel();
+
+	Vertex vertex;
+	vertex.pos= Vec3f(static_cast<float>(sx)*Map::mapScale, waterLevel, static_cast<float>(sy)*Map::mapScale);
+	vertex.texCoord= Vec3f(static_cast<float>(sx), texCoordY, 0.f);
+	vertex.fowTexCoord= map->getSurfaceCellRender(sx, sy)->getFowTexCoord();
+	vertex.color= computeWaterColor(waterLevel, map->getSurfaceCell(sx, sy)->getHeight());
+	vertices.push_back(vertex);
+}
+
+}}//end namespace
@@ -0,0 +1,82 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#ifndef _GLEST_GAME_WATERGEOMETRY_H_
+#define _GLEST_GAME_WATERGEOMETRY_H_
+
+#include <vector>
+
+#include "vec.h"
+#include "math_util.h"
+#include "opengl.h"
+
+using std::vector;
+
+namespace Glest{ namespace Game{
+
+using Shared::Graphics::Vec2f;
+using Shared::Graphics::Vec3f;
+using Shared::Graphics::Vec4f;
+using Shared::Graphics::Rect2i;
+
+class Map;
+
+// =====================================================
+// 	class WaterGeometry
+//
+///	Water surface of the near submerged cells, built once per
+///	game with the water color baked in, and drawn by chunks
+// =====================================================
+
+class WaterGeometry{
+public:
+	static const int chunkSize= 16;	//in surface cells
+
+private:
+	struct Vertex{
+		Vec3f pos;
+		Vec3f texCoord;		//the water animation moves r with the texture matrix
+		Vec2f fowTexCoord;
+		Vec4f color;
+	};
+	typedef vector<Vertex> Vertices;
+
+	struct Chunk{
+		Rect2i area;		//surface cells, p[1] excluded
+		int firstVertex;
+		int vertexCount;
+	};
+	typedef vector<Chunk> Chunks;
+
+private:
+	Vertices vertices;
+	Chunks chunks;
+	GLuint vertexBuffer;	//0 when vertex buffers are not supported, vertices are then drawn from memory
+
+public:
+	WaterGeometry();
+	~WaterGeometry();
+
+	void init(const Map *map, bool vertexBuffers);
+	void end();
+
+	int render(const Rect2i &scaledRect, bool colors) const;
+
+	static Vec4f computeWaterColor(float waterLevel, float cellHeight);
+
+private:
+	void addVertex(const Map *map, int sx, int sy, float texCoordY);
+};
+
+}}//end namespace
+
+#endif
@@ -799,7 +799,7 @@ void Gui::computeSelected(bool doubleClick){
 		int factionIndex= refUnit->getFactionIndex();
 		for(int i=0; i<world->getFaction(factionIndex)->getUnitCount(); ++i){
 			Unit *unit= world->getFaction(factionIndex)->getUnit(i);
-			if(unit->getPos().dist(refUnit->getPos())<doubleClickSelectionRadius &&
+			if(unit->getPos().sqDist(refUnit->getPos())<doubleClickSelectionRadius*doubleClickSelectionRadius &&
 				unit->getType()==refUnit->getType())
 			{
 				units.push_back(unit);
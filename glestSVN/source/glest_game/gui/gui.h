@@ -91,7 +91,6 @@ public:
 
 class Gui{
 public:
-	static const int maxSelBuff= 128*5;
 	static const int upgradeDisplayIndex= 8;
 	static const int cancelPos= 15;
 	static const int meetingPointPos= 14;
@@ -0,0 +1,125 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#include "frame_scheduler.h"
+
+#include "leak_dumper.h"
+
+using namespace Shared::Platform;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class FrameScheduler
+// =====================================================
+
+FrameScheduler::FrameScheduler(){
+	inited= false;
+	maxFps= 0;
+	idleFps= 0;
+	idle= false;
+	nextFrameMicros= 0;
+
+	statsStartMicros= 0;
+	lastFrameMicros= 0;
+	sleepMicros= 0;
+	maxFrameMicros= 0;
+	frameCount= 0;
+	lastFps= 0;
+	lastMaxFrameMillis= 0;
+	lastSleepPercent= 0;
+}
+
+FrameScheduler::~FrameScheduler(){
+	if(inited){
+		endPreciseSleep();
+	}
+}
+
+void FrameScheduler::init(int maxFps, int idleFps){
+	this->maxFps= maxFps;
+	this->idleFps= idleFps;
+
+	if(!inited){
+		beginPreciseSleep();
+		inited= true;
+	}
+	chrono.start();
+}
+
+bool FrameScheduler::isRenderTime(){
+	int64 micros= chrono.getMicros();
+	int fps= getTargetFps();
+
+	if(fps>0){
+		if(micros<nextFrameMicros){
+			return false;
+		}
+
+		//late frames are not caught up, the next one is just due sooner
+		nextFrameMicros+= 1000000/fps;
+		if(nextFrameMicros<micros){
+			nextFrameMicros= micros;
+		}
+	}
+
+	//frame stats
+	int64 frameMicros= micros-lastFrameMicros;
+	if(frameMicros>maxFrameMicros){
+		maxFrameMicros= frameMicros;
+	}
+	lastFrameMicros= micros;
+	frameCount++;
+	updateStats(micros);
+
+	return true;
+}
+
+//uncapped rendering keeps the loop busy, as it always was
+void FrameScheduler::wait(const PerformanceTimer *const *timers, int timerCount){
+	int fps= getTargetFps();
+	if(fps<=0){
+		return;
+	}
+
+	int64 micros= chrono.getMicros();
+	int64 waitMicros= nextFrameMicros>micros? nextFrameMicros-micros: 0;
+	for(int i=0; i<timerCount; ++i){
+		int64 timerMicros= timers[i]->getMicrosToNext();
+		if(timerMicros<waitMicros){
+			waitMicros= timerMicros;
+		}
+	}
+
+	if(waitMicros>=1000){
+		sleep(static_cast<int>(waitMicros/1000));
+		sleepMicros+= chrono.getMicros()-micros;
+	}
+}
+
+// ==================== PRIVATE ==================== 
+
+void FrameScheduler::updateStats(int64 micros){
+	int64 elapsedMicros= micros-statsStartMicros;
+	if(elapsedMicros>=1000000){
+		lastFps= frameCount;
+		lastMaxFrameMillis= static_cast<int>(maxFrameMicros/1000);
+		lastSleepPercent= static_cast<int>(sleepMicros*100/elapsedMicros);
+
+		statsStartMicros= micros;
+		sleepMicros= 0;
+		maxFrameMicros= 0;
+		frameCount= 0;
+	}
+}
+
+}}//end namespace
@@ -0,0 +1,72 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#ifndef _GLEST_GAME_FRAMESCHEDULER_H_
+#define _GLEST_GAME_FRAMESCHEDULER_H_
+
+#include "platform_util.h"
+
+using Shared::Platform::PerformanceTimer;
+using Shared::Platform::Chrono;
+using Shared::Platform::int64;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class FrameScheduler
+//
+///	Paces the main loop, caps the render rate and sleeps 
+/// until the next frame or timer is due instead of polling
+// =====================================================
+
+class FrameScheduler{
+private:
+	Chrono chrono;		//time base, running since init
+	bool inited;
+	int maxFps;			//0 means uncapped
+	int idleFps;		//used while the window is in the background
+	bool idle;
+	int64 nextFrameMicros;
+
+	//stats, the last ones are of the previous second
+	int64 statsStartMicros;
+	int64 lastFrameMicros;
+	int64 sleepMicros;
+	int64 maxFrameMicros;
+	int frameCount;
+	int lastFps;
+	int lastMaxFrameMillis;
+	int lastSleepPercent;
+
+public:
+	FrameScheduler();
+	~FrameScheduler();
+
+	void init(int maxFps, int idleFps);
+	void setIdle(bool idle)		{this->idle= idle;}
+
+	bool isRenderTime();
+	void wait(const PerformanceTimer *const *timers, int timerCount);
+
+	//get
+	int getFps() const				{return lastFps;}
+	int getMaxFrameMillis() const	{return lastMaxFrameMillis;}
+	int getSleepPercent() const		{return lastSleepPercent;}
+
+private:
+	int getTargetFps() const		{return idle? idleFps: maxFps;}
+	void updateStats(int64 micros);
+};
+
+}}//end namespace
+
+#endif
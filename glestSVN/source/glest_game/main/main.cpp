@@ -22,6 +22,7 @@
 #include "game_util.h"
 #include "platform_util.h"
 #include "platform_main.h"
+#include "log_writer.h"
 #include "leak_dumper.h"
 
 using namespace std;
@@ -37,6 +38,7 @@ namespace Glest{ namespace Game{
 class ExceptionHandler: public PlatformExceptionHandler{
 public:
 	virtual void handle(){
+		LogWriter::getInstance().flush();
 		message("An error ocurred and Glest will close.\nPlease report this bug to "+mailString+", attaching the generated "+getCrashDumpFileName()+" file.");
 	}
 };
@@ -98,6 +100,9 @@ void MainWindow::eventActivate(bool active){
 	if(!active){
 		//minimize();
 	}
+
+	//background windows render at the idle rate
+	program->setIdle(!active);
 }
 
 void MainWindow::eventResize(SizeState sizeState){
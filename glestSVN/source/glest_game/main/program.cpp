@@ -71,7 +71,10 @@ void Program::initClient(WindowGl *window, const Ip &serverIp){
 }
 
 Program::~Program(){
+	//states are always deleted holding the state mutex, the game stops its simulation thread with it
+	stateMutex.p();
 	delete programState;
+	stateMutex.v();
 	
 	Renderer::getInstance().end();
 	
@@ -81,46 +84,66 @@ Program::~Program(){
 
 void Program::mouseDownLeft(int x, int y){    
 	const Metrics &metrics= Metrics::getInstance();
+	stateMutex.p();
 	programState->mouseDownLeft(metrics.toVirtualX(x), metrics.toVirtualY(y));
+	stateMutex.v();
 }
 
 void Program::mouseUpLeft(int x, int y){
 	const Metrics &metrics= Metrics::getInstance();
+	stateMutex.p();
 	programState->mouseUpLeft(metrics.toVirtualX(x), metrics.toVirtualY(y));
+	stateMutex.v();
 }
 
 void Program::mouseDownRight(int x, int y){
 	const Metrics &metrics= Metrics::getInstance();
-	programState->mouseDownRight(metrics.toVirtualX(x), metrics.toVirtualY(y)); 
+	stateMutex.p();
+	programState->mouseDownRight(metrics.toVirtualX(x), metrics.toVirtualY(y));
+	stateMutex.v();
 }
 
 void Program::mouseDoubleClickLeft(int x, int y){
 	const Metrics &metrics= Metrics::getInstance();
-	programState->mouseDoubleClickLeft(metrics.toVirtualX(x), metrics.toVirtualY(y));   
+	stateMutex.p();
+	programState->mouseDoubleClickLeft(metrics.toVirtualX(x), metrics.toVirtualY(y));
+	stateMutex.v();
 }
 
 void Program::mouseMove(int x, int y, const MouseState *ms){
 	const Metrics &metrics= Metrics::getInstance();
+	stateMutex.p();
 	programState->mouseMove(metrics.toVirtualX(x), metrics.toVirtualY(y), ms);
+	stateMutex.v();
 }
 
 void Program::keyDown(char key){
 	//delegate event
+	stateMutex.p();
 	programState->keyDown(key);
+	stateMutex.v();
 }
 
 void Program::keyUp(char key){        
+	stateMutex.p();
 	programState->keyUp(key);
+	stateMutex.v();
 }
 
 void Program::keyPress(char c){
+	stateMutex.p();
 	programState->keyPress(c);
+	stateMutex.v();
 }
 
 void Program::loop(){
 
-	//render
-	programState->render();
+	stateMutex.p();
+
+	//render, unless the frame cap says otherwise
+	if(frameScheduler.isRenderTime()){
+		programState->render();
+	}
 
 	//update camera
 	while(updateCameraTimer.isTime()){
@@ -139,6 +162,12 @@ void Program::loop(){
 	while(fpsTimer.isTime()){
 		programState->tick();
 	}
+
+	stateMutex.v();
+
+	//sleep until the next frame or timer is due
+	const PerformanceTimer *timers[]= {&updateCameraTimer, &updateTimer, &fpsTimer};
+	frameScheduler.wait(timers, 3);
 }
 
 void Program::resize(SizeState sizeState){
@@ -195,6 +224,7 @@ void Program::init(WindowGl *window){
 	fpsTimer.init(1, maxTimes);
 	updateTimer.init(GameConstants::updateFps, maxTimes);
 	updateCameraTimer.init(GameConstants::cameraFps, maxTimes);
+	frameScheduler.init(config.getInt("MaxRenderFps"), config.getInt("IdleRenderFps"));
 
     //log start
 	Logger &logger= Logger::getInstance();
@@ -16,6 +16,8 @@
 #include "platform_util.h"
 #include "window_gl.h"
 #include "socket.h"
+#include "thread.h"
+#include "frame_scheduler.h"
 
 using Shared::Graphics::Context;
 using Shared::Platform::WindowGl;
@@ -23,6 +25,7 @@ using Shared::Platform::SizeState;
 using Shared::Platform::MouseState;
 using Shared::Platform::PerformanceTimer;
 using Shared::Platform::Ip;
+using Shared::Platform::Mutex;
 
 namespace Glest{ namespace Game{
 
@@ -75,6 +78,10 @@ private:
 	PerformanceTimer fpsTimer;
 	PerformanceTimer updateTimer;
 	PerformanceTimer updateCameraTimer;
+	FrameScheduler frameScheduler;
+
+	//held while the program state runs, released by states that work in other threads
+	Mutex stateMutex;
 
     WindowGl *window;
 
@@ -101,6 +108,9 @@ public:
 	//misc
 	void setState(ProgramState *programState);
 	void exit();
+	Mutex *getStateMutex()	{return &stateMutex;}
+	void setIdle(bool idle)	{frameScheduler.setIdle(idle);}
+	const FrameScheduler *getFrameScheduler() const	{return &frameScheduler;}
 	
 private:
 	void init(WindowGl *window);
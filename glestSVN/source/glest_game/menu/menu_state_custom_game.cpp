@@ -23,6 +23,7 @@
 #include "conversion.h"
 #include "socket.h"
 #include "game.h"
+#include "asset_preloader.h"
 
 #include "leak_dumper.h"
 
@@ -34,6 +35,8 @@ using namespace Shared::Util;
 // 	class MenuStateCustomGame
 // =====================================================
 
+const int MenuStateCustomGame::preloadDelayFrames= GameConstants::updateFps/2;
+
 MenuStateCustomGame::MenuStateCustomGame(Program *program, MainMenu *mainMenu, bool openNetworkSlots): 
 	MenuState(program, mainMenu, "new-game")
 {
@@ -42,6 +45,8 @@ MenuStateCustomGame::MenuStateCustomGame(Program *program, MainMenu *mainMenu, b
 
 	vector<string> results, teamItems, controlItems;
 
+	preloadDelay= 0;
+
 	//create
 	buttonReturn.init(350, 200, 125);
 	buttonPlayNow.init(525, 200, 125);
@@ -164,6 +169,7 @@ void MenuStateCustomGame::mouseClick(int x, int y, MouseButton mouseButton){
 
 	if(buttonReturn.mouseClick(x,y)){
 		soundRenderer.playFx(coreData.getClickSoundA());
+		AssetPreloader::getInstance().stop();
 		mainMenu->setState(new MenuStateNewGame(program, mainMenu));
     }  
 	else if(buttonPlayNow.mouseClick(x,y)){
@@ -292,6 +298,8 @@ void MenuStateCustomGame::update(){
 			labelNetStatus[i].setText("");
 		}
 	}
+
+	updatePreload();
 }
 
 void MenuStateCustomGame::loadGameSettings(GameSettings *gameSettings){
@@ -422,4 +430,23 @@ void MenuStateCustomGame::updateNetworkSlots(){
 	}
 }
 
+//drops the preloaded assets when the selection changes and starts again when it settles
+void MenuStateCustomGame::updatePreload(){
+	const string &techName= techTreeFiles[listBoxTechTree.getSelectedItemIndex()];
+	const string &tilesetName= tilesetFiles[listBoxTileset.getSelectedItemIndex()];
+
+	if(techName!=preloadTechName || tilesetName!=preloadTilesetName){
+		AssetPreloader::getInstance().stop();
+		preloadTechName= techName;
+		preloadTilesetName= tilesetName;
+		preloadDelay= preloadDelayFrames;
+	}
+	else if(preloadDelay>0){
+		--preloadDelay;
+		if(preloadDelay==0){
+			AssetPreloader::getInstance().preload(techName, tilesetName);
+		}
+	}
+}
+
 }}//end namespace
@@ -21,6 +21,9 @@ namespace Glest{ namespace Game{
 // ===============================
 
 class MenuStateCustomGame: public MenuState{
+private:
+	static const int preloadDelayFrames;
+
 private:
 	GraphicButton buttonReturn;
 	GraphicButton buttonPlayNow;
@@ -45,6 +48,11 @@ private:
 	GraphicLabel labelNetStatus[GameConstants::maxPlayers];
 	MapInfo mapInfo;
 
+	//asset preloading starts once the selection is stable
+	string preloadTechName;
+	string preloadTilesetName;
+	int preloadDelay;
+
 public:
 	MenuStateCustomGame(Program *program, MainMenu *mainMenu, bool openNetworkSlots= false);
 
@@ -60,6 +68,7 @@ private:
 	void updateControlers();
 	void closeUnusedSlots();
 	void updateNetworkSlots();
+	void updatePreload();
 };
 
 }}//end namespace
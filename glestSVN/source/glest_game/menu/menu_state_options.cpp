@@ -220,8 +220,7 @@ void MenuStateOptions::saveConfig(){
 	Config &config= Config::getInstance();
 
 	config.save();
-	Renderer::getInstance().loadConfig();
-	SoundRenderer::getInstance().loadConfig();
+	config.notifyObservers();
 }
 
 }}//end namespace
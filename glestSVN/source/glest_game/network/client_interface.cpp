@@ -140,7 +140,7 @@ void ClientInterface::updateLobby(){
 	}
 }
 
-void ClientInterface::updateKeyframe(int frameCount){
+void ClientInterface::updateKeyframe(int frameCount, int worldHash){
 	
 	bool done= false;
 
@@ -164,6 +164,13 @@ void ClientInterface::updateKeyframe(int frameCount){
 					throw runtime_error("Network synchronization error, frame counts do not match");
 				}
 
+				//check that our world matches the server one, and report the first difference
+				if(networkMessageCommandList.getWorldHash()!=worldHash && !desyncDetected){
+					NetworkMessageDesync networkMessageDesync(frameCount);
+					sendMessage(&networkMessageDesync);
+					setDesyncFrame(frameCount);
+				}
+
 				// give all commands
 				for(int i= 0; i<networkMessageCommandList.getCommandCount(); ++i){
 					pendingCommands.push_back(*networkMessageCommandList.getCommand(i));
@@ -173,6 +180,15 @@ void ClientInterface::updateKeyframe(int frameCount){
 			}
 			break;
 
+			//another client reported a desync, dump the same keyframe
+			case nmtDesync:{
+				NetworkMessageDesync networkMessageDesync;
+				if(receiveMessage(&networkMessageDesync)){
+					setDesyncFrame(networkMessageDesync.getFrameCount());
+				}
+			}
+			break;
+
 			case nmtQuit:{
 				NetworkMessageQuit networkMessageQuit;
 				if(receiveMessage(&networkMessageQuit)){
@@ -52,7 +52,7 @@ public:
 	//message processing
 	virtual void update();
 	virtual void updateLobby();
-	virtual void updateKeyframe(int frameCount);
+	virtual void updateKeyframe(int frameCount, int worldHash);
 	virtual void waitUntilReady(Checksum* checksum);
 
 	// message sending
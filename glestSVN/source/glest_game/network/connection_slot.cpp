@@ -72,6 +72,15 @@ void ConnectionSlot::update(){
 				}
 				break;
 
+				//a client world state differs from ours
+				case nmtDesync:{
+					NetworkMessageDesync networkMessageDesync;
+					if(receiveMessage(&networkMessageDesync)){
+						serverInterface->reportDesync(networkMessageDesync.getFrameCount(), playerIndex);
+					}
+				}
+				break;
+
 				//process intro messages
 				case nmtIntro:{
 					NetworkMessageIntro networkMessageIntro;
@@ -72,6 +72,15 @@ bool NetworkInterface::isConnected(){
 
 GameNetworkInterface::GameNetworkInterface(){
 	quit= false;
+	desyncFrame= -1;
+	desyncDetected= false;
+}
+
+void GameNetworkInterface::setDesyncFrame(int frameCount){
+	if(!desyncDetected){
+		desyncFrame= frameCount;
+		desyncDetected= true;
+	}
 }
 
 }}//end namespace
@@ -67,6 +67,8 @@ protected:
 	string chatText;
 	string chatSender;
 	int chatTeamIndex;
+	int desyncFrame;		//first keyframe where the world states differed, -1 if not pending
+	bool desyncDetected;	//only the first desync is reported
 
 public:
 	GameNetworkInterface();
@@ -74,7 +76,7 @@ public:
 	//message processimg
 	virtual void update()= 0;
 	virtual void updateLobby()= 0;
-	virtual void updateKeyframe(int frameCount)= 0;
+	virtual void updateKeyframe(int frameCount, int worldHash)= 0;
 	virtual void waitUntilReady(Checksum* checksum)= 0;
 
 	//message sending
@@ -93,6 +95,9 @@ public:
 	const string getChatText() const							{return chatText;}
 	const string getChatSender() const							{return chatSender;}
 	int getChatTeamIndex() const								{return chatTeamIndex;}
+	int getDesyncFrame() const									{return desyncFrame;}
+	void clearDesyncFrame()										{desyncFrame= -1;}
+	void setDesyncFrame(int frameCount);
 };
 
 }}//end namespace
@@ -154,9 +154,10 @@ void NetworkMessageLaunch::send(Socket* socket) const{
 //	class NetworkMessageLaunch
 // =====================================================
 
-NetworkMessageCommandList::NetworkMessageCommandList(int32 frameCount){
+NetworkMessageCommandList::NetworkMessageCommandList(int32 frameCount, int32 worldHash){
 	data.messageType= nmtCommandList;
 	data.frameCount= frameCount;
+	data.worldHash= worldHash;
 	data.commandCount= 0;
 }
 
@@ -215,4 +216,22 @@ void NetworkMessageQuit::send(Socket* socket) const{
 	NetworkMessage::send(socket, &data, sizeof(data));
 }
 
+// =====================================================
+//	class NetworkMessageDesync
+// =====================================================
+
+NetworkMessageDesync::NetworkMessageDesync(int32 frameCount){
+	data.messageType= nmtDesync; 
+	data.frameCount= frameCount;
+}
+
+bool NetworkMessageDesync::receive(Socket* socket){
+	return NetworkMessage::receive(socket, &data, sizeof(data));
+}
+
+void NetworkMessageDesync::send(Socket* socket) const{
+	assert(data.messageType==nmtDesync);
+	NetworkMessage::send(socket, &data, sizeof(data));
+}
+
 }}//end namespace
@@ -33,6 +33,7 @@ enum NetworkMessageType{
 	nmtCommandList,
 	nmtText,
 	nmtQuit,
+	nmtDesync,
 
 	nmtCount
 };
@@ -172,6 +173,7 @@ private:
 		int8 messageType;
 		int8 commandCount;
 		int32 frameCount;
+		int32 worldHash;
 		NetworkCommand commands[maxCommandCount];
 	};
 
@@ -179,13 +181,14 @@ private:
 	Data data;
 
 public:
-	NetworkMessageCommandList(int32 frameCount= -1);
+	NetworkMessageCommandList(int32 frameCount= -1, int32 worldHash= 0);
 
 	bool addCommand(const NetworkCommand* networkCommand);
 	
 	void clear()									{data.commandCount= 0;}
 	int getCommandCount() const						{return data.commandCount;}
 	int getFrameCount() const						{return data.frameCount;}
+	int getWorldHash() const						{return data.worldHash;}
 	const NetworkCommand* getCommand(int i) const	{return &data.commands[i];}
 
 	virtual bool receive(Socket* socket);
@@ -247,6 +250,32 @@ public:
 	virtual void send(Socket* socket) const;
 };
 
+// =====================================================
+//	class NetworkMessageDesync
+//
+//	Message sent by a client whose world state does not
+//	match the server one
+// =====================================================
+
+class NetworkMessageDesync: public NetworkMessage{
+private:
+	struct Data{
+		int8 messageType;
+		int32 frameCount;
+	};
+
+private:
+	Data data;
+
+public:
+	NetworkMessageDesync(int32 frameCount= -1);
+
+	int getFrameCount() const	{return data.frameCount;}
+
+	virtual bool receive(Socket* socket);
+	virtual void send(Socket* socket) const;
+};
+
 }}//end namespace
 
 #endif
@@ -108,9 +108,9 @@ void ServerInterface::update(){
 	}
 }
 
-void ServerInterface::updateKeyframe(int frameCount){
+void ServerInterface::updateKeyframe(int frameCount, int worldHash){
 
-	NetworkMessageCommandList networkMessageCommandList(frameCount);
+	NetworkMessageCommandList networkMessageCommandList(frameCount, worldHash);
 	
 	//build command list, remove commands from requested and add to pending
 	while(!requestedCommands.empty()){
@@ -127,6 +127,16 @@ void ServerInterface::updateKeyframe(int frameCount){
 	broadcastMessage(&networkMessageCommandList);
 }
 
+//a client world state differs from ours, the first report is relayed to the 
+//other clients so every peer dumps the same keyframe
+void ServerInterface::reportDesync(int frameCount, int playerIndex){
+	if(!desyncDetected){
+		setDesyncFrame(frameCount);
+		NetworkMessageDesync networkMessageDesync(frameCount);
+		broadcastMessage(&networkMessageDesync, playerIndex);
+	}
+}
+
 void ServerInterface::waitUntilReady(Checksum* checksum){
 	
 	Chrono chrono;
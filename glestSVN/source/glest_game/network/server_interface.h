@@ -43,7 +43,7 @@ public:
 	//message processing
 	virtual void update();
 	virtual void updateLobby(){};
-	virtual void updateKeyframe(int frameCount);
+	virtual void updateKeyframe(int frameCount, int worldHash);
 	virtual void waitUntilReady(Checksum* checksum);
 
 	// message sending
@@ -60,6 +60,7 @@ public:
 	int getConnectedSlotCount();
 
 	void launchGame(const GameSettings* gameSettings);
+	void reportDesync(int frameCount, int playerIndex);
 
 private:
 	void broadcastMessage(const NetworkMessage* networkMessage, int excludeSlot= -1);
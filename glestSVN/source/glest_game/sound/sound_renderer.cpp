@@ -31,6 +31,7 @@ const float SoundRenderer::audibleDist= 50.f;
 
 SoundRenderer::SoundRenderer(){
 	loadConfig();
+	Config::getInstance().addObserver(this);
 }
 
 void SoundRenderer::init(Window *window){
@@ -48,6 +49,7 @@ void SoundRenderer::init(Window *window){
 }
 
 SoundRenderer::~SoundRenderer(){
+	Config::getInstance().removeObserver(this);
 	delete soundPlayer;
 }
 
@@ -16,6 +16,7 @@
 #include "sound_player.h"
 #include "window.h"
 #include "vec.h"
+#include "config.h"
 
 namespace Glest{ namespace Game{
 
@@ -30,7 +31,7 @@ using Shared::Graphics::Vec3f;
 ///	Wrapper to acces the shared library sound engine
 // =====================================================
 
-class SoundRenderer{
+class SoundRenderer: public ConfigObserver{
 public:
 	static const int ambientFade;
 	static const float audibleDist;
@@ -69,6 +70,7 @@ public:
 	//misc
 	void stopAllSounds();
 	void loadConfig();
+	virtual void configChanged()	{loadConfig();}
 };
 
 }}//end namespace
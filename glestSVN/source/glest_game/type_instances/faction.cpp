@@ -26,13 +26,39 @@ using namespace Shared::Util;
 
 namespace Glest{ namespace Game{
 
+// =====================================================
+// 	class UnitIndex
+// =====================================================
+
+void UnitIndex::add(Unit *unit){
+	int id= unit->getId();
+	if(id>=units.size()){
+		units.resize(id+1, NULL);
+	}
+	assert(units[id]==NULL);
+	units[id]= unit;
+}
+
+void UnitIndex::remove(Unit *unit){
+	assert(unit->getId()<units.size() && units[unit->getId()]==unit);
+	units[unit->getId()]= NULL;
+}
+
+Unit *UnitIndex::find(int id) const{
+	if(id<0 || id>=units.size()){
+		return NULL;
+	}
+	return units[id];
+}
+
 // =====================================================
 // 	class Faction
 // =====================================================
 
 void Faction::init(
 	const FactionType *factionType, ControlType control, TechTree *techTree, 
-	int factionIndex, int teamIndex, int startLocationIndex, bool thisFaction, bool giveResources)
+	int factionIndex, int teamIndex, int startLocationIndex, bool thisFaction, bool giveResources, 
+	UnitIndex *unitIndex)
 {
 	this->control= control;
 	this->factionType= factionType;
@@ -40,6 +66,16 @@ void Faction::init(
 	this->index= factionIndex;
 	this->teamIndex= teamIndex;
 	this->thisFaction= thisFaction;
+	this->unitIndex= unitIndex;
+
+	aliveUnitCounts.resize(factionType->getUnitTypeCount(), 0);
+	aliveUnitCount= 0;
+	for(int i=0; i<unitClassCount; ++i){
+		aliveClassCounts[i]= 0;
+	}
+	operativeUnitCounts.resize(factionType->getUnitTypeCount(), 0);
+	upkeeps.resize(techTree->getResourceTypeCount(), 0);
+	storeVersion= 0;
 
 	resources.resize(techTree->getResourceTypeCount());
 	store.resize(techTree->getResourceTypeCount());
@@ -55,6 +91,9 @@ void Faction::init(
 }
 
 void Faction::end(){
+	for(int i=0; i<units.size(); ++i){
+		unitIndex->remove(units[i]);
+	}
 	deleteValues(units.begin(), units.end());
 }
 
@@ -85,6 +124,19 @@ bool Faction::getCpuControl() const{
 }
 	
 
+int Faction::getAliveUnitCount(const UnitType *ut) const{
+	return aliveUnitCounts[ut->getId()];
+}
+
+int Faction::getOperativeUnitCount(const UnitType *ut) const{
+	return operativeUnitCounts[ut->getId()];
+}
+
+//consumable resources used by the operative units on each interval
+int Faction::getUpkeep(const ResourceType *rt) const{
+	return upkeeps[getResourceIndex(rt)];
+}
+
 // ==================== upgrade manager ====================
 
 void Faction::startUpgrade(const UpgradeType *ut){
@@ -109,16 +161,7 @@ bool Faction::reqsOk(const RequirableType *rt) const{
     
 	//required units
     for(int i=0; i<rt->getUnitReqCount(); ++i){ 
-        bool found=false;
-        for(int j=0; j<getUnitCount(); ++j){
-			Unit *unit= getUnit(j);
-            const UnitType *ut= unit->getType();
-            if(rt->getUnitReq(i)==ut && unit->isOperative()){
-                found= true;
-                break;
-            }
-        }
-		if(!found){
+		if(getOperativeUnitCount(rt->getUnitReq(i))==0){
             return false;
 		}
     }
@@ -357,6 +400,13 @@ Unit *Faction::findUnit(int id){
 void Faction::addUnit(Unit *unit){
 	units.push_back(unit);
 	unitMap.insert(make_pair(unit->getId(), unit));
+	unitIndex->add(unit);
+	if(unit->isAlive()){
+		addAliveUnit(unit->getType());
+	}
+	if(unit->isOperative()){
+		addOperativeUnit(unit->getType());
+	}
 }
 
 void Faction::removeUnit(Unit *unit){
@@ -364,14 +414,68 @@ void Faction::removeUnit(Unit *unit){
 		if(units[i]==unit){
 			units.erase(units.begin()+i);
 			unitMap.erase(unit->getId());
+			unitIndex->remove(unit);
 			assert(units.size()==unitMap.size());
+			if(unit->isAlive()){
+				removeAliveUnit(unit->getType());
+			}
+			if(unit->isOperative()){
+				removeOperativeUnit(unit->getType());
+			}
 			return;
 		}
 	}
 	assert(false);	
 }
 
+//alive unit counters, units call these when they die or morph
+void Faction::addAliveUnit(const UnitType *ut){
+	++aliveUnitCounts[ut->getId()];
+	++aliveUnitCount;
+	for(int i=0; i<unitClassCount; ++i){
+		if(ut->isOfClass(static_cast<UnitClass>(i))){
+			++aliveClassCounts[i];
+		}
+	}
+}
+
+void Faction::removeAliveUnit(const UnitType *ut){
+	--aliveUnitCounts[ut->getId()];
+	--aliveUnitCount;
+	for(int i=0; i<unitClassCount; ++i){
+		if(ut->isOfClass(static_cast<UnitClass>(i))){
+			--aliveClassCounts[i];
+		}
+	}
+	assert(aliveUnitCounts[ut->getId()]>=0);
+}
+
+//operative unit counters, units call these when they are built, die or morph
+void Faction::addOperativeUnit(const UnitType *ut){
+	++operativeUnitCounts[ut->getId()];
+	for(int i=0; i<ut->getCostCount(); ++i){
+		const Resource *r= ut->getCost(i);
+		if(r->getType()->getClass()==rcConsumable){
+			upkeeps[getResourceIndex(r->getType())]+= r->getAmount();
+		}
+	}
+}
+
+void Faction::removeOperativeUnit(const UnitType *ut){
+	--operativeUnitCounts[ut->getId()];
+	for(int i=0; i<ut->getCostCount(); ++i){
+		const Resource *r= ut->getCost(i);
+		if(r->getType()->getClass()==rcConsumable){
+			upkeeps[getResourceIndex(r->getType())]-= r->getAmount();
+		}
+	}
+	assert(operativeUnitCounts[ut->getId()]>=0);
+}
+
 void Faction::addStore(const UnitType *unitType){
+	if(unitType->getStoredResourceCount()>0){
+		++storeVersion;
+	}
 	for(int i=0; i<unitType->getStoredResourceCount(); ++i){
 		const Resource *r= unitType->getStoredResource(i);
 		for(int j=0; j<store.size(); ++j){
@@ -384,6 +488,9 @@ void Faction::addStore(const UnitType *unitType){
 }
 
 void Faction::removeStore(const UnitType *unitType){
+	if(unitType->getStoredResourceCount()>0){
+		++storeVersion;
+	}
 	for(int i=0; i<unitType->getStoredResourceCount(); ++i){
 		const Resource *r= unitType->getStoredResource(i);
 		for(int j=0; j<store.size(); ++j){
@@ -416,4 +523,14 @@ void Faction::resetResourceAmount(const ResourceType *rt){
 	assert(false);
 }
 
+int Faction::getResourceIndex(const ResourceType *rt) const{
+	for(int i=0; i<resources.size(); ++i){
+		if(resources[i].getType()==rt){
+			return i;
+		}
+	}
+	assert(false);
+	return 0;
+}
+
 }}//end namespace
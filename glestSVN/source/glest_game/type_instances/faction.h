@@ -19,6 +19,7 @@
 #include "texture.h"
 #include "resource.h"
 #include "game_constants.h"
+#include "unit_type.h"
 
 using std::map;
 using std::vector;
@@ -28,6 +29,7 @@ using Shared::Graphics::Texture2D;
 namespace Glest{ namespace Game{
 
 class Unit;
+class UnitType;
 class TechTree;
 class FactionType;
 class ProducibleType;
@@ -35,6 +37,26 @@ class RequirableType;
 class CommandType;
 class UnitType;
 
+// =====================================================
+// 	class UnitIndex
+//
+///	Finds the units of all the factions by id
+// =====================================================
+
+class UnitIndex{
+private:
+	typedef vector<Unit*> Units;
+
+private:
+	Units units;	//indexed by id, ids are given in order and not reused
+
+public:
+	void add(Unit *unit);
+	void remove(Unit *unit);
+	void clear()	{units.clear();}
+	Unit *find(int id) const;
+};
+
 // =====================================================
 // 	class Faction
 //
@@ -57,6 +79,16 @@ private:
 	Allies allies;
 	Units units;
 	UnitMap unitMap;
+	UnitIndex *unitIndex;
+
+	//alive units, by unit type id and by class
+	vector<int> aliveUnitCounts;
+	int aliveUnitCount;
+	int aliveClassCounts[unitClassCount];
+
+	//operative units, by unit type id, and what they consume, by resource
+	vector<int> operativeUnitCounts;
+	vector<int> upkeeps;
 
     ControlType control;
 
@@ -69,10 +101,14 @@ private:
 
 	bool thisFaction;
 
+	//incremented when stores are added or removed
+	int storeVersion;
+
 public:
     void init(
 		const FactionType *factionType, ControlType control, TechTree *techTree, 
-		int factionIndex, int teamIndex, int startLocationIndex, bool thisFaction, bool giveResources);
+		int factionIndex, int teamIndex, int startLocationIndex, bool thisFaction, bool giveResources, 
+		UnitIndex *unitIndex);
 	void end();
 
     //get
@@ -86,9 +122,15 @@ public:
 	bool getCpuUltraControl() const						{return control==ctCpuUltra;}
 	Unit *getUnit(int i) const							{return units[i];}
 	int getUnitCount() const							{return units.size();}		
+	int getAliveUnitCount() const						{return aliveUnitCount;}
+	int getAliveUnitCount(const UnitType *ut) const;
+	int getAliveUnitCount(UnitClass uc) const			{return aliveClassCounts[uc];}
+	int getOperativeUnitCount(const UnitType *ut) const;
+	int getUpkeep(const ResourceType *rt) const;
 	const UpgradeManager *getUpgradeManager() const		{return &upgradeManager;}
 	const Texture2D *getTexture() const					{return texture;}
 	int getStartLocationIndex() const					{return startLocationIndex;}
+	int getStoreVersion() const							{return storeVersion;}
 
 	//upgrades
 	void startUpgrade(const UpgradeType *ut);
@@ -117,6 +159,10 @@ public:
 	Unit *findUnit(int id);
 	void addUnit(Unit *unit);
 	void removeUnit(Unit *unit);
+	void addAliveUnit(const UnitType *ut);
+	void removeAliveUnit(const UnitType *ut);
+	void addOperativeUnit(const UnitType *ut);
+	void removeOperativeUnit(const UnitType *ut);
 	void addStore(const UnitType *unitType);
 	void removeStore(const UnitType *unitType);
 
@@ -127,6 +173,7 @@ public:
 private:
 	void limitResourcesToStore();
 	void resetResourceAmount(const ResourceType *rt);
+	int getResourceIndex(const ResourceType *rt) const;
 };
 
 }}//end namespace
@@ -11,6 +11,7 @@
 #include "faction.h" 
 
 #include <cassert>
+#include <cstring>
 
 #include "unit.h"
 #include "world.h"
@@ -22,6 +23,7 @@
 #include "skill_type.h"
 #include "core_data.h"
 #include "renderer.h"
+#include "checksum.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Graphics;
@@ -116,6 +118,7 @@ Unit::Unit(int id, const Vec2i &pos, const UnitType *type, Faction *faction, Map
     animProgress= 0;
     progress2= 0;
 	kills= 0;
+	stateHash= 0;
 	loadCount= 0;
     ep= 0;
 	deadCount= 0;
@@ -178,15 +181,15 @@ Vec2i Unit::getCellPos() const{
 		
 		//find nearest pos to center that is free
 		Vec2i centeredPos= getCenteredPos();
-		float nearestDist= -1.f;
+		int nearestDist= -1;
 		Vec2i nearestPos= pos;
 
 		for(int i=0; i<type->getSize(); ++i){
 			for(int j=0; j<type->getSize(); ++j){
 				if(type->getCellMapCell(i, j)){
 					Vec2i currPos= pos + Vec2i(i, j);
-					float dist= currPos.dist(centeredPos);
-					if(nearestDist==-1.f || dist<nearestDist){
+					int dist= currPos.sqDist(centeredPos);
+					if(nearestDist==-1 || dist<nearestDist){
 						nearestDist= dist;
 						nearestPos= currPos;
 					}
@@ -313,7 +316,18 @@ void Unit::setCurrSkill(const SkillType *currSkill){
 		lastAnimProgress= 0;
 	}
 	progress2= 0;
+
+	//the faction counts operative units, being built is the only skill that is not
+	bool wasBuilt= isBuilt();
 	this->currSkill= currSkill;
+	if(alive && wasBuilt!=isBuilt()){
+		if(wasBuilt){
+			faction->removeOperativeUnit(type);
+		}
+		else{
+			faction->addOperativeUnit(type);
+		}
+	}
 }
 
 void Unit::setCurrSkill(SkillClass sc){
@@ -682,7 +696,7 @@ bool Unit::repair(){
 
 	//stop fire
 	if(hp>type->getMaxHp()/2 && fire!=NULL){
-		fire->fade();
+		Renderer::getInstance().fadeParticleSystem(fire, rsGame);
 		fire= NULL;
 	}
     return false;
@@ -713,8 +727,12 @@ bool Unit::decHp(int i){
     if(hp<=0){
 		alive= false;
         hp=0;
+		faction->removeAliveUnit(type);
+		if(isBuilt()){
+			faction->removeOperativeUnit(type);
+		}
 		if(fire!=NULL){
-			fire->fade();
+			Renderer::getInstance().fadeParticleSystem(fire, rsGame);
 			fire= NULL;
 		}
 		return true;
@@ -826,6 +844,33 @@ void Unit::incKills(){
 	}
 }
 
+//only simulation state goes in, render state like rotation or animation may differ between peers
+void Unit::updateStateHash(){
+	Checksum checksum;
+
+	//the skill progress is hashed bit for bit, float divergences show up there first
+	int32 progressBits;
+	memcpy(&progressBits, &progress, sizeof(progressBits));
+
+	checksum.addInt(id);
+	checksum.addInt(pos.x);
+	checksum.addInt(pos.y);
+	checksum.addInt(hp);
+	checksum.addInt(ep);
+	checksum.addInt(loadCount);
+	checksum.addInt(kills);
+	checksum.addInt(progress2);
+	checksum.addInt(progressBits);
+	checksum.addInt(currSkill->getClass());
+	checksum.addInt(commands.size());
+	if(!commands.empty()){
+		checksum.addInt(commands.front()->getCommandType()->getClass());
+		checksum.addInt(commands.front()->getPos().x);
+		checksum.addInt(commands.front()->getPos().y);
+	}
+	stateHash= checksum.getSum();
+}
+
 bool Unit::morph(const MorphCommandType *mct){
 	const UnitType *morphUnitType= mct->getMorphUnit();
 
@@ -833,6 +878,10 @@ bool Unit::morph(const MorphCommandType *mct){
 		map->clearUnitCells(this, pos);
 		faction->deApplyStaticCosts(type);
 		hp+= morphUnitType->getMaxHp() - type->getMaxHp();
+		faction->removeAliveUnit(type);
+		faction->addAliveUnit(morphUnitType);
+		faction->removeOperativeUnit(type);
+		faction->addOperativeUnit(morphUnitType);
 		type= morphUnitType;
 		level= NULL;
 		computeTotalUpgrade();
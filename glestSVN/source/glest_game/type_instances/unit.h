@@ -140,6 +140,7 @@ private:
 	float highlight;
 	int progress2;  
 	int kills;
+	int stateHash;			//hash of the simulation state, refreshed after each update
 
 	UnitReference targetRef;
 
@@ -191,6 +192,7 @@ public:
 	int getTeam() const;
 	int getHp() const							{return hp;}
 	int getEp() const							{return ep;}
+	int getStateHash() const					{return stateHash;}
 	int getProductionPercent() const;
 	float getHpRatio() const;
 	float getEpRatio() const;
@@ -282,6 +284,7 @@ public:
 	void applyUpgrade(const UpgradeType *upgradeType);
 	void computeTotalUpgrade();
 	void incKills();
+	void updateStateHash();
 	bool morph(const MorphCommandType *mct);
 	CommandResult checkCommand(Command *command) const;
 	void applyCommand(Command *command);
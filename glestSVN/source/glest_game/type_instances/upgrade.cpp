@@ -64,6 +64,7 @@ UpgradeManager::~UpgradeManager(){
 
 void UpgradeManager::startUpgrade(const UpgradeType *upgradeType, int factionIndex){
 	upgrades.push_back(new Upgrade(upgradeType, factionIndex));
+	upgradeStates[upgradeType]= usUpgrading;
 }
 
 void UpgradeManager::cancelUpgrade(const UpgradeType *upgradeType){
@@ -77,6 +78,7 @@ void UpgradeManager::cancelUpgrade(const UpgradeType *upgradeType){
 
 	if(it!=upgrades.end()){
 		upgrades.erase(it);
+		upgradeStates.erase(upgradeType);
 	}
 	else{
 		throw runtime_error("Error canceling upgrade, upgrade not found in upgrade manager");
@@ -94,6 +96,7 @@ void UpgradeManager::finishUpgrade(const UpgradeType *upgradeType){
 
 	if(it!=upgrades.end()){
 		(*it)->setState(usUpgraded);
+		upgradeStates[upgradeType]= usUpgraded;
 	}
 	else{
 		throw runtime_error("Error finishing upgrade, upgrade not found in upgrade manager");
@@ -101,33 +104,17 @@ void UpgradeManager::finishUpgrade(const UpgradeType *upgradeType){
 }
 
 bool UpgradeManager::isUpgradingOrUpgraded(const UpgradeType *upgradeType) const{
-	Upgrades::const_iterator it;
-	
-	for(it= upgrades.begin(); it!=upgrades.end(); it++){
-		if((*it)->getType()==upgradeType){
-			return true;
-		}
-	}
-
-	return false;
+	return upgradeStates.find(upgradeType)!=upgradeStates.end();
 }
 
 bool UpgradeManager::isUpgraded(const UpgradeType *upgradeType) const{
-	for(Upgrades::const_iterator it= upgrades.begin(); it!=upgrades.end(); it++){
-		if((*it)->getType()==upgradeType && (*it)->getState()==usUpgraded){
-			return true;
-		}
-	}
-	return false;
+	UpgradeStates::const_iterator it= upgradeStates.find(upgradeType);
+	return it!=upgradeStates.end() && it->second==usUpgraded;
 }
 
 bool UpgradeManager::isUpgrading(const UpgradeType *upgradeType) const{
-	for(Upgrades::const_iterator it= upgrades.begin(); it!=upgrades.end(); it++){
-		if((*it)->getType()==upgradeType && (*it)->getState()==usUpgrading){
-			return true;
-		}
-	}
-	return false;
+	UpgradeStates::const_iterator it= upgradeStates.find(upgradeType);
+	return it!=upgradeStates.end() && it->second==usUpgrading;
 }
 
 void UpgradeManager::computeTotalUpgrade(const Unit *unit, TotalUpgrade *totalUpgrade) const{
@@ -13,8 +13,10 @@
 #define _GLEST_GAME_UPGRADE_H_
 
 #include <vector>
+#include <map>
 
 using std::vector;
+using std::map;
 
 namespace Glest{ namespace Game{
 
@@ -66,7 +68,10 @@ private:
 class UpgradeManager{
 private:	
 	typedef vector<Upgrade*> Upgrades;
+	typedef map<const UpgradeType*, UpgradeState> UpgradeStates;
+
 	Upgrades upgrades;
+	UpgradeStates upgradeStates;	//to answer state queries without scanning upgrades
 public:
 	~UpgradeManager();
 
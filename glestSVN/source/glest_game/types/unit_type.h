@@ -55,7 +55,9 @@ public:
 enum UnitClass{
 	ucWarrior,
 	ucWorker,
-	ucBuilding
+	ucBuilding,
+
+	unitClassCount
 };
 
 class UnitType: public ProducibleType{
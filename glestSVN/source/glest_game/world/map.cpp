@@ -52,9 +52,10 @@ bool Cell::isFree(Field field) const{
 SurfaceCell::SurfaceCell(){
 	object= NULL;
 	vertex= Vec3f(0.f);
-	normal= Vec3f(0.f, 1.f, 0.f);
 	surfaceType= -1;
-	surfaceTexture= NULL;
+	visible= 0;
+	explored= 0;
+	nearSubmerged= false;
 }
 
 SurfaceCell::~SurfaceCell(){
@@ -71,11 +72,31 @@ void SurfaceCell::deleteResource(){
 }
 
 void SurfaceCell::setExplored(int teamIndex, bool explored){
-	this->explored[teamIndex]= explored;
+	if(explored){
+		this->explored|= 1<<teamIndex;
+	}
+	else{
+		this->explored&= ~(1<<teamIndex);
+	}
 }
 
 void SurfaceCell::setVisible(int teamIndex, bool visible){
-    this->visible[teamIndex]= visible;
+	if(visible){
+		this->visible|= 1<<teamIndex;
+	}
+	else{
+		this->visible&= ~(1<<teamIndex);
+	}
+}
+
+// =====================================================
+// 	class SurfaceCellRender
+// =====================================================
+
+SurfaceCellRender::SurfaceCellRender(){
+	normal= Vec3f(0.f, 1.f, 0.f);
+	color= Vec3f(1.f);
+	surfaceTexture= NULL;
 }
 
 // =====================================================
@@ -90,7 +111,11 @@ const int Map::mapScale= 2;
 Map::Map(){
 	cells= NULL;
 	surfaceCells= NULL;
+	surfaceCellRenders= NULL;
 	startLocations= NULL;
+	occupancy= NULL;
+	occupancyValid= false;
+	buildingVersion= 0;
 }
 
 Map::~Map(){
@@ -98,7 +123,9 @@ Map::~Map(){
 
 	delete [] cells;
 	delete [] surfaceCells;
+	delete [] surfaceCellRenders;
 	delete [] startLocations;
+	delete [] occupancy;
 }
 
 void Map::load(const string &path, TechTree *techTree, Tileset *tileset){
@@ -154,6 +181,8 @@ void Map::load(const string &path, TechTree *techTree, Tileset *tileset){
 			//cells
 			cells= new Cell[w*h];
 			surfaceCells= new SurfaceCell[surfaceW*surfaceH];
+			surfaceCellRenders= new SurfaceCellRender[surfaceW*surfaceH];
+			occupancy= new int[fieldCount*(w+1)*(h+1)];
 			
 			//read heightmap
 			for(int j=0; j<surfaceH; ++j){
@@ -207,6 +236,8 @@ void Map::load(const string &path, TechTree *techTree, Tileset *tileset){
 			throw runtime_error("Can't open file");
 		}
 		fclose(f);
+
+		resourceIndex.init(this, techTree);
 	}
 	catch(const exception &e){
 		throw runtime_error("Error loading map: "+ path+ "\n"+ e.what());
@@ -259,6 +290,13 @@ bool Map::isResourceNear(const Vec2i &pos, const ResourceType *rt, Vec2i &resour
 	return false;
 }
 
+//deletes the resource in a cell, when depleted
+void Map::deleteResource(const Vec2i &pos){
+	SurfaceCell *sc= getSurfaceCell(toSurfCoords(pos));
+	resourceIndex.remove(toSurfCoords(pos), sc->getResource()->getType());
+	sc->deleteResource();
+}
+
 
 // ==================== free cells ==================== 
 
@@ -302,6 +340,21 @@ bool Map::isAproxFreeCell(const Vec2i &pos, Field field, int teamIndex) const{
 }
 
 bool Map::isFreeCells(const Vec2i & pos, int size, Field field) const{
+	
+	//constant time query when the occupancy is up to date
+	if(occupancyValid){
+		if(!isInside(pos) || !isInside(pos.x+size-1, pos.y+size-1)){
+			return false;
+		}
+		const int *o= getOccupancy(field);
+		int x0= pos.x;
+		int y0= pos.y;
+		int x1= pos.x+size;
+		int y1= pos.y+size;
+		int blocked= o[y1*(w+1)+x1] - o[y0*(w+1)+x1] - o[y1*(w+1)+x0] + o[y0*(w+1)+x0];
+		return blocked==0;
+	}
+
 	for(int i=pos.x; i<pos.x+size; ++i){
 		for(int j=pos.y; j<pos.y+size; ++j){
 			if(!isFreeCell(Vec2i(i,j), field)){
@@ -335,6 +388,21 @@ bool Map::isAproxFreeCells(const Vec2i &pos, int size, Field field, int teamInde
 }
 
 
+// ==================== occupancy ==================== 
+
+//builds the occupancy tables if the map changed, may be called from 
+//several AI threads while the world is not updating
+void Map::updateOccupancy() const{
+	if(!occupancyValid){
+		occupancyMutex.p();
+		if(!occupancyValid){
+			computeOccupancy();
+			occupancyValid= true;
+		}
+		occupancyMutex.v();
+	}
+}
+
 // ==================== unit placement ==================== 
 
 //checks if a unit can move from between 2 cells
@@ -418,6 +486,10 @@ void Map::putUnitCells(Unit *unit, const Vec2i &pos){
 		}     
 	}
 	unit->setPos(pos);
+	invalidateOccupancy();
+	if(!ut->hasSkillClass(scMove)){
+		++buildingVersion;
+	}
 }
 
 //removes a unit from cells
@@ -436,6 +508,10 @@ void Map::clearUnitCells(Unit *unit, const Vec2i &pos){
 			}
 		}     
 	}
+	invalidateOccupancy();
+	if(!ut->hasSkillClass(scMove)){
+		++buildingVersion;
+	}
 }
 
 // ==================== misc ==================== 
@@ -500,7 +576,7 @@ void Map::computeNormals(){
     //compute center normals
     for(int i=1; i<surfaceW-1; ++i){
         for(int j=1; j<surfaceH-1; ++j){
-            getSurfaceCell(i, j)->setNormal(
+            getSurfaceCellRender(i, j)->setNormal(
 				getSurfaceCell(i, j)->getVertex().normal(getSurfaceCell(i, j-1)->getVertex(), 
 					getSurfaceCell(i+1, j)->getVertex(), 
 					getSurfaceCell(i, j+1)->getVertex(), 
@@ -601,12 +677,40 @@ void Map::computeCellColors(){
 	for(int i=0; i<surfaceW; ++i){
 		for(int j=0; j<surfaceH; ++j){
 			SurfaceCell *sc= getSurfaceCell(i, j);
+			SurfaceCellRender *scr= getSurfaceCellRender(i, j);
 			if(getDeepSubmerged(sc)){
 				float factor= clamp(waterLevel-sc->getHeight()*1.5f, 1.f, 1.5f);
-				sc->setColor(Vec3f(1.0f, 1.0f, 1.0f)/factor);
+				scr->setColor(Vec3f(1.0f, 1.0f, 1.0f)/factor);
 			}
 			else{
-				sc->setColor(Vec3f(1.0f, 1.0f, 1.0f));
+				scr->setColor(Vec3f(1.0f, 1.0f, 1.0f));
+			}
+		}
+	}
+}
+
+//summed-area tables of the cells that are not free, one per field
+void Map::computeOccupancy() const{
+	int stride= w+1;
+
+	for(int f=0; f<fieldCount; ++f){
+		Field field= static_cast<Field>(f);
+		int *o= getOccupancy(field);
+
+		for(int i=0; i<stride; ++i){
+			o[i]= 0;
+		}
+		for(int j=0; j<h; ++j){
+			int rowBlocked= 0;
+			int *row= &o[(j+1)*stride];
+			const int *prevRow= &o[j*stride];
+			
+			row[0]= 0;
+			for(int i=0; i<w; ++i){
+				if(!isFreeCell(Vec2i(i, j), field)){
+					++rowBlocked;
+				}
+				row[i+1]= prevRow[i+1] + rowBlocked;
 			}
 		}
 	}
@@ -18,6 +18,8 @@
 #include "logger.h"
 #include "object.h"
 #include "game_constants.h"
+#include "thread.h"
+#include "resource_index.h"
 
 #include <cassert>
 
@@ -30,6 +32,7 @@ using Shared::Graphics::Vec4f;
 using Shared::Graphics::Vec2f;
 using Shared::Graphics::Vec2i;
 using Shared::Graphics::Texture2D;
+using Shared::Platform::Mutex;
 
 class Tileset;
 class Unit;
@@ -68,30 +71,24 @@ public:
 // =====================================================
 // 	class SurfaceCell
 //
-//	A heightmap cell, each surface cell is composed by more than one Cell
+//	A heightmap cell, each surface cell is composed by more than one Cell.
+/// Only holds what the simulation uses, render data is in SurfaceCellRender
 // =====================================================
 
 class SurfaceCell{
 private:
 	//geometry
 	Vec3f vertex;			
-	Vec3f normal;	
-	Vec3f color;
-
-	//tex coords
-	Vec2f fowTexCoord;		//tex coords for TEXTURE1 when multitexturing and fogOfWar
-	Vec2f surfTexCoord;		//tex coords for TEXTURE0
 	
 	//surface
 	int surfaceType;		
-    const Texture2D *surfaceTexture;
 
 	//object & resource
 	Object *object;
 
-	//visibility
-	bool visible[GameConstants::maxPlayers];	
-    bool explored[GameConstants::maxPlayers];
+	//visibility, one bit per team
+	unsigned char visible;	
+    unsigned char explored;
 
 	//cache
 	bool nearSubmerged;
@@ -103,31 +100,22 @@ public:
 	//get
 	const Vec3f &getVertex() const				{return vertex;}
 	float getHeight() const						{return vertex.y;}
-	const Vec3f &getColor() const				{return color;}
-	const Vec3f &getNormal() const				{return normal;}	
 	int getSurfaceType() const					{return surfaceType;}
-	const Texture2D *getSurfaceTexture() const	{return surfaceTexture;}
 	Object *getObject() const					{return object;}
 	Resource *getResource() const				{return object==NULL? NULL: object->getResource();}
-	const Vec2f &getFowTexCoord() const			{return fowTexCoord;}
-	const Vec2f &getSurfTexCoord() const		{return surfTexCoord;}
 	bool getNearSubmerged() const				{return nearSubmerged;}
 
-	bool isVisible(int teamIndex) const			{return visible[teamIndex];}
-	bool isExplored(int teamIndex) const		{return explored[teamIndex];}
+	bool isVisible(int teamIndex) const			{return (visible & (1<<teamIndex))!=0;}
+	bool isExplored(int teamIndex) const		{return (explored & (1<<teamIndex))!=0;}
 
 	//set
 	void setVertex(const Vec3f &vertex)			{this->vertex= vertex;}
 	void setHeight(float height)				{vertex.y= height;}  
-	void setNormal(const Vec3f &normal)			{this->normal= normal;}
-	void setColor(const Vec3f &color)			{this->color= color;} 
 	void setSurfaceType(int surfaceType)		{this->surfaceType= surfaceType;}
-	void setSurfaceTexture(const Texture2D *st)	{this->surfaceTexture= st;}
 	void setObject(Object *object)				{this->object= object;}
-	void setFowTexCoord(const Vec2f &ftc)		{this->fowTexCoord= ftc;}
-	void setSurfTexCoord(const Vec2f &stc)		{this->surfTexCoord= stc;}
 	void setExplored(int teamIndex, bool explored);
     void setVisible(int teamIndex, bool visible);
+	void clearVisible(int teamMask)				{visible&= ~teamMask;}
 	void setNearSubmerged(bool nearSubmerged)	{this->nearSubmerged= nearSubmerged;}
 	
 	//misc
@@ -135,11 +123,51 @@ public:
 	bool isFree() const;
 };
 
+// =====================================================
+// 	class SurfaceCellRender
+//
+///	Render only data of a SurfaceCell, kept apart so 
+/// the simulation does not load it into the cache
+// =====================================================
+
+class SurfaceCellRender{
+private:
+	Vec3f normal;	
+	Vec3f color;
+
+	//tex coords
+	Vec2f fowTexCoord;		//tex coords for TEXTURE1 when multitexturing and fogOfWar
+	Vec2f surfTexCoord;		//tex coords for TEXTURE0
+
+    const Texture2D *surfaceTexture;
+
+public:
+	SurfaceCellRender();
+
+	//get
+	const Vec3f &getColor() const				{return color;}
+	const Vec3f &getNormal() const				{return normal;}	
+	const Texture2D *getSurfaceTexture() const	{return surfaceTexture;}
+	const Vec2f &getFowTexCoord() const			{return fowTexCoord;}
+	const Vec2f &getSurfTexCoord() const		{return surfTexCoord;}
+
+	//set
+	void setNormal(const Vec3f &normal)			{this->normal= normal;}
+	void setColor(const Vec3f &color)			{this->color= color;} 
+	void setSurfaceTexture(const Texture2D *st)	{this->surfaceTexture= st;}
+	void setFowTexCoord(const Vec2f &ftc)		{this->fowTexCoord= ftc;}
+	void setSurfTexCoord(const Vec2f &stc)		{this->surfTexCoord= stc;}
+};
+
 
 // =====================================================
 // 	class Map  
 //
-///	Represents the game map (and loads it from a gbm file)
+///	Represents the game map (and loads it from a gbm file). 
+/// Keeps a summed-area table of the blocked cells of each field, 
+/// so isFreeCells() answers in constant time while the map does 
+/// not change. It is invalidated by every world update and built 
+/// again on demand by updateOccupancy()
 // =====================================================
 
 class Map{
@@ -158,8 +186,19 @@ private:
 	int maxPlayers;
 	Cell *cells; 
 	SurfaceCell *surfaceCells;
+	SurfaceCellRender *surfaceCellRenders;
 	Vec2i *startLocations;
 
+	//occupancy, blocked cells in [0, x)*[0, y) for each field
+	int *occupancy;
+	mutable volatile bool occupancyValid;
+	mutable Mutex occupancyMutex;
+
+	//incremented when cells are taken or freed by units that can't move
+	int buildingVersion;
+
+	ResourceIndex resourceIndex;
+
 private:
 	Map(Map&);
 	void operator=(Map&);
@@ -176,6 +215,7 @@ public:
 	Cell *getCell(const Vec2i &pos) const						{return getCell(pos.x, pos.y);}
 	SurfaceCell *getSurfaceCell(int sx, int sy) const			{return &surfaceCells[sy*surfaceW+sx];}
 	SurfaceCell *getSurfaceCell(const Vec2i &sPos) const		{return getSurfaceCell(sPos.x, sPos.y);}
+	SurfaceCellRender *getSurfaceCellRender(int sx, int sy) const	{return &surfaceCellRenders[sy*surfaceW+sx];}
 	int getW() const											{return w;}
 	int getH() const											{return h;}
 	int getSurfaceW() const										{return surfaceW;}
@@ -183,6 +223,8 @@ public:
 	int getMaxPlayers() const									{return maxPlayers;}
 	float getHeightFactor() const								{return heightFactor;}
 	float getWaterLevel() const									{return waterLevel;}
+	int getBuildingVersion() const								{return buildingVersion;}
+	const ResourceIndex *getResourceIndex() const				{return &resourceIndex;}
 	Vec2i getStartLocation(int loactionIndex) const				{return startLocations[loactionIndex];}
 	bool getSubmerged(const SurfaceCell *sc) const				{return sc->getHeight()<waterLevel;}
 	bool getSubmerged(const Cell *c) const						{return c->getHeight()<waterLevel;}
@@ -196,6 +238,7 @@ public:
 	bool isInsideSurface(int sx, int sy) const;
 	bool isInsideSurface(const Vec2i &sPos) const;
 	bool isResourceNear(const Vec2i &pos, const ResourceType *rt, Vec2i &resourcePos) const;
+	void deleteResource(const Vec2i &pos);
 
 	//free cells
 	bool isFreeCell(const Vec2i &pos, Field field) const;
@@ -205,6 +248,10 @@ public:
 	bool isFreeCellsOrHasUnit(const Vec2i &pos, int size, Field field, const Unit *unit) const;
 	bool isAproxFreeCells(const Vec2i &pos, int size, Field field, int teamIndex) const;
 	
+	//occupancy
+	void updateOccupancy() const;
+	void invalidateOccupancy()		{occupancyValid= false;}
+	
 	//unit placement
 	bool aproxCanMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2) const;
 	bool canMove(const Unit *unit, const Vec2i &pos1, const Vec2i &pos2) const;  
@@ -230,6 +277,8 @@ private:
 	void smoothSurface();
 	void computeNearSubmerged();
 	void computeCellColors();
+	void computeOccupancy() const;
+	int *getOccupancy(Field field) const	{return &occupancy[field*(w+1)*(h+1)];}
 };
 
 
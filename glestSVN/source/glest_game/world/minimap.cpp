@@ -33,6 +33,9 @@ const float Minimap::exploredAlpha= 0.5f;
 Minimap::Minimap(){
 	fowPixmap0= NULL;
 	fowPixmap1= NULL;
+	fowChangeRect= Rect2i(0, 0, 0, 0);
+	fowLastChangeRect= Rect2i(0, 0, 0, 0);
+	fowDirtyRect= Rect2i(0, 0, 0, 0);
 	fogOfWar= Config::getInstance().getBool("FogOfWar");
 }
 
@@ -56,6 +59,7 @@ void Minimap::init(int w, int h, const World *world){
 	fowTex->setFormat(Texture::fAlpha);
 	fowTex->getPixmap()->init(next2Power(scaledW), next2Power(scaledH), 1);
 	fowTex->getPixmap()->setPixels(&f);
+	markDirty(Rect2i(0, 0, fowTex->getPixmap()->getW(), fowTex->getPixmap()->getH()));
 
 	//tex
 	tex= renderer.newTexture2D(rsGame);
@@ -79,6 +83,9 @@ void Minimap::incFowTextureAlphaSurface(const Vec2i &sPos, float alpha){
 	
 	if(fowPixmap1->getPixelf(sPos.x, sPos.y)<alpha){
 		fowPixmap1->setPixel(sPos.x, sPos.y, alpha);
+		if(fowPixmap1->getPixelf(sPos.x, sPos.y)!=fowPixmap0->getPixelf(sPos.x, sPos.y)){
+			growRect(fowChangeRect, sPos.x, sPos.y);
+		}
 	}
 }
 
@@ -87,6 +94,10 @@ void Minimap::resetFowTex(){
 	fowPixmap0= fowPixmap1;
 	fowPixmap1= tmpPixmap;
 
+	//the texture may have skipped whole steps, so keep every rect it has not caught up with
+	mergeRect(fowLastChangeRect, fowChangeRect);
+	fowChangeRect= Rect2i(0, 0, 0, 0);
+
 	for(int i=0; i<fowTex->getPixmap()->getW(); ++i){
 		for(int j=0; j<fowTex->getPixmap()->getH(); ++j){
 			if(fogOfWar){
@@ -103,20 +114,43 @@ void Minimap::resetFowTex(){
 			else{
 				fowPixmap1->setPixel(i, j, 1.f);
 			}
+			if(fowPixmap1->getPixelf(i, j)!=fowPixmap0->getPixelf(i, j)){
+				growRect(fowChangeRect, i, j);
+			}
 		}
 	}
 }
 
+//only texels that changed this step or were still blending from earlier ones can differ from fowPixmap1
 void Minimap::updateFowTex(float t){
-	for(int i=0; i<fowPixmap0->getW(); ++i){
-		for(int j=0; j<fowPixmap0->getH(); ++j){
+	Rect2i rect= fowChangeRect;
+	mergeRect(rect, fowLastChangeRect);
+
+	//texels outside fowChangeRect are equal in both pixmaps, so they are final after this pass
+	fowLastChangeRect= Rect2i(0, 0, 0, 0);
+
+	Rect2i updatedRect(0, 0, 0, 0);
+	for(int i=rect.p[0].x; i<rect.p[1].x; ++i){
+		for(int j=rect.p[0].y; j<rect.p[1].y; ++j){
 			float p1= fowPixmap1->getPixelf(i, j);
 			if(p1!=fowTex->getPixmap()->getPixelf(i, j)){
 				float p0= fowPixmap0->getPixelf(i, j);
 				fowTex->getPixmap()->setPixel(i, j, p0+(t*(p1-p0))); 
+				growRect(updatedRect, i, j);
 			}
 		}	
 	}
+	markDirty(updatedRect);
+}
+
+// ==================== get ====================
+
+Rect2i Minimap::takeFowDirtyRect() const{
+	fowDirtyMutex.p();
+	Rect2i rect= fowDirtyRect;
+	fowDirtyRect= Rect2i(0, 0, 0, 0);
+	fowDirtyMutex.v();
+	return rect;
 }
 
 // ==================== PRIVATE ==================== 
@@ -153,4 +187,34 @@ void Minimap::computeTexture(const World *world){
 	}
 }
 
+void Minimap::markDirty(const Rect2i &rect){
+	if(!isEmpty(rect)){
+		fowDirtyMutex.p();
+		mergeRect(fowDirtyRect, rect);
+		fowDirtyMutex.v();
+	}
+}
+
+bool Minimap::isEmpty(const Rect2i &rect){
+	return rect.p[0].x>=rect.p[1].x || rect.p[0].y>=rect.p[1].y;
+}
+
+void Minimap::growRect(Rect2i &rect, int x, int y){
+	mergeRect(rect, Rect2i(x, y, x+1, y+1));
+}
+
+void Minimap::mergeRect(Rect2i &rect, const Rect2i &other){
+	if(isEmpty(other)){
+		return;
+	}
+	if(isEmpty(rect)){
+		rect= other;
+		return;
+	}
+	if(other.p[0].x<rect.p[0].x) rect.p[0].x= other.p[0].x;
+	if(other.p[0].y<rect.p[0].y) rect.p[0].y= other.p[0].y;
+	if(other.p[1].x>rect.p[1].x) rect.p[1].x= other.p[1].x;
+	if(other.p[1].y>rect.p[1].y) rect.p[1].y= other.p[1].y;
+}
+
 }}//end namespace
@@ -14,6 +14,8 @@
 
 #include "pixmap.h"
 #include "texture.h"
+#include "math_util.h"
+#include "thread.h"
 
 namespace Glest{ namespace Game{
 
@@ -22,6 +24,8 @@ using Shared::Graphics::Vec3f;
 using Shared::Graphics::Vec2i;
 using Shared::Graphics::Pixmap2D;
 using Shared::Graphics::Texture2D;
+using Shared::Graphics::Rect2i;
+using Shared::Platform::Mutex;
 
 class World;
 
@@ -45,6 +49,14 @@ private:
 	Texture2D *fowTex;    //Fog Of War Texture2D
 	bool fogOfWar;
 
+	//regions are half open texel rects, empty when p[0].x>=p[1].x
+	Rect2i fowChangeRect;		//texels where fowPixmap0 and fowPixmap1 differ
+	Rect2i fowLastChangeRect;	//texels that were changing in previous steps, until updateFowTex runs
+	
+	//written by the simulation, consumed by the renderer
+	mutable Rect2i fowDirtyRect;	//texels of fowTex not uploaded yet
+	mutable Mutex fowDirtyMutex;
+
 private:
 	static const float exploredAlpha;
 
@@ -55,6 +67,7 @@ public:
 
 	const Texture2D *getFowTexture() const	{return fowTex;}
 	const Texture2D *getTexture() const		{return tex;}
+	Rect2i takeFowDirtyRect() const;
 
 	void incFowTextureAlphaSurface(const Vec2i &sPos, float alpha);
 	void resetFowTex();
@@ -62,6 +75,10 @@ public:
 
 private:
 	void computeTexture(const World *world);
+	void markDirty(const Rect2i &rect);
+	static bool isEmpty(const Rect2i &rect);
+	static void growRect(Rect2i &rect, int x, int y);
+	static void mergeRect(Rect2i &rect, const Rect2i &other);
 };
 
 }}//end namespace 
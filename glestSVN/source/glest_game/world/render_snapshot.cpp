@@ -0,0 +1,226 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#include "render_snapshot.h"
+
+#include "world.h"
+#include "unit.h"
+#include "faction.h"
+#include "game_constants.h"
+#include "util.h"
+#include "leak_dumper.h"
+
+using namespace Shared::Graphics;
+using namespace Shared::Util;
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class RenderSnapshot
+// =====================================================
+
+RenderSnapshot::RenderSnapshot(){
+	clear();
+}
+
+void RenderSnapshot::capture(const World *world, int64 stamp){
+	this->frame= world->getFrameCount();
+	this->stamp= stamp;
+	
+	//units are stored faction by faction, in ascending id order inside each faction
+	units.clear();
+	for(int i=0; i<world->getFactionCount(); ++i){
+		const Faction *faction= world->getFaction(i);
+		for(int j=0; j<faction->getUnitCount(); ++j){
+			const Unit *unit= faction->getUnit(j);
+			const SkillType *st= unit->getCurrSkill();
+			
+			UnitSnapshot us;
+			us.id= unit->getId();
+			us.factionIndex= i;
+			us.model= unit->getCurrentModel();
+			us.pos= unit->getPos();
+			us.vector= unit->getCurrVectorFlat();
+			us.rotation= unit->getRotation();
+			us.verticalRotation= unit->getVerticalRotation();
+			us.animProgress= unit->getAnimProgress();
+			us.skillClass= st->getClass();
+			us.alive= unit->isAlive();
+			us.fade= st->getClass()==scDie && static_cast<const DieSkillType*>(st)->getFade();
+			us.visible= world->toRenderUnit(unit);
+			us.staticShadow= st->getClass()==scStop && unit->getType()->isOfClass(ucBuilding);
+			units.push_back(us);
+		}
+	}
+
+	buildSectors(world->getMap()->getW(), world->getMap()->getH());
+}
+
+void RenderSnapshot::clear(){
+	frame= -1;
+	stamp= 0;
+	units.clear();
+	sectorW= 0;
+	sectorH= 0;
+	sectorStarts.assign(1, 0);
+	sectorUnits.clear();
+}
+
+//units are sorted by faction and id, so a binary search finds them
+const UnitSnapshot *RenderSnapshot::findUnit(int factionIndex, int id) const{
+	int first= 0;
+	int last= units.size();
+	while(first<last){
+		int middle= (first+last)/2;
+		const UnitSnapshot *us= &units[middle];
+		if(us->factionIndex<factionIndex || (us->factionIndex==factionIndex && us->id<id)){
+			first= middle+1;
+		}
+		else{
+			last= middle;
+		}
+	}
+	if(first<units.size() && units[first].factionIndex==factionIndex && units[first].id==id){
+		return &units[first];
+	}
+	return NULL;
+}
+
+// ==================== PRIVATE ==================== 
+
+//counting sort of the units by sector
+void RenderSnapshot::buildSectors(int mapW, int mapH){
+	sectorW= (mapW+sectorSize-1)/sectorSize;
+	sectorH= (mapH+sectorSize-1)/sectorSize;
+	int sectorCount= sectorW*sectorH;
+
+	sectorStarts.assign(sectorCount+1, 0);
+	for(int i=0; i<units.size(); ++i){
+		const Vec2i &pos= units[i].pos;
+		++sectorStarts[(pos.y/sectorSize)*sectorW + pos.x/sectorSize + 1];
+	}
+	for(int i=0; i<sectorCount; ++i){
+		sectorStarts[i+1]+= sectorStarts[i];
+	}
+
+	vector<int> next(sectorStarts.begin(), sectorStarts.end()-1);
+	sectorUnits.resize(units.size());
+	for(int i=0; i<units.size(); ++i){
+		const Vec2i &pos= units[i].pos;
+		sectorUnits[next[(pos.y/sectorSize)*sectorW + pos.x/sectorSize]++]= i;
+	}
+}
+
+// =====================================================
+// 	class SnapshotBuffer
+// =====================================================
+
+SnapshotBuffer::SnapshotBuffer(){
+	init();
+}
+
+void SnapshotBuffer::init(){
+	for(int i=0; i<4; ++i){
+		snapshots[i].clear();
+	}
+	back= &snapshots[0];
+	ready= &snapshots[1];
+	previous= &snapshots[2];
+	current= &snapshots[3];
+	fresh= false;
+	chrono.start();
+}
+
+void SnapshotBuffer::publish(const World *world){
+	back->capture(world, chrono.getMicros());
+
+	mutex.p();
+	RenderSnapshot *published= back;
+	back= ready;
+	ready= published;
+	fresh= true;
+	mutex.v();
+}
+
+void SnapshotBuffer::acquire(){
+	mutex.p();
+	if(fresh){
+		RenderSnapshot *oldPrevious= previous;
+		previous= current;
+		current= ready;
+		ready= oldPrevious;
+		fresh= false;
+	}
+	mutex.v();
+}
+
+//returns the blend factor between the previous and the current snapshot
+float SnapshotBuffer::computeInterpolation() const{
+	if(previous->getFrame()<0 || current->getFrame()<=previous->getFrame()){
+		return 1.f;
+	}
+
+	//use the real publish interval, not the nominal one, so fast speed and catch-up 
+	//bursts do not overshoot
+	int64 interval= current->getStamp() - previous->getStamp();
+	int64 maxInterval= 1000000/GameConstants::updateFps;
+	if(interval<=0 || interval>maxInterval){
+		interval= maxInterval;
+	}
+	float t= static_cast<float>(chrono.getMicros() - current->getStamp()) / interval;
+	return clamp(t, 0.f, 1.f);
+}
+
+// =====================================================
+// 	class SnapshotInterpolator
+// =====================================================
+
+SnapshotInterpolator::SnapshotInterpolator(const SnapshotBuffer *buffer){
+	previous= buffer->getPrevious();
+	current= buffer->getCurrent();
+	t= buffer->computeInterpolation();
+}
+
+//us must belong to the current snapshot
+void SnapshotInterpolator::interpolate(const UnitSnapshot *us, UnitSnapshot &unit) const{
+	unit= *us;
+	if(t>=1.f){
+		return;
+	}
+	
+	const UnitSnapshot *ps= previous->findUnit(us->factionIndex, us->id);
+	if(ps!=NULL){
+		unit.vector= ps->vector.lerp(t, us->vector);
+		unit.rotation= lerpAngle(t, ps->rotation, us->rotation);
+		unit.verticalRotation= ps->verticalRotation + t*(us->verticalRotation-ps->verticalRotation);
+
+		//animations restart when they loop or the skill changes, never blend across that
+		if(ps->skillClass==us->skillClass && ps->animProgress<=us->animProgress){
+			unit.animProgress= ps->animProgress + t*(us->animProgress-ps->animProgress);
+		}
+	}
+}
+
+// ==================== PRIVATE ==================== 
+
+float SnapshotInterpolator::lerpAngle(float t, float a, float b){
+	float diff= b-a;
+	if(diff>180.f){
+		diff-= 360.f;
+	}
+	else if(diff<-180.f){
+		diff+= 360.f;
+	}
+	return a + t*diff;
+}
+
+}}//end namespace
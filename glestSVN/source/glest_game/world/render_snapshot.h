@@ -0,0 +1,175 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#ifndef _GLEST_GAME_RENDERSNAPSHOT_H_
+#define _GLEST_GAME_RENDERSNAPSHOT_H_
+
+#include <vector>
+
+#include "vec.h"
+#include "model.h"
+#include "skill_type.h"
+#include "thread.h"
+#include "platform_util.h"
+
+using std::vector;
+
+namespace Glest{ namespace Game{
+
+using Shared::Graphics::Vec2i;
+using Shared::Graphics::Vec3f;
+using Shared::Graphics::Model;
+using Shared::Platform::Mutex;
+using Shared::Platform::Chrono;
+using Shared::Platform::int64;
+
+class World;
+
+// =====================================================
+// 	class UnitSnapshot
+//
+///	Immutable render state of one unit at the end of a world update
+// =====================================================
+
+class UnitSnapshot{
+public:
+	int id;
+	int factionIndex;
+	const Model *model;
+	Vec2i pos;
+	Vec3f vector;			//flat render vector
+	float rotation;			//in degrees
+	float verticalRotation;	//in degrees
+	float animProgress;		//between 0 and 1
+	SkillClass skillClass;
+	bool alive;
+	bool fade;				//die skill fades the model out
+	bool visible;			//visible for this team when captured
+	bool staticShadow;		//standing building, its shadow can be cached
+};
+
+// =====================================================
+// 	class RenderSnapshot
+//
+///	The render state of all units for one world frame,
+/// indexed by map sector
+// =====================================================
+
+class RenderSnapshot{
+public:
+	static const int sectorSize= 8;	//in cells
+
+public:
+	typedef vector<UnitSnapshot> Units;
+
+private:
+	int frame;
+	int64 stamp;	//micros since the buffer was created
+	Units units;
+
+	//units of each sector, sectorStarts has one more entry than sectors
+	int sectorW;
+	int sectorH;
+	vector<int> sectorStarts;
+	vector<int> sectorUnits;
+
+public:
+	RenderSnapshot();
+
+	int getFrame() const						{return frame;}
+	int64 getStamp() const						{return stamp;}
+	int getUnitCount() const					{return units.size();}
+	const UnitSnapshot *getUnit(int i) const	{return &units[i];}
+	
+	//sectors
+	int getSectorW() const								{return sectorW;}
+	int getSectorH() const								{return sectorH;}
+	int getSectorBegin(int sx, int sy) const			{return sectorStarts[sy*sectorW+sx];}
+	int getSectorEnd(int sx, int sy) const				{return sectorStarts[sy*sectorW+sx+1];}
+	const UnitSnapshot *getSectorUnit(int i) const		{return &units[sectorUnits[i]];}
+
+	const UnitSnapshot *findUnit(int factionIndex, int id) const;
+	void capture(const World *world, int64 stamp);
+	void clear();
+
+private:
+	void buildSectors(int mapW, int mapH);
+};
+
+// =====================================================
+// 	class SnapshotBuffer
+//
+///	Hands render snapshots from the simulation to the renderer.
+/// The writer fills its own back snapshot and publishes it with a
+/// pointer swap, the reader keeps the last two published snapshots
+/// to interpolate between them, so neither side copies unit data
+/// or waits for the other beyond the swap itself.
+// =====================================================
+
+class SnapshotBuffer{
+private:
+	RenderSnapshot snapshots[4];
+
+	RenderSnapshot *back;		//being written by the simulation
+	RenderSnapshot *ready;		//published, not yet acquired
+	RenderSnapshot *previous;	//interpolation source
+	RenderSnapshot *current;	//interpolation target
+
+	bool fresh;
+	Chrono chrono;
+	Mutex mutex;
+
+private:
+	SnapshotBuffer(SnapshotBuffer&);
+	void operator=(SnapshotBuffer&);
+
+public:
+	SnapshotBuffer();
+
+	void init();
+
+	//writer side
+	void publish(const World *world);
+
+	//reader side
+	void acquire();
+	const RenderSnapshot *getPrevious() const	{return previous;}
+	const RenderSnapshot *getCurrent() const	{return current;}
+	float computeInterpolation() const;
+};
+
+// =====================================================
+// 	class SnapshotInterpolator
+//
+///	Blends units of the current snapshot with their state
+/// in the previous snapshot
+// =====================================================
+
+class SnapshotInterpolator{
+private:
+	const RenderSnapshot *previous;
+	const RenderSnapshot *current;
+	float t;
+
+public:
+	SnapshotInterpolator(const SnapshotBuffer *buffer);
+
+	const RenderSnapshot *getCurrent() const	{return current;}
+	void interpolate(const UnitSnapshot *us, UnitSnapshot &unit) const;
+
+private:
+	static float lerpAngle(float t, float a, float b);
+};
+
+}}//end namespace
+
+#endif
@@ -0,0 +1,153 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#include "resource_index.h"
+
+#include <cassert>
+#include <cstdlib>
+
+#include "map.h"
+#include "tech_tree.h"
+#include "resource.h"
+#include "leak_dumper.h"
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class ResourceIndex
+// =====================================================
+
+ResourceIndex::ResourceIndex(){
+	map= NULL;
+	bucketW= 0;
+	bucketH= 0;
+}
+
+//indexes the resources placed on the map, must be called after loading it
+void ResourceIndex::init(const Map *map, const TechTree *techTree){
+	this->map= map;
+	bucketW= (map->getSurfaceW()+bucketSize-1)/bucketSize;
+	bucketH= (map->getSurfaceH()+bucketSize-1)/bucketSize;
+
+	resourceTypes.clear();
+	for(int i=0; i<techTree->getResourceTypeCount(); ++i){
+		resourceTypes.push_back(techTree->getResourceType(i));
+	}
+
+	buckets.clear();
+	buckets.resize(resourceTypes.size(), Buckets(bucketW*bucketH));
+	for(int j=0; j<map->getSurfaceH(); ++j){
+		for(int i=0; i<map->getSurfaceW(); ++i){
+			Resource *r= map->getSurfaceCell(i, j)->getResource();
+			if(r!=NULL){
+				Vec2i sPos(i, j);
+				buckets[getResourceTypeIndex(r->getType())][getBucketIndex(sPos)].push_back(sPos);
+			}
+		}
+	}
+}
+
+//removes a depleted resource
+void ResourceIndex::remove(const Vec2i &sPos, const ResourceType *rt){
+	SurfacePositions &positions= buckets[getResourceTypeIndex(rt)][getBucketIndex(sPos)];
+	for(SurfacePositions::iterator it= positions.begin(); it!=positions.end(); ++it){
+		if(*it==sPos){
+			positions.erase(it);
+			return;
+		}
+	}
+	assert(false);
+}
+
+//finds the cell with a resource nearest to pos, searching rings of buckets outwards
+//radius limits the search to a square around pos, teamIndex to cells explored by the team
+bool ResourceIndex::findNearest(const ResourceType *rt, const Vec2i &pos, int radius, int teamIndex, Vec2i &resultPos) const{
+	const Buckets &typeBuckets= buckets[getResourceTypeIndex(rt)];
+	const int bucketCells= bucketSize*Map::cellScale;
+	Vec2i centerBucket= Map::toSurfCoords(pos)/bucketSize;
+
+	int maxRing= bucketW>bucketH? bucketW: bucketH;
+	if(radius!=noRadius){
+		int radiusRing= radius/bucketCells+1;
+		if(radiusRing<maxRing){
+			maxRing= radiusRing;
+		}
+	}
+
+	int nearestDist= -1;
+	for(int ring= 0; ring<=maxRing; ++ring){
+
+		//buckets in this ring and farther are at least this far
+		if(nearestDist>=0 && ring>0){
+			int minDist= (ring-1)*bucketCells;
+			if(minDist*minDist>nearestDist){
+				break;
+			}
+		}
+
+		for(int by= centerBucket.y-ring; by<=centerBucket.y+ring; ++by){
+			for(int bx= centerBucket.x-ring; bx<=centerBucket.x+ring; ++bx){
+
+				//only the border of the ring
+				if(bx<0 || by<0 || bx>=bucketW || by>=bucketH){
+					continue;
+				}
+				if(by!=centerBucket.y-ring && by!=centerBucket.y+ring && bx!=centerBucket.x-ring && bx!=centerBucket.x+ring){
+					continue;
+				}
+
+				const SurfacePositions &positions= typeBuckets[by*bucketW+bx];
+				for(int i=0; i<positions.size(); ++i){
+					const Vec2i &sPos= positions[i];
+					if(teamIndex!=noTeam && !map->getSurfaceCell(sPos)->isExplored(teamIndex)){
+						continue;
+					}
+
+					//nearest cell of the surface cell
+					Vec2i cellPos= Map::toUnitCoords(sPos);
+					Vec2i nearestPos(
+						pos.x<cellPos.x? cellPos.x: (pos.x>=cellPos.x+Map::cellScale? cellPos.x+Map::cellScale-1: pos.x),
+						pos.y<cellPos.y? cellPos.y: (pos.y>=cellPos.y+Map::cellScale? cellPos.y+Map::cellScale-1: pos.y));
+					Vec2i diff= nearestPos-pos;
+
+					if(radius!=noRadius && (abs(diff.x)>radius || abs(diff.y)>radius)){
+						continue;
+					}
+					int dist= diff.x*diff.x+diff.y*diff.y;
+					if(nearestDist<0 || dist<nearestDist){
+						nearestDist= dist;
+						resultPos= nearestPos;
+					}
+				}
+			}
+		}
+	}
+	return nearestDist>=0;
+}
+
+// ==================== PRIVATE ==================== 
+
+int ResourceIndex::getResourceTypeIndex(const ResourceType *rt) const{
+	for(int i=0; i<resourceTypes.size(); ++i){
+		if(resourceTypes[i]==rt){
+			return i;
+		}
+	}
+	assert(false);
+	return 0;
+}
+
+int ResourceIndex::getBucketIndex(const Vec2i &sPos) const{
+	return (sPos.y/bucketSize)*bucketW + sPos.x/bucketSize;
+}
+
+}}//end namespace
@@ -0,0 +1,68 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#ifndef _GLEST_GAME_RESOURCEINDEX_H_
+#define _GLEST_GAME_RESOURCEINDEX_H_
+
+#include <vector>
+
+#include "vec.h"
+
+using std::vector;
+using Shared::Graphics::Vec2i;
+
+namespace Glest{ namespace Game{
+
+class Map;
+class TechTree;
+class ResourceType;
+
+// =====================================================
+// 	class ResourceIndex
+//
+///	Resource cells of each type, bucketed by map area,
+/// to find the nearest resource without scanning the map
+// =====================================================
+
+class ResourceIndex{
+public:
+	static const int bucketSize= 8;	//in surface cells
+	static const int noTeam= -1;
+	static const int noRadius= -1;
+
+private:
+	typedef vector<Vec2i> SurfacePositions;
+	typedef vector<SurfacePositions> Buckets;
+	typedef vector<const ResourceType*> ResourceTypes;
+
+private:
+	const Map *map;
+	ResourceTypes resourceTypes;
+	vector<Buckets> buckets;	//by resource type, then bucket
+	int bucketW;
+	int bucketH;
+
+public:
+	ResourceIndex();
+	void init(const Map *map, const TechTree *techTree);
+
+	void remove(const Vec2i &sPos, const ResourceType *rt);
+	bool findNearest(const ResourceType *rt, const Vec2i &pos, int radius, int teamIndex, Vec2i &resultPos) const;
+
+private:
+	int getResourceTypeIndex(const ResourceType *rt) const;
+	int getBucketIndex(const Vec2i &sPos) const;
+};
+
+}}//end namespace
+
+#endif
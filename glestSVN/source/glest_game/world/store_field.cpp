@@ -0,0 +1,163 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#include "store_field.h"
+
+#include <cassert>
+
+#include "map.h"
+#include "unit.h"
+#include "faction.h"
+#include "leak_dumper.h"
+
+namespace Glest{ namespace Game{
+
+// =====================================================
+// 	class StoreField
+// =====================================================
+
+StoreField::StoreField(){
+	map= NULL;
+	faction= NULL;
+	resourceType= NULL;
+	storeVersion= -1;
+	buildingVersion= -1;
+}
+
+void StoreField::init(const Map *map, const Faction *faction, const ResourceType *resourceType){
+	this->map= map;
+	this->faction= faction;
+	this->resourceType= resourceType;
+	storeVersion= -1;
+	buildingVersion= -1;
+}
+
+//returns the store nearest to pos by walking distance, NULL if none can be reached
+Unit *StoreField::getStore(const Vec2i &pos){
+	update();
+
+	int i= pos.y*map->getW()+pos.x;
+	if(distances[i]==unreachable){
+		return NULL;
+	}
+	return stores[storeIndices[i]];
+}
+
+//returns the next cell towards the nearest store, false if arrived or blocked
+bool StoreField::getNextPos(const Unit *unit, Vec2i &nextPos){
+	update();
+
+	const Vec2i &pos= unit->getPos();
+	int w= map->getW();
+	int distance= distances[pos.y*w+pos.x];
+	if(distance==unreachable || distance==0){
+		return false;
+	}
+
+	for(int i=-1; i<=1; ++i){
+		for(int j=-1; j<=1; ++j){
+			Vec2i currPos= pos + Vec2i(i, j);
+			if(map->isInside(currPos) && distances[currPos.y*w+currPos.x]==distance-1 &&
+				(i==0 || j==0 || (distances[pos.y*w+currPos.x]!=unreachable && distances[currPos.y*w+pos.x]!=unreachable)))
+			{
+				if(map->canMove(unit, pos, currPos)){
+					nextPos= currPos;
+					return true;
+				}
+			}
+		}
+	}
+	return false;
+}
+
+// ==================== PRIVATE ==================== 
+
+//recomputes the field if stores or buildings changed since the last time
+void StoreField::update(){
+	if(storeVersion!=faction->getStoreVersion() || buildingVersion!=map->getBuildingVersion()){
+		storeVersion= faction->getStoreVersion();
+		buildingVersion= map->getBuildingVersion();
+		compute();
+	}
+}
+
+void StoreField::compute(){
+	int w= map->getW();
+	int h= map->getH();
+
+	distances.assign(w*h, unreachable);
+	storeIndices.resize(w*h);
+	openCells.resize(w*h);
+	stores.clear();
+
+	int openBegin= 0;
+	int openEnd= 0;
+
+	//cells next to the stores are the sources
+	for(int i=0; i<faction->getUnitCount(); ++i){
+		Unit *unit= faction->getUnit(i);
+		if(unit->isOperative() && unit->getType()->getStore(resourceType)>0){
+			unsigned short storeIndex= stores.size();
+			stores.push_back(unit);
+
+			const Vec2i &pos= unit->getPos();
+			int size= unit->getType()->getSize();
+			for(int x=pos.x-1; x<=pos.x+size; ++x){
+				for(int y=pos.y-1; y<=pos.y+size; ++y){
+					if(map->isInside(x, y) && distances[y*w+x]==unreachable && isWalkable(x, y) && map->isNextTo(Vec2i(x, y), unit)){
+						distances[y*w+x]= 0;
+						storeIndices[y*w+x]= storeIndex;
+						openCells[openEnd++]= y*w+x;
+					}
+				}
+			}
+		}
+	}
+
+	//breadth first search, diagonal steps cost the same as straight ones
+	//but can't cut corners, as in the path finder
+	while(openBegin<openEnd){
+		int cell= openCells[openBegin++];
+		int x= cell%w;
+		int y= cell/w;
+		unsigned short distance= distances[cell]+1;
+		if(distance==unreachable){
+			continue;
+		}
+
+		for(int i=-1; i<=1; ++i){
+			for(int j=-1; j<=1; ++j){
+				int nx= x+i;
+				int ny= y+j;
+				if(map->isInside(nx, ny) && distances[ny*w+nx]==unreachable && isWalkable(nx, ny) &&
+					(i==0 || j==0 || (isWalkable(nx, y) && isWalkable(x, ny))))
+				{
+					distances[ny*w+nx]= distance;
+					storeIndices[ny*w+nx]= storeIndices[cell];
+					openCells[openEnd++]= ny*w+nx;
+				}
+			}
+		}
+	}
+}
+
+//cells blocked by terrain, objects or buildings, mobile units will move away
+bool StoreField::isWalkable(int x, int y) const{
+	Cell *cell= map->getCell(x, y);
+	if(!map->getSurfaceCell(Map::toSurfCoords(Vec2i(x, y)))->isFree() || map->getDeepSubmerged(cell)){
+		return false;
+	}
+	Unit *unit= cell->getUnit(fLand);
+	return unit==NULL || unit->getType()->hasSkillClass(scMove);
+}
+
+}}//end namespace
@@ -0,0 +1,76 @@
+// ==============================================================
+//	This file is part of Glest (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#ifndef _GLEST_GAME_STOREFIELD_H_
+#define _GLEST_GAME_STOREFIELD_H_
+
+#include <vector>
+
+#include "vec.h"
+
+using std::vector;
+using Shared::Graphics::Vec2i;
+
+namespace Glest{ namespace Game{
+
+class Map;
+class Unit;
+class Faction;
+class ResourceType;
+
+// =====================================================
+// 	class StoreField
+//
+///	Walking distance from each cell to the nearest store 
+/// of a faction that accepts a resource type, so loaded 
+/// harvesters find their store and next step in O(1). 
+/// Built with a breadth first search from all the stores,
+/// only mobile units are ignored as obstacles
+// =====================================================
+
+class StoreField{
+public:
+	static const int unreachable= 0xFFFF;
+
+private:
+	typedef vector<Unit*> Stores;
+
+private:
+	const Map *map;
+	const Faction *faction;
+	const ResourceType *resourceType;
+
+	vector<unsigned short> distances;	//steps to the nearest store
+	vector<unsigned short> storeIndices;	//nearest store, index in stores
+	vector<int> openCells;
+	Stores stores;
+
+	//versions the field was computed for, -1 if never
+	int storeVersion;
+	int buildingVersion;
+
+public:
+	StoreField();
+	void init(const Map *map, const Faction *faction, const ResourceType *resourceType);
+
+	Unit *getStore(const Vec2i &pos);
+	bool getNextPos(const Unit *unit, Vec2i &nextPos);
+
+private:
+	void update();
+	void compute();
+	bool isWalkable(int x, int y) const;
+};
+
+}}//end namespace
+
+#endif
@@ -366,7 +366,7 @@ void UnitUpdater::updateHarvest(Unit *unit){
 			Resource *r= map->getSurfaceCell(Map::toSurfCoords(command->getPos()))->getResource();
 			if(r!=NULL && hct->canHarvest(r->getType())){
 				//if can harvest dest. pos
-				if(unit->getPos().dist(command->getPos())<harvestDistance && 
+				if(unit->getPos().sqDist(command->getPos())<harvestDistance*harvestDistance && 
 					map->isResourceNear(unit->getPos(), r->getType(), targetPos)) {
 						//if it finds resources it starts harvesting
 						unit->setCurrSkill(hct->getHarvestSkillType());
@@ -394,15 +394,33 @@ void UnitUpdater::updateHarvest(Unit *unit){
 			}
 		}
 		else{
-			//if loaded, return to store
-			Unit *store= world->nearestStore(unit->getPos(), unit->getFaction()->getIndex(), unit->getLoadType());                                        
+			//if loaded, return to store, small land units follow the store field
+			StoreField *storeField= NULL;
+			Unit *store= NULL;
+			if(unit->getType()->getSize()==1 && unit->getCurrField()==fLand){
+				storeField= world->getStoreField(unit->getFaction()->getIndex(), unit->getLoadType());
+				store= storeField->getStore(unit->getPos());
+			}
+			if(store==NULL){
+				storeField= NULL;
+				store= world->nearestStore(unit->getPos(), unit->getFaction()->getIndex(), unit->getLoadType());
+			}
 			if(store!=NULL){
-				switch(pathFinder.findPath(unit, store->getCenteredPos())){
-				case PathFinder::tsOnTheWay:
+				Vec2i nextPos;
+				if(storeField!=NULL && storeField->getNextPos(unit, nextPos)){
+					unit->getPath()->clear();
+					unit->setTargetPos(nextPos);
 					unit->setCurrSkill(hct->getMoveLoadedSkillType());
-					break;
-				default:
-					break;
+				}
+				else if(!map->isNextTo(unit->getPos(), store)){
+					//blocked by other units, or no field for this unit
+					switch(pathFinder.findPath(unit, store->getCenteredPos())){
+					case PathFinder::tsOnTheWay:
+						unit->setCurrSkill(hct->getMoveLoadedSkillType());
+						break;
+					default:
+						break;
+					}
 				}
 	        
 				//world->changePosCells(unit,unit->getPos()+unit->getDest());
@@ -441,7 +459,7 @@ void UnitUpdater::updateHarvest(Unit *unit){
 				
 				//if resource exausted, then delete it and stop
 				if(r->decAmount(1)){
-					sc->deleteResource();
+					map->deleteResource(unit->getTargetPos());
 					unit->setCurrSkill(hct->getStopLoadedSkillType());
 				}
 
@@ -721,23 +739,28 @@ void UnitUpdater::startAttackParticleSystem(Unit *unit){
 bool UnitUpdater::searchForResource(Unit *unit, const HarvestCommandType *hct){
     
     Vec2i pos= unit->getCurrCommand()->getPos();
-
-    for(int radius= 0; radius<maxResSearchRadius; radius++){
-        for(int i=pos.x-radius; i<=pos.x+radius; ++i){
-            for(int j=pos.y-radius; j<=pos.y+radius; ++j){
-				if(map->isInside(i, j)){
-					Resource *r= map->getSurfaceCell(Map::toSurfCoords(Vec2i(i, j)))->getResource();
-                    if(r!=NULL){
-						if(hct->canHarvest(r->getType())){
-							unit->getCurrCommand()->setPos(Vec2i(i, j));
-							return true;
-                        }
-                    }
-                }
-            }
-        }
-    }
-    return false;
+	const ResourceIndex *resourceIndex= map->getResourceIndex();
+
+	//nearest resource of any type the unit can harvest
+	bool found= false;
+	int nearestDist= 0;
+	Vec2i nearestPos;
+	for(int i=0; i<hct->getHarvestedResourceCount(); ++i){
+		Vec2i resourcePos;
+		if(resourceIndex->findNearest(hct->getHarvestedResource(i), pos, maxResSearchRadius-1, ResourceIndex::noTeam, resourcePos)){
+			Vec2i diff= resourcePos-pos;
+			int dist= diff.x*diff.x+diff.y*diff.y;
+			if(!found || dist<nearestDist){
+				found= true;
+				nearestDist= dist;
+				nearestPos= resourcePos;
+			}
+		}
+	}
+	if(found){
+		unit->getCurrCommand()->setPos(nearestPos);
+	}
+    return found;
 }
 
 bool UnitUpdater::attackerOnSight(const Unit *unit, Unit **rangedPtr){
@@ -774,12 +797,15 @@ bool UnitUpdater::unitOnRange(const Unit *unit, int range, Unit **rangedPtr, con
 	Vec2i center= unit->getPos();
 	Vec2f floatCenter= unit->getFloatCenteredPos();
 
+	//floor(dist)<=range+1 is dist<range+2, compared squared
+	float sqMaxDist= static_cast<float>((range+2)*(range+2));
+
 	//nearby cells
 	for(int i=center.x-range; i<center.x+range+size; ++i){
 		for(int j=center.y-range; j<center.y+range+size; ++j){
 			
 			//cells insede map and in range
-			if(map->isInside(i, j) && floor(floatCenter.dist(Vec2f(i, j))) <= (range+1)){
+			if(map->isInside(i, j) && floatCenter.sqDist(Vec2f(i, j)) < sqMaxDist){
 					
 				//all fields
 				for(int k=0; k<fieldCount; k++){
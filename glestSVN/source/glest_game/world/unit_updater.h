@@ -57,6 +57,7 @@ private:
 
 public:
     void init(Game *game);
+	const Random *getRandom() const	{return &random;}
 
 	//update skills
     void updateUnit(Unit *unit);
@@ -21,6 +21,7 @@
 #include "logger.h"
 #include "sound_renderer.h"
 #include "game_settings.h"
+#include "renderer.h"
 #include "leak_dumper.h"
 
 using namespace Shared::Graphics;
@@ -45,6 +46,7 @@ World::World(){
 
 	frameCount= 0;
 	nextUnitId= 0;
+	unitStateHash= 0;
 
 	scriptManager= NULL;
 }
@@ -69,6 +71,7 @@ void World::init(Game *game, bool createUnits){
 	initFactionTypes(game->getGameSettings());
 	initCells(); //must be done after knowing faction number and dimensions
 	initMap();
+	initStoreFields();
 	initSplattedTextures();
 
 	//minimap must be init after sum computation
@@ -78,6 +81,10 @@ void World::init(Game *game, bool createUnits){
 	}
 	initExplorationState();
 	computeFow();
+
+	//first snapshot, so the first frame has units to render
+	snapshotBuffer.init();
+	snapshotBuffer.publish(this);
 }
 
 //load tileset
@@ -109,16 +116,23 @@ void World::update(){
 
 	++frameCount;
 
+	//units move, die and rot, and resources run out
+	map.invalidateOccupancy();
+
 	//time
 	timeFlow.update();
 
 	//water effects
 	waterEffects.update();
 
-	//units
+	//units, the state hash is kept up to date as they change
 	for(int i=0; i<getFactionCount(); ++i){
 		for(int j=0; j<getFaction(i)->getUnitCount(); ++j){
-			unitUpdater.updateUnit(getFaction(i)->getUnit(j));
+			Unit *unit= getFaction(i)->getUnit(j);
+			unitStateHash^= unit->getStateHash();
+			unitUpdater.updateUnit(unit);
+			unit->updateStateHash();
+			unitStateHash^= unit->getStateHash();
 		}
 	}
 
@@ -127,6 +141,7 @@ void World::update(){
 		for(int j=0; j<getFaction(i)->getUnitCount(); ++j){
 			Unit *unit= getFaction(i)->getUnit(j);
 			if(unit->getToBeUndertaken()){
+				unitStateHash^= unit->getStateHash();
 				unit->undertake();
 				delete unit;
 				j--;
@@ -155,6 +170,9 @@ void World::update(){
 		computeFow();
 		tick();
 	}
+
+	//publish the units of this frame to the renderer
+	snapshotBuffer.publish(this);
 }
 
 void World::tick(){
@@ -177,39 +195,32 @@ void World::tick(){
 		for(int i=0; i<techTree.getResourceTypeCount(); ++i){
 			const ResourceType *rt= techTree.getResourceType(i);
 			
-			//if consumable
+			//if consumable, operative units consume it
 			if(rt->getClass()==rcConsumable){
-				int balance= 0;
-				for(int j=0; j<faction->getUnitCount(); ++j){
-					
-					//if unit operative and has this cost
-					const Unit *u=  faction->getUnit(j);
-					if(u->isOperative()){
-						const Resource *r= u->getType()->getCost(rt);
-						if(r!=NULL){
-							balance-= u->getType()->getCost(rt)->getAmount();
-						}
-					}
-				}
-				faction->setResourceBalance(rt, balance);
+				faction->setResourceBalance(rt, -faction->getUpkeep(rt));
 			}
 		}
 	}
 }
 
-Unit* World::findUnitById(int id){
-	for(int i= 0; i<getFactionCount(); ++i){
-		Faction* faction= getFaction(i);
-		
-		for(int j= 0; j<faction->getUnitCount(); ++j){
-			Unit* unit= faction->getUnit(j);
-			
-			if(unit->getId()==id){
-				return unit;
-			}
+//unit hashes are maintained incrementally, only the few remaining values are added here
+int World::getStateHash() const{
+	Checksum checksum;
+
+	checksum.addInt(frameCount);
+	checksum.addInt(unitStateHash);
+	checksum.addInt(unitUpdater.getRandom()->getLastNumber());
+	for(int i=0; i<getFactionCount(); ++i){
+		const Faction *faction= getFaction(i);
+		for(int j=0; j<techTree.getResourceTypeCount(); ++j){
+			checksum.addInt(faction->getResource(j)->getAmount());
 		}
 	}
-	return NULL;
+	return checksum.getSum();
+}
+
+Unit* World::findUnitById(int id){
+	return unitIndex.find(id);
 }
 
 const UnitType* World::findUnitTypeById(const FactionType* factionType, int id){
@@ -274,13 +285,13 @@ void World::moveUnitCells(Unit *unit){
 
 //returns the nearest unit that can store a type of resource given a position and a faction
 Unit *World::nearestStore(const Vec2i &pos, int factionIndex, const ResourceType *rt){
-    float currDist= infinity;
+    int currDist= -1;
     Unit *currUnit= NULL;
 
     for(int i=0; i<getFaction(factionIndex)->getUnitCount(); ++i){
 		Unit *u= getFaction(factionIndex)->getUnit(i);
-		float tmpDist= u->getPos().dist(pos);
-        if(tmpDist<currDist && u->getType()->getStore(rt)>0 && u->isOperative()){
+		int tmpDist= u->getPos().sqDist(pos);
+        if((currDist==-1 || tmpDist<currDist) && u->getType()->getStore(rt)>0 && u->isOperative()){
             currDist= tmpDist;
             currUnit= u;
         }
@@ -288,6 +299,16 @@ Unit *World::nearestStore(const Vec2i &pos, int factionIndex, const ResourceType
     return currUnit;
 }
 
+StoreField *World::getStoreField(int factionIndex, const ResourceType *rt){
+	for(int i=0; i<techTree.getResourceTypeCount(); ++i){
+		if(techTree.getResourceType(i)==rt){
+			return &storeFields[factionIndex*techTree.getResourceTypeCount()+i];
+		}
+	}
+	assert(false);
+	return NULL;
+}
+
 bool World::toRenderUnit(const Unit *unit, const Quad2i &visibleQuad) const{
     //a unit is rendered if it is in a visible cell or is attacking a unit in a visible cell
     return 
@@ -436,16 +457,7 @@ int World::getUnitFactionIndex(int unitId){
 
 int World::getUnitCount(int factionIndex){
 	if(factionIndex<factions.size()){
-		Faction* faction= &factions[factionIndex];
-		int count= 0;
-		
-		for(int i= 0; i<faction->getUnitCount(); ++i){
-			const Unit* unit= faction->getUnit(i);
-			if(unit->isAlive()){
-				++count;
-			}
-		}
-		return count;
+		return factions[factionIndex].getAliveUnitCount();
 	}
 	else
 	{
@@ -455,16 +467,16 @@ int World::getUnitCount(int factionIndex){
 
 int World::getUnitCountOfType(int factionIndex, const string &typeName){
 	if(factionIndex<factions.size()){
-		Faction* faction= &factions[factionIndex];
-		int count= 0;
+		const Faction* faction= &factions[factionIndex];
+		const FactionType* factionType= faction->getType();
 		
-		for(int i= 0; i< faction->getUnitCount(); ++i){
-			const Unit* unit= faction->getUnit(i);
-			if(unit->isAlive() && unit->getType()->getName()==typeName){
-				++count;
+		for(int i= 0; i<factionType->getUnitTypeCount(); ++i){
+			const UnitType* unitType= factionType->getUnitType(i);
+			if(unitType->getName()==typeName){
+				return faction->getAliveUnitCount(unitType);
 			}
 		}
-		return count;
+		return 0;
 	}
 	else
 	{
@@ -485,7 +497,7 @@ void World::initCells(){
                
 			SurfaceCell *sc= map.getSurfaceCell(i, j);
 
-			sc->setFowTexCoord(Vec2f(
+			map.getSurfaceCellRender(i, j)->setFowTexCoord(Vec2f(
 				i/(next2Power(map.getSurfaceW())-1.f), 
 				j/(next2Power(map.getSurfaceH())-1.f)));  
 
@@ -513,8 +525,9 @@ void World::initSplattedTextures(){
 				sc01->getSurfaceType(),
 				sc11->getSurfaceType(),
 				coord, texture);
-			sc00->setSurfTexCoord(coord);
-			sc00->setSurfaceTexture(texture);
+			SurfaceCellRender *scr00= map.getSurfaceCellRender(i, j);
+			scr00->setSurfTexCoord(coord);
+			scr00->setSurfaceTexture(texture);
 		}
 	}
 }
@@ -537,7 +550,7 @@ void World::initFactionTypes(GameSettings *gs){
 		const FactionType *ft= techTree.getType(gs->getFactionTypeName(i));
 		factions[i].init(
 			ft, gs->getFactionControl(i), &techTree, i, gs->getTeam(i), 
-			gs->getStartLocationIndex(i), i==thisFactionIndex, gs->getDefaultResources());
+			gs->getStartLocationIndex(i), i==thisFactionIndex, gs->getDefaultResources(), &unitIndex);
 
 		stats.setTeam(i, gs->getTeam(i));
 		stats.setFactionTypeName(i, formatString(gs->getFactionTypeName(i)));
@@ -589,6 +602,17 @@ void World::initMap(){
 	map.init();
 }
 
+//store fields are computed when a harvester first needs them
+void World::initStoreFields(){
+	int resourceTypeCount= techTree.getResourceTypeCount();
+	storeFields.resize(factions.size()*resourceTypeCount);
+	for(int i=0; i<factions.size(); ++i){
+		for(int j=0; j<resourceTypeCount; ++j){
+			storeFields[i*resourceTypeCount+j].init(&map, &factions[i], techTree.getResourceType(j));
+		}
+	}
+}
+
 void World::initExplorationState(){
 	if(!fogOfWar){
 		for(int i=0; i<map.getSurfaceW(); ++i){
@@ -607,6 +631,9 @@ void World::exploreCells(const Vec2i &newPos, int sightRange, int teamIndex){
     
 	Vec2i newSurfPos= Map::toSurfCoords(newPos);
 	int surfSightRange= sightRange/Map::cellScale+1;
+	int exploreRange= surfSightRange+indirectSightRange+1;
+	int sqExploreRange= exploreRange*exploreRange;
+	int sqSurfSightRange= surfSightRange*surfSightRange;
 
 	//explore
     for(int i=-surfSightRange-indirectSightRange-1; i<=surfSightRange+indirectSightRange+1; ++i){
@@ -618,12 +645,13 @@ void World::exploreCells(const Vec2i &newPos, int sightRange, int teamIndex){
 				SurfaceCell *sc= map.getSurfaceCell(currPos);
 				
 				//explore
-				if(Vec2i(0).dist(currRelPos) < surfSightRange+indirectSightRange+1){
+				int sqDist= currRelPos.x*currRelPos.x + currRelPos.y*currRelPos.y;
+				if(sqDist < sqExploreRange){
                     sc->setExplored(teamIndex, true);
 				}
                 
 				//visible
-				if(Vec2i(0).dist(currRelPos) < surfSightRange){
+				if(sqDist < sqSurfSightRange){
 					sc->setVisible(teamIndex, true);
 				}
             }         
@@ -637,14 +665,16 @@ void World::computeFow(){
 	//reset texture
 	minimap.resetFowTex();
 
-	//reset cells
-	for(int i=0; i<map.getSurfaceW(); ++i){
-		for(int j=0; j<map.getSurfaceH(); ++j){
-			for(int k=0; k<GameConstants::maxPlayers; ++k){
-				if(fogOfWar || k!=thisTeamIndex){
-					map.getSurfaceCell(i, j)->setVisible(k, false);
-				}
-			}
+	//reset cells, all the teams at once
+	int teamMask= 0;
+	for(int k=0; k<GameConstants::maxPlayers; ++k){
+		if(fogOfWar || k!=thisTeamIndex){
+			teamMask|= 1<<k;
+		}
+	}
+	for(int j=0; j<map.getSurfaceH(); ++j){
+		for(int i=0; i<map.getSurfaceW(); ++i){
+			map.getSurfaceCell(i, j)->clearVisible(teamMask);
 		}
 	}
 	
@@ -668,7 +698,8 @@ void World::computeFow(){
 			//fire
 			ParticleSystem *fire= unit->getFire();
 			if(fire!=NULL){
-				fire->setActive(map.getSurfaceCell(Map::toSurfCoords(unit->getPos()))->isVisible(thisTeamIndex));
+				bool visible= map.getSurfaceCell(Map::toSurfCoords(unit->getPos()))->isVisible(thisTeamIndex);
+				Renderer::getInstance().setParticleSystemActive(fire, visible, rsGame);
 			}
 		}
 	}
@@ -30,6 +30,8 @@
 #include "unit_updater.h"
 #include "random.h"
 #include "game_constants.h"
+#include "render_snapshot.h"
+#include "store_field.h"
 
 namespace Glest{ namespace Game{
 
@@ -53,6 +55,7 @@ class ScriptManager;
 class World{
 private:
 	typedef vector<Faction> Factions;
+	typedef vector<StoreField> StoreFields;
 
 public:
 	static const int generationArea= 100;
@@ -73,15 +76,20 @@ private:
     Stats stats;	//BattleEnd will delete this object
 
 	Factions factions;
+	UnitIndex unitIndex;
+	StoreFields storeFields;	//by faction and resource type
 
 	Random random;
 
 	ScriptManager* scriptManager;
 
+	SnapshotBuffer snapshotBuffer;	//units published to the renderer
+
 	int thisFactionIndex;
 	int thisTeamIndex;
 	int frameCount;
 	int nextUnitId;
+	int unitStateHash;	//xor of the state hashes of all units
 
 	//config
 	bool fogOfWar;
@@ -113,6 +121,9 @@ public:
 	const WaterEffects *getWaterEffects() const		{return &waterEffects;}
 	int getNextUnitId()								{return nextUnitId++;}
 	int getFrameCount() const						{return frameCount;}
+	int getStateHash() const;
+	const SnapshotBuffer *getSnapshotBuffer() const	{return &snapshotBuffer;}
+	SnapshotBuffer *getSnapshotBuffer()				{return &snapshotBuffer;}
 
 	//init & load
 	void init(Game *game, bool createUnits);
@@ -130,6 +141,7 @@ public:
 	bool toRenderUnit(const Unit *unit, const Quad2i &visibleQuad) const;
 	bool toRenderUnit(const Unit *unit) const;
 	Unit *nearestStore(const Vec2i &pos, int factionIndex, const ResourceType *rt);
+	StoreField *getStoreField(int factionIndex, const ResourceType *rt);
 
 	//scripting interface
 	void createUnit(const string &unitName, int factionIndex, const Vec2i &pos);
@@ -152,6 +164,7 @@ private:
 	void initMinimap();
 	void initUnits();
 	void initMap();
+	void initStoreFields();
 	void initExplorationState();
 	
 	//misc
@@ -34,6 +34,7 @@ public:
 	void setWidth(int i, float width)	{widths[i]= width;}
 	void setHeight(float height)		{this->height= height;}
 
+	float getWidth(unsigned char c) const	{return widths[c];}
 	float getTextWidth(const string &str) const;
 	float getHeight() const;
 };
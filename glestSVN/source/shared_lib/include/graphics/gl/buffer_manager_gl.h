@@ -0,0 +1,72 @@
+// ==============================================================
+//	This file is part of Glest Shared Library (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#ifndef _SHARED_GRAPHICS_GL_BUFFERMANAGERGL_H_
+#define _SHARED_GRAPHICS_GL_BUFFERMANAGERGL_H_
+
+#include "opengl.h"
+#include "types.h"
+
+namespace Shared{ namespace Graphics{ namespace Gl{
+
+using Shared::Platform::int64;
+using Shared::Platform::uint32;
+
+// =====================================================
+//	class BufferManagerGl
+//
+///	Vertex and index buffers of models. Immutable data is
+/// uploaded once to static buffers, data that changes
+/// between draws goes through a ring buffer that is
+/// orphaned when it wraps
+// =====================================================
+
+class BufferManagerGl{
+public:
+	static const int streamBufferSize= 4*1024*1024;
+	static const int streamAlignment= 16;
+
+private:
+	static int64 uploadedBytes;
+
+	int supported;			//-1 until checked with a context
+	GLuint streamBuffer;
+	int streamOffset;
+	uint32 streamEpoch;		//changes every time old stream offsets become invalid
+
+private:
+	BufferManagerGl();
+
+public:
+	static BufferManagerGl &getInstance();
+
+	bool isSupported();
+	void end();
+
+	//static buffers, left bound to target
+	GLuint newBuffer(GLenum target, int size);
+	void writeBuffer(GLenum target, int offset, const void *data, int size);
+	void deleteBuffer(GLuint buffer);
+
+	//stream buffer, left bound to GL_ARRAY_BUFFER, returns -1 if size does not fit
+	int reserveStream(int size);
+	GLuint getStreamBuffer() const	{return streamBuffer;}
+	uint32 getStreamEpoch() const	{return streamEpoch;}
+
+	//stats
+	static int64 getUploadedBytes()	{return uploadedBytes;}
+	static void resetStats()		{uploadedBytes= 0;}
+};
+
+}}}//end namespace
+
+#endif
@@ -12,9 +12,16 @@
 #ifndef _SHARED_GRAPHICS_GL_FONTGL_H_
 #define _SHARED_GRAPHICS_GL_FONTGL_H_
 
+#include <vector>
+#include <map>
+
 #include "font.h"
+#include "vec.h"
 #include "opengl.h"
 
+using std::vector;
+using std::map;
+
 namespace Shared{ namespace Graphics{ namespace Gl{
 
 // =====================================================
@@ -29,16 +36,70 @@ public:
 	GLuint getHandle() const				{return handle;}
 };
 
+class Font2DGl;
+
+// =====================================================
+//	class TextLayout
+//
+///	Glyph quads of a string, in pixels from the start of their run.
+/// Tabs and new lines start runs, offset in the units of the 
+/// caller like the raster positions used to be
+// =====================================================
+
+class TextLayout{
+public:
+	struct Glyph{
+		Vec2f runPos;
+		Vec2f pos0;
+		Vec2f pos1;
+		Vec2f texCoord0;
+		Vec2f texCoord1;
+	};
+	typedef vector<Glyph> Glyphs;
+
+private:
+	Glyphs glyphs;
+	float width;
+
+public:
+	void init(const Font2DGl *font, const string &text);
+
+	const Glyphs &getGlyphs() const		{return glyphs;}
+	float getWidth() const				{return width;}
+};
+
 // =====================================================
 //	class Font2DGl
 //
-///	OpenGL bitmap font
+///	OpenGL font, glyphs are rasterized once into a texture
+/// atlas of charCount cells in rows of columnCount
 // =====================================================
 
 class Font2DGl: public Font2D, public FontGl{
+public:
+	static const int columnCount= 16;
+	static const int maxTextLayoutCount= 512;
+
+private:
+	typedef map<string, TextLayout> TextLayouts;
+
+private:
+	int cellW;
+	int cellH;
+	int baseline;		//cell rows below the baseline
+	int atlasW;
+	int atlasH;
+	mutable TextLayouts textLayouts;	//layouts of the strings drawn lately
+
 public:
 	virtual void init();
 	virtual void end();
+
+	int getCellW() const		{return cellW;}
+	int getCellH() const		{return cellH;}
+	int getBaseline() const		{return baseline;}
+	void getTexCoords(unsigned char c, Vec2f &texCoord0, Vec2f &texCoord1) const;
+	const TextLayout *getTextLayout(const string &text) const;
 };
 
 // =====================================================
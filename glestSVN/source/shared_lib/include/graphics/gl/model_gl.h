@@ -13,17 +13,60 @@
 #define _SHARED_GRAPHICS_GL_MODELGL_H_
 
 #include "model.h"
+#include "opengl.h"
 
 namespace Shared{ namespace Graphics{ namespace Gl{
 
+// =====================================================
+//	class MeshBuffersGl
+//
+///	GPU copy of a mesh. Tex coords and indices never
+/// change, single frame meshes also keep vertices and
+/// normals here, animated ones stream their poses
+// =====================================================
+
+class MeshBuffersGl{
+public:
+	static const int streamedPoseCount= 4;
+
+	class StreamedPose{
+	public:
+		uint32 poseId;
+		uint32 epoch;
+		int offset;
+	};
+
+public:
+	GLuint vertexBuffer;
+	GLuint indexBuffer;
+	bool staticVertices;
+	int normalOffset;
+	int texCoordOffset;
+
+	//recent poses already in the stream buffer
+	mutable StreamedPose streamedPoses[streamedPoseCount];
+	mutable int nextStreamedPose;
+
+public:
+	MeshBuffersGl();
+};
+
 // =====================================================
 //	class ModelGl
 // =====================================================
 
 class ModelGl: public Model{
+private:
+	MeshBuffersGl *meshBuffers;		//NULL when the model is not in GPU memory
+
 public:
-	virtual void init(){}
-	virtual void end(){}
+	ModelGl();
+	virtual ~ModelGl();
+
+	virtual void init();
+	virtual void end();
+
+	const MeshBuffersGl *getMeshBuffers(int i) const	{return meshBuffers==NULL? NULL: &meshBuffers[i];}
 };
 
 }}}//end namespace
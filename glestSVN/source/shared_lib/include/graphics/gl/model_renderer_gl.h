@@ -14,6 +14,7 @@
 
 #include "model_renderer.h"
 #include "model.h"
+#include "model_gl.h"
 #include "opengl.h"
 
 namespace Shared{ namespace Graphics{ namespace Gl{
@@ -41,8 +42,9 @@ public:
 
 private:
 	
-	void renderMesh(const Mesh *mesh);
+	void renderMesh(const Mesh *mesh, const MeshBuffersGl *buffers);
 	void renderMeshNormals(const Mesh *mesh);
+	int streamPose(const Mesh *mesh, const MeshBuffersGl *buffers);
 };
 
 }}}//end namespace
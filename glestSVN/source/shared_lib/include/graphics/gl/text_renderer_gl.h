@@ -12,8 +12,12 @@
 #ifndef _SHARED_GRAPHICS_GL_TEXTRENDERERGL_H_
 #define _SHARED_GRAPHICS_GL_TEXTRENDERERGL_H_
 
+#include <vector>
+
 #include "text_renderer.h"
 
+using std::vector;
+
 namespace Shared{ namespace Graphics{ namespace Gl{
 
 class Font2DGl;
@@ -24,9 +28,20 @@ class Font3DGl;
 // =====================================================
 
 class TextRenderer2DGl: public TextRenderer2D{
+private:
+	struct Vertex{
+		Vec2f pos;
+		Vec2f texCoord;
+		Vec4f color;
+	};
+	typedef vector<Vertex> Vertices;
+
 private:
 	const Font2DGl *font;
 	bool rendering;
+	Vertices vertices;	//glyph quads of all the texts between begin and end
+	float transform[16];	//projection times modelview, taken at begin
+	int viewport[4];
 
 public:
 	TextRenderer2DGl();
@@ -34,6 +49,10 @@ public:
 	virtual void begin(const Font2D *font);
 	virtual void render(const string &text, int x, int y, bool centered);
 	virtual void end();
+	virtual float getTextWidth(const Font2D *font, const string &text);
+
+private:
+	Vec2f toWindow(float x, float y) const;
 };
 
 // =====================================================
@@ -14,19 +14,56 @@
 
 #include "vec.h"
 #include "model.h"
+#include "types.h"
+
+using Shared::Platform::int64;
 
 namespace Shared{ namespace Graphics{
 
 // =====================================================
 //	class InterpolationData
+//
+///	Interpolated vertices and normals of an animated mesh.
+/// Recent poses are cached by frame pair and quantized time,
+/// so units sharing a model and an animation state share
+/// the interpolation work. Quantized meshes are decoded here
 // =====================================================
 
 class InterpolationData{
+public:
+	static const int maxPoses= 8;
+
+private:
+	class Pose{
+	public:
+		uint32 id;
+		uint32 prevFrame;
+		uint32 nextFrame;
+		float localT;
+		uint32 lastUse;
+		Vec3f *vertices;
+		Vec3f *normals;
+	};
+
 private:
+	static int poseSteps;
+	static bool normalize;
+	static uint32 configGeneration;		//changes with the config, cached poses of older generations are stale
+	static int64 poseHits;
+	static int64 poseMisses;
+	static int64 interpolatedVertices;
+	static uint32 lastPoseId;
+
 	const Mesh *mesh;
 
+	Pose poses[maxPoses];
+	int poseCount;
+	uint32 useCount;
+	uint32 poseGeneration;
+
 	Vec3f *vertices;
 	Vec3f *normals;
+	uint32 poseId;		//changes whenever the vertices and normals do, 0 for the first frame
 
 public:
 	InterpolationData(const Mesh *mesh);
@@ -34,10 +71,27 @@ public:
 
 	const Vec3f *getVertices() const	{return vertices==NULL? mesh->getVertices(): vertices;}
 	const Vec3f *getNormals() const		{return normals==NULL? mesh->getNormals(): normals;}
+	uint32 getPoseId() const			{return poseId;}
 	
 	void update(float t, bool cycle);
 	void updateVertices(float t, bool cycle);
 	void updateNormals(float t, bool cycle);
+
+	//config
+	static void setPoseSteps(int poseSteps);
+	static void setNormalize(bool normalize);
+
+	//stats
+	static int64 getPoseHits()				{return poseHits;}
+	static int64 getPoseMisses()			{return poseMisses;}
+	static int64 getInterpolatedVertices()	{return interpolatedVertices;}
+	static void resetStats();
+
+private:
+	Pose *findPose(float t, bool cycle);
+	void computePose(Pose *pose);
+	void computeQuantizedPose(Pose *pose);
+	void normalizePose(Pose *pose);
 };
 
 }}//end namespace
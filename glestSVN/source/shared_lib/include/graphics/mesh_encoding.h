@@ -0,0 +1,44 @@
+// ==============================================================
+//	This file is part of Glest Shared Library (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_GRAPHICS_MESHENCODING_H_
+#define _SHARED_GRAPHICS_MESHENCODING_H_
+
+#include "vec.h"
+#include "types.h"
+
+using Shared::Platform::int16;
+using Shared::Platform::uint16;
+using Shared::Platform::uint32;
+
+namespace Shared{ namespace Graphics{
+
+// =====================================================
+//	Mesh encoding
+//
+///	Helpers for the optimized G3D format: a vertex cache 
+/// friendly triangle order and compact vertex attributes
+// =====================================================
+
+//reorders the triangles so recently used vertices are reused (Forsyth)
+void optimizeVertexCache(uint32 *indices, uint32 indexCount, uint32 vertexCount);
+
+//unit normal folded into two signed 16 bit values
+void encodeOctahedral(const Vec3f &normal, int16 *out);
+Vec3f decodeOctahedral(const int16 *in);
+
+//value inside [minValue, minValue+size] in 16 bits
+uint16 quantize(float value, float minValue, float size);
+float dequantize(uint16 value, float minValue, float size);
+
+}}//end namespace
+
+#endif
@@ -40,6 +40,10 @@ class TextureManager;
 // =====================================================
 
 class Mesh{
+public:
+	//indices of meshes up to this size are kept in 16 bits
+	static const uint32 maxShortIndexVertexCount= 65536;
+
 private:
 	//mesh data
 	Texture2D *textures[meshTextureCount];
@@ -50,12 +54,17 @@ private:
 	uint32 vertexCount;
 	uint32 indexCount;
 
-	//vertex data
+	//vertex data, animated meshes from optimized files keep it quantized instead
 	Vec3f *vertices;
 	Vec3f *normals;
+	uint16 *quantizedVertices;
+	int16 *encodedNormals;
+	Vec3f positionMin;
+	Vec3f positionSize;
 	Vec2f *texCoords;
 	Vec3f *tangents;
 	uint32 *indices;
+	uint16 *shortIndices;	//replaces indices for small meshes
 
 	//material data
 	Vec3f diffuseColor;
@@ -73,7 +82,7 @@ public:
 	//init & end
 	Mesh();
 	~Mesh();
-	void init();
+	void init(bool quantized= false);
 	void end();
 
 	//maps
@@ -88,9 +97,19 @@ public:
 	//data
 	const Vec3f *getVertices() const 	{return vertices;}
 	const Vec3f *getNormals() const 	{return normals;}
+	const uint16 *getQuantizedVertices() const	{return quantizedVertices;}
+	const int16 *getEncodedNormals() const		{return encodedNormals;}
+	const Vec3f &getPositionMin() const			{return positionMin;}
+	const Vec3f &getPositionSize() const		{return positionSize;}
+	bool isQuantized() const					{return quantizedVertices!=NULL;}
+	Vec3f getVertex(uint32 i) const;
+	Vec3f getNormal(uint32 i) const;
 	const Vec2f *getTexCoords() const	{return texCoords;}
 	const Vec3f *getTangents() const	{return tangents;}
 	const uint32 *getIndices() const 	{return indices;}
+	const uint16 *getShortIndices() const	{return shortIndices;}
+	bool hasShortIndices() const		{return shortIndices!=NULL;}
+	uint32 getIndex(uint32 i) const		{return shortIndices!=NULL? shortIndices[i]: indices[i];}
 
 	//material
 	const Vec3f &getDiffuseColor() const	{return diffuseColor;}
@@ -114,9 +133,12 @@ public:
 	void loadV2(const string &dir, FILE *f, TextureManager *textureManager);
 	void loadV3(const string &dir, FILE *f, TextureManager *textureManager);
 	void load(const string &dir, FILE *f, TextureManager *textureManager);
-	void save(const string &dir, FILE *f);
+	void loadV5(const string &dir, FILE *f, TextureManager *textureManager);
+	void save(FILE *f) const;
 
 private:
+	void loadMap(int i, const string &dir, const string &mapPath, TextureManager *textureManager);
+	void readIndices(FILE *f, bool fileShortIndices);
 	void computeTangents();
 };
 
@@ -135,6 +157,10 @@ private:
 	uint32 meshCount;
 	Mesh *meshes;
 
+	//bounding sphere of all the frames
+	Vec3f boundingCenter;
+	float boundingRadius;
+
 public: 
 	//constructor & destructor
 	Model();
@@ -154,17 +180,20 @@ public:
 
 	uint32 getTriangleCount() const;
 	uint32 getVertexCount() const;
+	const Vec3f &getBoundingCenter() const	{return boundingCenter;}
+	float getBoundingRadius() const			{return boundingRadius;}
 	
 	//io
 	void load(const string &path);
 	void save(const string &path);
 	void loadG3d(const string &path);
-	void saveS3d(const string &path);
+	void saveG3d(const string &path) const;
 
 	void setTextureManager(TextureManager *textureManager)	{this->textureManager= textureManager;}
 
 private:
 	void buildInterpolationData() const;
+	void computeBounds();
 };
 
 }}//end namespace
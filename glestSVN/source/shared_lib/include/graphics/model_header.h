@@ -72,6 +72,31 @@ struct MeshHeader{
 	uint32 textures;
 };
 
+//version 5, same model header as version 4
+
+enum MeshEncodingFlag{
+	mefShortIndices= 1
+};
+
+//after the map paths come the 16 bit quantized positions and the 
+//octahedral normals, every frame stored as a delta of the previous 
+//one, then float texture coords and 16 or 32 bit indices
+struct MeshHeaderV5{
+	uint8 name[meshNameSize];
+	uint32 frameCount;
+	uint32 vertexCount;
+	uint32 indexCount;
+	float32 diffuseColor[3];
+	float32 specularColor[3];
+	float32 specularPower;
+	float32 opacity;
+	uint32 properties;
+	uint32 textures;
+	uint32 encoding;
+	float32 positionMin[3];		//quantization box of all the frames
+	float32 positionSize[3];
+};
+
 #pragma pack(pop) 
 
 //version 3
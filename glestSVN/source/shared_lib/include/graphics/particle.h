@@ -13,15 +13,19 @@
 #define _SHARED_GRAPHICS_PARTICLE_H_
 
 #include <list>
+#include <utility>
 #include <cassert>
 
 #include "vec.h"
 #include "pixmap.h"
 #include "texture_manager.h"
 #include "random.h"
+#include "thread.h"
 
 using std::list;
+using std::pair;
 using Shared::Util::Random;
+using Shared::Platform::Mutex;
 
 namespace Shared{ namespace Graphics{
 
@@ -35,32 +39,6 @@ class ParticleRenderer;
 class ModelRenderer;
 class Model;
 
-// =====================================================
-//	class Particle
-// =====================================================
-
-class Particle{
-public:	
-	//attributes
-	Vec3f pos;
-	Vec3f lastPos;
-	Vec3f speed;
-	Vec3f accel;
-	Vec4f color;
-	float size;
-	int energy;
-
-public:
-	//get
-	Vec3f getPos() const		{return pos;}
-	Vec3f getLastPos() const	{return lastPos;}
-	Vec3f getSpeed() const		{return speed;}
-	Vec3f getAccel() const		{return accel;}
-	Vec4f getColor() const		{return color;}
-	float getSize() const		{return size;}
-	int getEnergy()	const		{return energy;}
-};
-
 class ParticleSystem;
 
 // =====================================================
@@ -75,6 +53,11 @@ public:
 
 // =====================================================
 //	class ParticleSystem
+//
+///	Particles are stored as one array per attribute, so 
+/// each system type updates and kills them in tight loops. 
+/// The arrays grow with the alive particles up to the 
+/// particle count given at construction
 // =====================================================
 
 class ParticleSystem{
@@ -92,8 +75,19 @@ protected:
 	};
 
 protected:
-	
-	Particle *particles;
+	static const int minParticleCapacity= 32;
+
+protected:
+	//particle data
+	Vec3f *positions;
+	Vec3f *lastPositions;
+	Vec3f *speeds;
+	Vec3f *accels;
+	Vec4f *colors;
+	float *sizes;
+	int *energies;
+	int particleCapacity;
+
 	Random random;
 
 	BlendMode blendMode;
@@ -114,6 +108,11 @@ protected:
 	float particleSize;
 	float speed;
 
+	//level of detail, set by the particle manager
+	float emissionScale;
+	float emissionAccum;
+	float emissionInterval;		//fraction of an update between particles emitted in it
+
 	ParticleObserver *particleObserver;
 
 public:
@@ -130,9 +129,12 @@ public:
 	BlendMode getBlendMode() const				{return blendMode;}
 	Texture *getTexture() const					{return texture;}
 	Vec3f getPos() const						{return pos;}
-	Particle *getParticle(int i)				{return &particles[i];}
-	const Particle *getParticle(int i) const	{return &particles[i];}
+	const Vec3f *getPositions() const			{return positions;}
+	const Vec3f *getLastPositions() const		{return lastPositions;}
+	const Vec4f *getColors() const				{return colors;}
+	const float *getSizes() const				{return sizes;}
 	int getAliveParticleCount() const			{return aliveParticleCount;}
+	int getParticleCapacity() const				{return particleCapacity;}
 	bool getActive() const						{return active;}
 	bool getVisible() const						{return visible;}
 
@@ -150,6 +152,7 @@ public:
 	void setActive(bool active);
 	void setObserver(ParticleObserver *particleObserver);
 	void setVisible(bool visible);
+	void setEmissionScale(float emissionScale);
 
 	//misc
 	void fade();
@@ -157,13 +160,14 @@ public:
 
 protected:
 	//protected
-	Particle *createParticle();
-	void killParticle(Particle *p);
+	int createParticle();
+	void moveParticle(int from, int to);
+	void reserveParticles(int count);
 
 	//virtual protected
-	virtual void initParticle(Particle *p, int particleIndex);
-	virtual void updateParticle(Particle *p);
-	virtual bool deathTest(Particle *p);
+	virtual void initParticle(int i, int particleIndex);
+	virtual void updateParticles(int begin, int end);
+	virtual void killParticles();
 };
 
 // =====================================================
@@ -179,8 +183,8 @@ public:
 	FireParticleSystem(int particleCount= 2000);
 
 	//virtual
-	virtual void initParticle(Particle *p, int particleIndex);
-	virtual void updateParticle(Particle *p);
+	virtual void initParticle(int i, int particleIndex);
+	virtual void updateParticles(int begin, int end);
 
 	//set params
 	void setRadius(float radius);
@@ -201,8 +205,8 @@ public:
 
 	virtual void render(ParticleRenderer *pr, ModelRenderer *mr);
 
-	virtual void initParticle(Particle *p, int particleIndex);
-	virtual bool deathTest(Particle *p);
+	virtual void initParticle(int i, int particleIndex);
+	virtual void killParticles();
 
 	void setRadius(float radius);
 	void setWind(float windAngle, float windSpeed);	
@@ -220,8 +224,8 @@ private:
 public:
 	SnowParticleSystem(int particleCount= 4000);
 
-	virtual void initParticle(Particle *p, int particleIndex);
-	virtual bool deathTest(Particle *p);
+	virtual void initParticle(int i, int particleIndex);
+	virtual void killParticles();
 
 	void setRadius(float radius);
 	void setWind(float windAngle, float windSpeed);	
@@ -307,8 +311,8 @@ public:
 	void link(SplashParticleSystem *particleSystem);
 	
 	virtual void update();
-	virtual void initParticle(Particle *p, int particleIndex);
-	virtual void updateParticle(Particle *p);
+	virtual void initParticle(int i, int particleIndex);
+	virtual void updateParticles(int begin, int end);
 	
 	void setTrajectory(Trajectory trajectory)				{this->trajectory= trajectory;}
 	void setTrajectorySpeed(float trajectorySpeed)			{this->trajectorySpeed= trajectorySpeed;}
@@ -341,8 +345,8 @@ public:
 	virtual ~SplashParticleSystem();
 	
 	virtual void update();
-	virtual void initParticle(Particle *p, int particleIndex);
-	virtual void updateParticle(Particle *p);
+	virtual void initParticle(int i, int particleIndex);
+	virtual void updateParticles(int begin, int end);
 
 	void setEmissionRateFade(int emissionRateFade)		{this->emissionRateFade= emissionRateFade;}
 	void setVerticalSpreadA(float verticalSpreadA)		{this->verticalSpreadA= verticalSpreadA;}
@@ -357,14 +361,42 @@ public:
 // =====================================================
 
 class ParticleManager{
+public:
+	static const float hiddenEmissionScale;
+
+private:
+	enum ChangeType{
+		ctFade,
+		ctActivate,
+		ctDeactivate
+	};
+
+	typedef pair<ParticleSystem*, ChangeType> Change;
+
 private:
 	list<ParticleSystem*> particleSystems; 
 
+	//handed over by manage, fade and setActive, possibly from another thread 
+	//while the manager renders, and applied in order by the next update
+	list<ParticleSystem*> newParticleSystems;
+	list<Change> changes;
+	Mutex handOverMutex;
+	
+	//level of detail
+	int particleBudget;		//0 for no budget
+	Vec3f viewPos;
+	float lodDistance;		//0 for no distance lod
+
 public:
+	ParticleManager();
 	~ParticleManager();
+	void setBudget(int particleBudget)		{this->particleBudget= particleBudget;}
+	void setView(const Vec3f &viewPos, float lodDistance);
 	void update();
 	void render(ParticleRenderer *pr, ModelRenderer *mr) const;	
 	void manage(ParticleSystem *ps);
+	void fade(ParticleSystem *ps);
+	void setActive(ParticleSystem *ps, bool active);
 	void end();
 }; 
 
@@ -13,11 +13,17 @@
 #define _SHARED_GRAPHICS_PIXMAP_H_
 
 #include <string>
+#include <map>
+#include <set>
 
 #include "vec.h"
 #include "types.h"
+#include "thread.h"
 
 using std::string;
+using std::map;
+using std::set;
+using Shared::Platform::Mutex;
 using Shared::Platform::int8;
 using Shared::Platform::uint8;
 using Shared::Platform::int16;
@@ -128,6 +134,8 @@ public:
 // =====================================================
 
 class Pixmap2D{
+	friend class PixmapCache;
+
 protected:
 	int h;
 	int w;
@@ -191,11 +199,46 @@ public:
 	void lerp(float t, const Pixmap2D *pixmap1, const Pixmap2D *pixmap2);
 	void copy(const Pixmap2D *sourcePixmap);
 	void subCopy(int x, int y, const Pixmap2D *sourcePixmap);
+	void swap(Pixmap2D *pixmap);
 
 private:
+	void decode(const string &path);
 	bool doDimensionsAgree(const Pixmap2D *pixmap);
 };
 
+// =====================================================
+//	class PixmapCache
+//
+///	Pixmaps decoded ahead of time by other threads,
+///	Pixmap2D::load takes them instead of reading the file
+// =====================================================
+
+class PixmapCache{
+private:
+	typedef map<string, Pixmap2D*> Pixmaps;
+	typedef set<string> Paths;
+
+private:
+	Mutex mutex;
+	bool enabled;
+	Pixmaps pixmaps;
+	Paths claimedPaths;
+
+private:
+	PixmapCache();
+
+public:
+	static PixmapCache &getInstance();
+	~PixmapCache();
+
+	void setEnabled(bool enabled);
+	void preload(const string &path);
+	bool take(const string &path, Pixmap2D *pixmap);
+
+private:
+	void clear();
+};
+
 // =====================================================
 //	class Pixmap3D
 // =====================================================
@@ -123,6 +123,13 @@ public:
 		return Vec2<T>(v-*this).length();
 	}
 
+	//orders like dist without the sqrt, exact for integer vectors
+	T sqDist(const Vec2<T> &v) const{
+		T dx= v.x-x;
+		T dy= v.y-y;
+		return dx*dx + dy*dy;
+	}
+
 	float length() const{
 		return static_cast<float>(sqrt(static_cast<float>(x*x + y*y)));
 	}
@@ -256,6 +263,13 @@ public:
 		return Vec3<T>(v-*this).length();
 	}
 
+	T sqDist(const Vec3<T> &v) const{
+		T dx= v.x-x;
+		T dy= v.y-y;
+		T dz= v.z-z;
+		return dx*dx + dy*dy + dz*dz;
+	}
+
 	float length() const{
 		return static_cast<float>(sqrt(x*x + y*y + z*z));
 	}
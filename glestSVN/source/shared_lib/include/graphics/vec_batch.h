@@ -0,0 +1,41 @@
+// ==============================================================
+//	This file is part of Glest Shared Library (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+#ifndef _SHARED_GRAPHICS_VECBATCH_H_
+#define _SHARED_GRAPHICS_VECBATCH_H_
+
+#include "vec.h"
+
+namespace Shared{ namespace Graphics{
+
+// =====================================================
+//	Batch vector operations
+//
+///	Kernels over whole arrays, SSE when the target has it 
+/// and plain loops otherwise. Both paths do the same float 
+/// operations in the same order, so results do not depend 
+/// on the path taken
+// =====================================================
+
+//out[i]= a[i] + t*(b[i]-a[i]), out may be a or b
+void lerpFloats(float t, const float *a, const float *b, float *out, int count);
+
+//lerpFloats over two streams of the same length in one pass, such as positions and normals
+void lerpFloats2(
+	float t, const float *a0, const float *b0, float *out0, 
+	const float *a1, const float *b1, float *out1, int count);
+
+//scales every vector to unit length, zero vectors are left as they are
+void normalizeVec3fs(Vec3f *vectors, int count);
+
+}}//end namespace
+
+#endif
@@ -29,12 +29,25 @@ typedef int(*LuaFunction)(LuaHandle*);
 
 // =====================================================
 //	class LuaScript
+//
+///	Runs Lua code. Each call may be limited to a number of 
+/// instructions, so a looping script can not hang the game
 // =====================================================
 
 class LuaScript{
+public:
+	static const int invalidRef= LUA_NOREF;
+
+private:
+	static const int hookInterval= 1000;
+	static char hookKey;
+
 private:
 	LuaHandle *luaState;
 	int argumentCount;
+	int instructionBudget;	//0 for no budget
+	int instructionCount;
+	int callDepth;			//calls in progress, handlers may call back into lua
 
 public:
 	LuaScript();
@@ -43,12 +56,18 @@ public:
 	void loadCode(const string &code, const string &name);
 
 	void beginCall(const string& functionName);
-	void endCall();
+	void beginCall(int functionRef);
+	bool endCall();
+
+	int getFunctionRef(const string &functionName);
+	int getCallDepth() const	{return callDepth;}
 
 	void registerFunction(LuaFunction luaFunction, const string &functionName);
+	void setInstructionBudget(int instructionBudget);
 
 private:
 	string errorToString(int errorCode);
+	static void countHook(LuaHandle *luaHandle, lua_Debug *debug);
 };
 
 // =====================================================
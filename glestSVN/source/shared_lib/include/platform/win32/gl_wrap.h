@@ -36,6 +36,7 @@
 #include <string>
 
 #include "font.h"
+#include "pixmap.h"
 #include "types.h"
 
 
@@ -44,6 +45,7 @@
 using std::string;
 
 using Shared::Graphics::FontMetrics;
+using Shared::Graphics::Pixmap2D;
 
 namespace Shared{ namespace Platform{
 
@@ -70,7 +72,7 @@ public:
 //	Global Fcs  
 // =====================================================
 
-void createGlFontBitmaps(uint32 &base, const string &type, int size, int width, int charCount, FontMetrics &metrics);
+void createGlFontAtlas(const string &type, int size, int width, int charCount, int columnCount, FontMetrics &metrics, Pixmap2D *atlas, int &cellW, int &cellH, int &baseline);
 //void createGlFontOutlines(uint32 &base, const string &type, int width, float depth, int charCount, FontMetrics &metrics);
 const char *getPlatformExtensions(const PlatformContextGl *pcgl);
 PROC getGlProcAddress(const char *procName);
@@ -37,6 +37,7 @@ private:
 	int64 thisTicks;
 	int64 lastTicks;
 	int64 updateTicks;
+	int64 freq;
 
 	int times;			// number of consecutive times
 	int maxTimes;		// maximum number consecutive times
@@ -46,6 +47,7 @@ public:
 	
 	bool isTime();
 	void reset();
+	int64 getMicrosToNext() const;
 };
 
 // =====================================================
@@ -108,6 +110,8 @@ int getScreenW();
 int getScreenH();
 
 void sleep(int millis);
+void beginPreciseSleep();
+void endPreciseSleep();
 
 void showCursor(bool b);
 bool isKeyDown(int virtualKey);
@@ -44,6 +44,7 @@ public:
 	void setPriority(Thread::Priority threadPriority);	
 	void suspend();
 	void resume();
+	void join();
 
 private:
 	static DWORD WINAPI beginExecution(void *param);
@@ -61,9 +62,26 @@ public:
 	Mutex();
 	~Mutex();
 	void p();
+	bool tryP();
 	void v();
 };
 
+// =====================================================
+//	class Semaphore
+// =====================================================
+
+class Semaphore{
+private:
+	HANDLE semaphore;
+
+public:
+	Semaphore(int initialCount= 0);
+	~Semaphore();
+	void p();
+	bool p(int milliseconds);
+	void v(int count= 1);
+};
+
 }}//end namespace
 
 #endif
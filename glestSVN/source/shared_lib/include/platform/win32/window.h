@@ -52,6 +52,7 @@ const int vkReturn= VK_RETURN;
 const int vkBack= VK_BACK;
 const int vkDelete= VK_DELETE;
 const int vkF1= VK_F1;
+const int vkF5= VK_F5;
 
 struct MouseState{
 	bool leftMouse;
@@ -39,6 +39,7 @@ public:
 	int32 getSum() const	{return sum;}
 
 	void addByte(int8 value);
+	void addInt(int32 value);
 	void addString(const string &value);
 	void addFile(const string &path);
 };
@@ -52,6 +52,7 @@ public:
 	string getKey(int i)	{return propertyVector[i].first;}
 	string getString(int i)	{return propertyVector[i].second;}
 
+	bool hasKey(const string &key) const;
 	bool getBool(const string &key) const;
 	int getInt(const string &key) const;
 	int getInt(const string &key, int min, int max) const;
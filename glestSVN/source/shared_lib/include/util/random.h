@@ -34,6 +34,7 @@ public:
 	int rand();
 	int randRange(int min, int max);
 	float randRange(float min, float max);
+	int getLastNumber() const	{return lastNumber;}
 };
 
 }}//end namespace
@@ -28,6 +28,7 @@ string cutLastExt(const string &s);
 string ext(const string &s);
 string replaceBy(const string &s, char c1, char c2);
 string toLower(const string &s);
+string cleanPath(const string &s);
 void copyStringToBuffer(char *buffer, int bufferSize, const string& s);
 
 //numeric fcs
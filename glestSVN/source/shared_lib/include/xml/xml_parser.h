@@ -14,11 +14,18 @@
 
 #include <string>
 #include <vector>
+#include <map>
+#include <set>
 
 #include <xercesc/util/XercesDefs.hpp>
 
+#include "thread.h"
+
 using std::string;
 using std::vector;
+using std::map;
+using std::set;
+using Shared::Platform::Mutex;
 
 namespace XERCES_CPP_NAMESPACE{
 	class DOMImplementation;
@@ -43,10 +50,20 @@ class XmlAttribute;
 // =====================================================
 
 class XmlIo{
+private:
+	typedef map<string, XmlNode*> Nodes;
+	typedef set<string> Paths;
+
 private:
 	static bool initialized;
 	XERCES_CPP_NAMESPACE::DOMImplementation *implementation;
 
+	//documents parsed ahead of time by other threads
+	Mutex preloadMutex;
+	bool preloadEnabled;
+	Nodes preloadedNodes;
+	Paths claimedPaths;
+
 private:
 	XmlIo();
 
@@ -55,6 +72,14 @@ public:
 	~XmlIo();
 	XmlNode *load(const string &path);
 	void save(const string &path, const XmlNode *node);
+
+	void setPreloadEnabled(bool preloadEnabled);
+	void preload(const string &path);
+
+private:
+	XmlNode *parse(const string &path);
+	XmlNode *takePreloaded(const string &path);
+	void clearPreloaded();
 };
 
 // =====================================================
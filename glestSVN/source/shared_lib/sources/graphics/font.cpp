@@ -35,7 +35,7 @@ FontMetrics::~FontMetrics(){
 float FontMetrics::getTextWidth(const string &str) const{
 	float width= 0.f;
 	for(int i=0; i<str.size(); ++i){
-		width+= widths[str[i]];
+		width+= widths[static_cast<unsigned char>(str[i])];
 	}
 	return width;
 }
@@ -0,0 +1,104 @@
+// ==============================================================
+//	This file is part of Glest Shared Library (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#include "buffer_manager_gl.h"
+
+#include "leak_dumper.h"
+
+namespace Shared{ namespace Graphics{ namespace Gl{
+
+// =====================================================
+//	class BufferManagerGl
+// =====================================================
+
+int64 BufferManagerGl::uploadedBytes= 0;
+
+BufferManagerGl::BufferManagerGl(){
+	supported= -1;
+	streamBuffer= 0;
+	streamOffset= 0;
+	streamEpoch= 0;
+}
+
+BufferManagerGl &BufferManagerGl::getInstance(){
+	static BufferManagerGl bufferManager;
+	return bufferManager;
+}
+
+bool BufferManagerGl::isSupported(){
+	if(supported==-1){
+		supported= isGlVersionSupported(1, 5, 0)? 1: 0;
+	}
+	return supported==1;
+}
+
+void BufferManagerGl::end(){
+	if(streamBuffer!=0){
+		glDeleteBuffers(1, &streamBuffer);
+		streamBuffer= 0;
+	}
+	streamOffset= 0;
+	++streamEpoch;
+
+	//the next context might be different
+	supported= -1;
+}
+
+GLuint BufferManagerGl::newBuffer(GLenum target, int size){
+	assert(isSupported());
+
+	GLuint buffer;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(target, buffer);
+	glBufferData(target, size, NULL, GL_STATIC_DRAW);
+	return buffer;
+}
+
+void BufferManagerGl::writeBuffer(GLenum target, int offset, const void *data, int size){
+	glBufferSubData(target, offset, size, data);
+	uploadedBytes+= size;
+}
+
+void BufferManagerGl::deleteBuffer(GLuint buffer){
+	if(buffer!=0){
+		glDeleteBuffers(1, &buffer);
+	}
+}
+
+int BufferManagerGl::reserveStream(int size){
+	if(size>streamBufferSize || !isSupported()){
+		return -1;
+	}
+
+	if(streamBuffer==0){
+		glGenBuffers(1, &streamBuffer);
+		glBindBuffer(GL_ARRAY_BUFFER, streamBuffer);
+		glBufferData(GL_ARRAY_BUFFER, streamBufferSize, NULL, GL_STREAM_DRAW);
+		streamOffset= 0;
+	}
+	else{
+		glBindBuffer(GL_ARRAY_BUFFER, streamBuffer);
+	}
+
+	//orphan the storage when full, the driver keeps the old one until pending draws are done
+	if(streamOffset+size>streamBufferSize){
+		glBufferData(GL_ARRAY_BUFFER, streamBufferSize, NULL, GL_STREAM_DRAW);
+		streamOffset= 0;
+		++streamEpoch;
+	}
+
+	int offset= streamOffset;
+	streamOffset+= (size+streamAlignment-1) & ~(streamAlignment-1);
+	return offset;
+}
+
+}}}//end namespace
@@ -13,12 +13,52 @@
 
 #include "opengl.h"
 #include "gl_wrap.h"
+#include "pixmap.h"
 #include "leak_dumper.h"
 
 namespace Shared{ namespace Graphics{ namespace Gl{
 
 using namespace Platform;
 
+// =====================================================
+//	class TextLayout
+// =====================================================
+
+void TextLayout::init(const Font2DGl *font, const string &text){
+	const FontMetrics *metrics= font->getMetrics();
+	const unsigned char *utext= reinterpret_cast<const unsigned char*>(text.c_str());
+	float size= static_cast<float>(font->getSize());
+
+	glyphs.clear();
+	width= metrics->getTextWidth(text);
+
+	int line= 0;
+	Vec2f runPos(0.f, 0.f);
+	float penX= 0.f;
+	for(int i=0; utext[i]!='\0'; ++i){
+		switch(utext[i]){
+		case '\t':
+			runPos= Vec2f(runPos.x+3.f*size, -(size+1.f)*line);
+			penX= 0.f;
+			break;
+		case '\n':
+			line++;
+			runPos= Vec2f(0.f, -(metrics->getHeight()*2.f)*line);
+			penX= 0.f;
+			break;
+		default:{
+				Glyph glyph;
+				glyph.runPos= runPos;
+				glyph.pos0= Vec2f(penX, -font->getBaseline());
+				glyph.pos1= Vec2f(penX+font->getCellW(), -font->getBaseline()+font->getCellH());
+				font->getTexCoords(utext[i], glyph.texCoord0, glyph.texCoord1);
+				glyphs.push_back(glyph);
+				penX+= metrics->getWidth(utext[i]);
+			}
+		}
+	}
+}
+
 // =====================================================
 //	class Font2DGl
 // =====================================================
@@ -27,8 +67,19 @@ void Font2DGl::init(){
 	assertGl();
 
 	if(!inited){
-		handle= glGenLists(charCount);
-		createGlFontBitmaps(handle, type, size, width, charCount, metrics);
+		Pixmap2D atlas;
+		createGlFontAtlas(type, size, width, charCount, columnCount, metrics, &atlas, cellW, cellH, baseline);
+		atlasW= atlas.getW();
+		atlasH= atlas.getH();
+
+		glGenTextures(1, &handle);
+		glBindTexture(GL_TEXTURE_2D, handle);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA8, atlasW, atlasH, 0, GL_ALPHA, GL_UNSIGNED_BYTE, atlas.getPixels());
 		inited= true;
 	}
 
@@ -39,14 +90,42 @@ void Font2DGl::end(){
 	assertGl();
 
 	if(inited){
-		assert(glIsList(handle));
-		glDeleteLists(handle, 1);
+		assert(glIsTexture(handle));
+		glDeleteTextures(1, &handle);
+		textLayouts.clear();
 		inited= false;
 	}
 
 	assertGl();
 }
 
+//strings that change often would grow the cache forever, so it starts over when full
+const TextLayout *Font2DGl::getTextLayout(const string &text) const{
+	TextLayouts::iterator it= textLayouts.find(text);
+	if(it!=textLayouts.end()){
+		return &it->second;
+	}
+
+	if(textLayouts.size()>=maxTextLayoutCount){
+		textLayouts.clear();
+	}
+
+	TextLayout &textLayout= textLayouts[text];
+	textLayout.init(this, text);
+	return &textLayout;
+}
+
+void Font2DGl::getTexCoords(unsigned char c, Vec2f &texCoord0, Vec2f &texCoord1) const{
+	int column= c % columnCount;
+	int row= c / columnCount;
+
+	//atlas rows are bottom up, cell rows top down
+	texCoord0.x= static_cast<float>(column*cellW)/atlasW;
+	texCoord0.y= static_cast<float>(atlasH-(row+1)*cellH)/atlasH;
+	texCoord1.x= static_cast<float>((column+1)*cellW)/atlasW;
+	texCoord1.y= static_cast<float>(atlasH-row*cellH)/atlasH;
+}
+
 // =====================================================
 //	class Font3DGl
 // =====================================================
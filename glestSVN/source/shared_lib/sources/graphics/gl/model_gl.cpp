@@ -0,0 +1,122 @@
+// ==============================================================
+//	This file is part of Glest Shared Library (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+
+#include "model_gl.h"
+
+#include "buffer_manager_gl.h"
+#include "leak_dumper.h"
+
+namespace Shared{ namespace Graphics{ namespace Gl{
+
+// =====================================================
+//	class MeshBuffersGl
+// =====================================================
+
+MeshBuffersGl::MeshBuffersGl(){
+	vertexBuffer= 0;
+	indexBuffer= 0;
+	staticVertices= false;
+	normalOffset= 0;
+	texCoordOffset= 0;
+
+	for(int i=0; i<streamedPoseCount; ++i){
+		streamedPoses[i].poseId= 0;
+		streamedPoses[i].epoch= 0;
+		streamedPoses[i].offset= -1;
+	}
+	nextStreamedPose= 0;
+}
+
+// =====================================================
+//	class ModelGl
+// =====================================================
+
+ModelGl::ModelGl(){
+	meshBuffers= NULL;
+}
+
+ModelGl::~ModelGl(){
+	delete [] meshBuffers;
+}
+
+//uploads the data that never changes, models keep rendering from memory without GL 1.5
+void ModelGl::init(){
+	BufferManagerGl &bufferManager= BufferManagerGl::getInstance();
+
+	if(meshBuffers!=NULL || getMeshCount()==0 || !bufferManager.isSupported()){
+		return;
+	}
+
+	meshBuffers= new MeshBuffersGl[getMeshCount()];
+
+	for(uint32 i=0; i<getMeshCount(); ++i){
+		const Mesh *mesh= getMesh(i);
+		MeshBuffersGl *buffers= &meshBuffers[i];
+		uint32 vertexCount= mesh->getVertexCount();
+		uint32 indexCount= mesh->getIndexCount();
+
+		if(vertexCount==0 || indexCount==0){
+			continue;
+		}
+
+		//vertices, normals and tex coords
+		int vec3Size= vertexCount*sizeof(Vec3f);
+		int vec2Size= vertexCount*sizeof(Vec2f);
+
+		buffers->staticVertices= mesh->getFrameCount()==1;
+		if(buffers->staticVertices){
+			buffers->normalOffset= vec3Size;
+			buffers->texCoordOffset= vec3Size*2;
+			buffers->vertexBuffer= bufferManager.newBuffer(GL_ARRAY_BUFFER, vec3Size*2+vec2Size);
+			bufferManager.writeBuffer(GL_ARRAY_BUFFER, 0, mesh->getVertices(), vec3Size);
+			bufferManager.writeBuffer(GL_ARRAY_BUFFER, buffers->normalOffset, mesh->getNormals(), vec3Size);
+		}
+		else{
+			buffers->texCoordOffset= 0;
+			buffers->vertexBuffer= bufferManager.newBuffer(GL_ARRAY_BUFFER, vec2Size);
+		}
+		bufferManager.writeBuffer(GL_ARRAY_BUFFER, buffers->texCoordOffset, mesh->getTexCoords(), vec2Size);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		//indices
+		if(mesh->hasShortIndices()){
+			int indexSize= indexCount*sizeof(uint16);
+			buffers->indexBuffer= bufferManager.newBuffer(GL_ELEMENT_ARRAY_BUFFER, indexSize);
+			bufferManager.writeBuffer(GL_ELEMENT_ARRAY_BUFFER, 0, mesh->getShortIndices(), indexSize);
+		}
+		else{
+			int indexSize= indexCount*sizeof(uint32);
+			buffers->indexBuffer= bufferManager.newBuffer(GL_ELEMENT_ARRAY_BUFFER, indexSize);
+			bufferManager.writeBuffer(GL_ELEMENT_ARRAY_BUFFER, 0, mesh->getIndices(), indexSize);
+		}
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+
+	assertGl();
+}
+
+void ModelGl::end(){
+	if(meshBuffers==NULL){
+		return;
+	}
+
+	BufferManagerGl &bufferManager= BufferManagerGl::getInstance();
+	for(uint32 i=0; i<getMeshCount(); ++i){
+		bufferManager.deleteBuffer(meshBuffers[i].vertexBuffer);
+		bufferManager.deleteBuffer(meshBuffers[i].indexBuffer);
+	}
+
+	delete [] meshBuffers;
+	meshBuffers= NULL;
+}
+
+}}}//end namespace
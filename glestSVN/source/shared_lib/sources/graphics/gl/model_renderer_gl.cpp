@@ -15,6 +15,7 @@
 #include "gl_wrap.h"
 #include "texture_gl.h"
 #include "interpolation.h"
+#include "buffer_manager_gl.h"
 #include "leak_dumper.h"
 
 //#include "glprocs.h"
@@ -96,8 +97,9 @@ void ModelRendererGl::render(const Model *model){
 	assertGl();
 
 	//render every mesh
+	const ModelGl *modelGl= static_cast<const ModelGl*>(model);
 	for(uint32 i=0; i<model->getMeshCount(); ++i){
-		renderMesh(model->getMesh(i));
+		renderMesh(model->getMesh(i), modelGl->getMeshBuffers(i));
 	}
 	
 	//assertions
@@ -120,7 +122,7 @@ void ModelRendererGl::renderNormalsOnly(const Model *model){
 
 // ===================== PRIVATE =======================
 
-void ModelRendererGl::renderMesh(const Mesh *mesh){
+void ModelRendererGl::renderMesh(const Mesh *mesh, const MeshBuffersGl *buffers){
 		
 	//assertions
 	assertGl();
@@ -160,17 +162,47 @@ void ModelRendererGl::renderMesh(const Mesh *mesh){
 	//misc vars
 	uint32 vertexCount= mesh->getVertexCount();
 	uint32 indexCount= mesh->getIndexCount();
+	const InterpolationData *interpolationData= mesh->getInterpolationData();
 	
 	//assertions
 	assertGl();
+
+	//pointers are offsets when the mesh is in buffers
+	bool useBuffers= buffers!=NULL && buffers->vertexBuffer!=0;
+	const char *vertexData= reinterpret_cast<const char*>(interpolationData->getVertices());
+	const char *normalData= reinterpret_cast<const char*>(interpolationData->getNormals());
+	const char *texCoordData= reinterpret_cast<const char*>(mesh->getTexCoords());
+	const char *indexData= mesh->hasShortIndices()? reinterpret_cast<const char*>(mesh->getShortIndices()): reinterpret_cast<const char*>(mesh->getIndices());
+	GLuint vertexBuffer= 0;
+
+	if(useBuffers){
+		const char *base= NULL;
+		texCoordData= base + buffers->texCoordOffset;
+		indexData= NULL;
+
+		if(buffers->staticVertices){
+			vertexBuffer= buffers->vertexBuffer;
+			vertexData= base;
+			normalData= base + buffers->normalOffset;
+		}
+		else{
+			int offset= streamPose(mesh, buffers);
+			if(offset>=0){
+				vertexBuffer= BufferManagerGl::getInstance().getStreamBuffer();
+				vertexData= base + offset;
+				normalData= base + offset + vertexCount*sizeof(Vec3f);
+			}
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+	}
 	
 	//vertices
-	glVertexPointer(3, GL_FLOAT, 0, mesh->getInterpolationData()->getVertices());
+	glVertexPointer(3, GL_FLOAT, 0, vertexData);
 
 	//normals
 	if(renderNormals){
 		glEnableClientState(GL_NORMAL_ARRAY);
-		glNormalPointer(GL_FLOAT, 0, mesh->getInterpolationData()->getNormals());
+		glNormalPointer(GL_FLOAT, 0, normalData);
 	}
 	else{
 		glDisableClientState(GL_NORMAL_ARRAY);
@@ -178,15 +210,19 @@ void ModelRendererGl::renderMesh(const Mesh *mesh){
 
 	//tex coords
 	if(renderTextures && mesh->getTexture(mtDiffuse)!=NULL ){
+		if(useBuffers){
+			glBindBuffer(GL_ARRAY_BUFFER, buffers->vertexBuffer);
+		}
+
 		if(duplicateTexCoords){
 			glActiveTexture(GL_TEXTURE0 + secondaryTexCoordUnit);
 			glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-			glTexCoordPointer(2, GL_FLOAT, 0, mesh->getTexCoords());
+			glTexCoordPointer(2, GL_FLOAT, 0, texCoordData);
 		}
 
 		glActiveTexture(GL_TEXTURE0);
 		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
-		glTexCoordPointer(2, GL_FLOAT, 0, mesh->getTexCoords());
+		glTexCoordPointer(2, GL_FLOAT, 0, texCoordData);
 	}
 	else{
 		if(duplicateTexCoords){
@@ -198,7 +234,17 @@ void ModelRendererGl::renderMesh(const Mesh *mesh){
 	}
 
 	//draw model
-	glDrawRangeElements(GL_TRIANGLES, 0, vertexCount-1, indexCount, GL_UNSIGNED_INT, mesh->getIndices());
+	if(useBuffers){
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers->indexBuffer);
+	}
+
+	GLenum indexType= mesh->hasShortIndices()? GL_UNSIGNED_SHORT: GL_UNSIGNED_INT;
+	glDrawRangeElements(GL_TRIANGLES, 0, vertexCount-1, indexCount, indexType, indexData);
+
+	if(useBuffers){
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
 
 	//assertions
 	assertGl();
@@ -207,8 +253,8 @@ void ModelRendererGl::renderMesh(const Mesh *mesh){
 void ModelRendererGl::renderMeshNormals(const Mesh *mesh){
 	glBegin(GL_LINES);
 	for(int i= 0; i<mesh->getIndexCount(); ++i){
-		Vec3f vertex= mesh->getInterpolationData()->getVertices()[mesh->getIndices()[i]];
-		Vec3f normal= vertex + mesh->getInterpolationData()->getNormals()[mesh->getIndices()[i]];
+		Vec3f vertex= mesh->getInterpolationData()->getVertices()[mesh->getIndex(i)];
+		Vec3f normal= vertex + mesh->getInterpolationData()->getNormals()[mesh->getIndex(i)];
 	
 		glVertex3fv(vertex.ptr());
 		glVertex3fv(normal.ptr());
@@ -216,4 +262,35 @@ void ModelRendererGl::renderMeshNormals(const Mesh *mesh){
 	glEnd();
 }
 
+//returns the stream offset of the current pose of an animated mesh, uploading it if needed
+int ModelRendererGl::streamPose(const Mesh *mesh, const MeshBuffersGl *buffers){
+	BufferManagerGl &bufferManager= BufferManagerGl::getInstance();
+	const InterpolationData *interpolationData= mesh->getInterpolationData();
+	uint32 poseId= interpolationData->getPoseId();
+
+	//units sharing an animation state reuse the upload
+	for(int i=0; i<MeshBuffersGl::streamedPoseCount; ++i){
+		const MeshBuffersGl::StreamedPose &streamedPose= buffers->streamedPoses[i];
+		if(streamedPose.offset>=0 && streamedPose.poseId==poseId && streamedPose.epoch==bufferManager.getStreamEpoch()){
+			return streamedPose.offset;
+		}
+	}
+
+	int size= mesh->getVertexCount()*sizeof(Vec3f);
+	int offset= bufferManager.reserveStream(size*2);
+	if(offset<0){
+		return -1;
+	}
+	bufferManager.writeBuffer(GL_ARRAY_BUFFER, offset, interpolationData->getVertices(), size);
+	bufferManager.writeBuffer(GL_ARRAY_BUFFER, offset+size, interpolationData->getNormals(), size);
+
+	MeshBuffersGl::StreamedPose &streamedPose= buffers->streamedPoses[buffers->nextStreamedPose];
+	streamedPose.poseId= poseId;
+	streamedPose.epoch= bufferManager.getStreamEpoch();
+	streamedPose.offset= offset;
+	buffers->nextStreamedPose= (buffers->nextStreamedPose+1) % MeshBuffersGl::streamedPoseCount;
+
+	return offset;
+}
+
 }}}//end namespace
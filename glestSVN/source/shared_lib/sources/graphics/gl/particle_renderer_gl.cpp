@@ -104,12 +104,14 @@ void ParticleRendererGl::renderSystem(ParticleSystem *ps){
 
 	//fill vertex buffer with billboards
 	int bufferIndex= 0;
+	const Vec3f *positions= ps->getPositions();
+	const Vec4f *colors= ps->getColors();
+	const float *sizes= ps->getSizes();
 
 	for(int i=0; i<ps->getAliveParticleCount(); ++i){
-		const Particle *particle= ps->getParticle(i);
-		float size= particle->getSize()/2.0f;
-		Vec3f pos= particle->getPos();
-		Vec4f color= particle->getColor();
+		float size= sizes[i]/2.0f;
+		const Vec3f &pos= positions[i];
+		const Vec4f &color= colors[i];
 
 		vertexBuffer[bufferIndex] = pos - (rightVector - upVector) * size;
 		vertexBuffer[bufferIndex+1] = pos - (rightVector + upVector) * size;
@@ -138,8 +140,10 @@ void ParticleRendererGl::renderSystemLine(ParticleSystem *ps){
 	assertGl();
 	assert(rendering);
 
-	if(!ps->isEmpty()){
-		const Particle *particle= ps->getParticle(0);
+	if(ps->getAliveParticleCount()>0){
+		const Vec3f *positions= ps->getPositions();
+		const Vec3f *lastPositions= ps->getLastPositions();
+		const Vec4f *colors= ps->getColors();
 		
 		setBlendMode(ps->getBlendMode());
 
@@ -152,14 +156,13 @@ void ParticleRendererGl::renderSystemLine(ParticleSystem *ps){
 		//fill vertex buffer with lines
 		int bufferIndex= 0;
 
-		glLineWidth(particle->getSize());
+		glLineWidth(ps->getSizes()[0]);
 		
 		for(int i=0; i<ps->getAliveParticleCount(); ++i){
-			particle= ps->getParticle(i);
-			Vec4f color= particle->getColor();
+			const Vec4f &color= colors[i];
 
-			vertexBuffer[bufferIndex] = particle->getPos();
-			vertexBuffer[bufferIndex+1] = particle->getLastPos();
+			vertexBuffer[bufferIndex] = positions[i];
+			vertexBuffer[bufferIndex+1] = lastPositions[i];
 			
 			colorBuffer[bufferIndex]= color;
 			colorBuffer[bufferIndex+1]= color;
@@ -182,8 +185,10 @@ void ParticleRendererGl::renderSystemLineAlpha(ParticleSystem *ps){
 	assertGl();
 	assert(rendering);
 
-	if(!ps->isEmpty()){
-		const Particle *particle= ps->getParticle(0);
+	if(ps->getAliveParticleCount()>0){
+		const Vec3f *positions= ps->getPositions();
+		const Vec3f *lastPositions= ps->getLastPositions();
+		const Vec4f *colors= ps->getColors();
 			
 		setBlendMode(ps->getBlendMode());
 
@@ -196,14 +201,13 @@ void ParticleRendererGl::renderSystemLineAlpha(ParticleSystem *ps){
 		//fill vertex buffer with lines
 		int bufferIndex= 0;
 
-		glLineWidth(particle->getSize());
+		glLineWidth(ps->getSizes()[0]);
 		
 		for(int i=0; i<ps->getAliveParticleCount(); ++i){
-			particle= ps->getParticle(i);
-			Vec4f color= particle->getColor();
+			const Vec4f &color= colors[i];
 
-			vertexBuffer[bufferIndex] = particle->getPos();
-			vertexBuffer[bufferIndex+1] = particle->getLastPos();
+			vertexBuffer[bufferIndex] = positions[i];
+			vertexBuffer[bufferIndex+1] = lastPositions[i];
 			
 			colorBuffer[bufferIndex]= color;
 			colorBuffer[bufferIndex+1]= color;
@@ -11,6 +11,8 @@
 
 #include "text_renderer_gl.h"
 
+#include <cmath>
+
 #include "opengl.h"
 #include "font_gl.h"
 #include "leak_dumper.h"
@@ -25,55 +27,146 @@ TextRenderer2DGl::TextRenderer2DGl(){
 	rendering= false;
 }
 
+//glyphs are drawn in window pixels like raster text, so the position is transformed here
 void TextRenderer2DGl::begin(const Font2D *font){
 	assert(!rendering);
 	rendering= true;
 	
 	this->font= static_cast<const Font2DGl*>(font);
+
+	float modelview[16];
+	float projection[16];
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+	glGetFloatv(GL_PROJECTION_MATRIX, projection);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	for(int i=0; i<4; ++i){
+		for(int j=0; j<4; ++j){
+			transform[j*4+i]= 0.f;
+			for(int k=0; k<4; ++k){
+				transform[j*4+i]+= projection[k*4+i]*modelview[j*4+k];
+			}
+		}
+	}
 }
 
 void TextRenderer2DGl::render(const string &text, int x, int y, bool centered){
 	assert(rendering);
 	
-	assertGl();
-
-	int line=0;
-	int size= font->getSize();
-    const unsigned char *utext= reinterpret_cast<const unsigned char*>(text.c_str());
+	const TextLayout *textLayout= font->getTextLayout(text);
 
-	Vec2f rasterPos;
-	const FontMetrics *metrics= font->getMetrics();
+	Vec2f textPos(static_cast<float>(x), static_cast<float>(y));
 	if(centered){
-		rasterPos.x= x-metrics->getTextWidth(text)/2.f;
-		rasterPos.y= y+metrics->getHeight()/2.f;
-	}
-	else{
-		rasterPos= Vec2f(static_cast<float>(x), static_cast<float>(y));
+		textPos.x-= textLayout->getWidth()/2.f;
+		textPos.y+= font->getMetrics()->getHeight()/2.f;
 	}
-	glRasterPos2f(rasterPos.x, rasterPos.y);
-
-	for (int i=0; utext[i]!='\0'; ++i) {
-		switch(utext[i]){
-		case '\t':
-			rasterPos= Vec2f((rasterPos.x/size+3.f)*size, y-(size+1.f)*line);
-			glRasterPos2f(rasterPos.x, rasterPos.y);
-			break;
-		case '\n':
-			line++;
-			rasterPos= Vec2f(static_cast<float>(x), y-(metrics->getHeight()*2.f)*line);
-			glRasterPos2f(rasterPos.x, rasterPos.y);
-			break;
-		default:
-			glCallList(font->getHandle()+utext[i]);
+
+	Vec4f color;
+	glGetFloatv(GL_CURRENT_COLOR, color.ptr());
+
+	const TextLayout::Glyphs &glyphs= textLayout->getGlyphs();
+	Vec2f origin;
+	for(int i=0; i<glyphs.size(); ++i){
+		const TextLayout::Glyph &glyph= glyphs[i];
+
+		//runs are placed like raster positions, their glyphs in window pixels
+		if(i==0 || glyph.runPos!=glyphs[i-1].runPos){
+			Vec2f runPos= textPos + glyph.runPos;
+			origin= toWindow(runPos.x, runPos.y);
+
+			//whole pixels, so the atlas is sampled texel by texel
+			origin.x= floorf(origin.x+0.5f);
+			origin.y= floorf(origin.y+0.5f);
 		}
-	}
 
-	assertGl();
+		Vertex vertex;
+		vertex.color= color;
+
+		vertex.pos= origin + glyph.pos0;
+		vertex.texCoord= glyph.texCoord0;
+		vertices.push_back(vertex);
+
+		vertex.pos= origin + Vec2f(glyph.pos1.x, glyph.pos0.y);
+		vertex.texCoord= Vec2f(glyph.texCoord1.x, glyph.texCoord0.y);
+		vertices.push_back(vertex);
+
+		vertex.pos= origin + glyph.pos1;
+		vertex.texCoord= glyph.texCoord1;
+		vertices.push_back(vertex);
+
+		vertex.pos= origin + Vec2f(glyph.pos0.x, glyph.pos1.y);
+		vertex.texCoord= Vec2f(glyph.texCoord0.x, glyph.texCoord1.y);
+		vertices.push_back(vertex);
+	}
 }
 
+//draws all the glyphs queued since begin with a single call
 void TextRenderer2DGl::end(){
 	assert(rendering);
 	rendering= false;
+
+	if(vertices.empty()){
+		return;
+	}
+
+	assertGl();
+
+	glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_COLOR_BUFFER_BIT | GL_TRANSFORM_BIT);
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0, viewport[2], 0, viewport[3], -1, 1);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	glDisable(GL_LIGHTING);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glEnable(GL_TEXTURE_2D);
+	glBindTexture(GL_TEXTURE_2D, font->getHandle());
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].pos);
+	glClientActiveTexture(GL_TEXTURE0);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].texCoord);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glColorPointer(4, GL_FLOAT, sizeof(Vertex), &vertices[0].color);
+
+	glDrawArrays(GL_QUADS, 0, vertices.size());
+
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
+
+	glPopClientAttrib();
+	glPopAttrib();
+
+	vertices.clear();
+
+	assertGl();
+}
+
+float TextRenderer2DGl::getTextWidth(const Font2D *font, const string &text){
+	return static_cast<const Font2DGl*>(font)->getTextLayout(text)->getWidth();
+}
+
+// ==================== PRIVATE ==================== 
+
+Vec2f TextRenderer2DGl::toWindow(float x, float y) const{
+	float clipX= transform[0]*x + transform[4]*y + transform[12];
+	float clipY= transform[1]*x + transform[5]*y + transform[13];
+	float clipW= transform[3]*x + transform[7]*y + transform[15];
+
+	return Vec2f(
+		(clipX/clipW+1.f)*0.5f*viewport[2],
+		(clipY/clipW+1.f)*0.5f*viewport[3]);
 }
 
 // =====================================================
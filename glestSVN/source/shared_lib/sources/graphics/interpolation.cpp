@@ -12,9 +12,12 @@
 #include "interpolation.h"
 
 #include <cassert>
+#include <cmath>
 #include <algorithm>
 
 #include "model.h"
+#include "mesh_encoding.h"
+#include "vec_batch.h"
 #include "leak_dumper.h"
 
 using namespace std;
@@ -25,78 +28,207 @@ namespace Shared{ namespace Graphics{
 //	class InterpolationData
 // =====================================================
 
+int InterpolationData::poseSteps= 16;
+bool InterpolationData::normalize= false;
+uint32 InterpolationData::configGeneration= 0;
+int64 InterpolationData::poseHits= 0;
+int64 InterpolationData::poseMisses= 0;
+int64 InterpolationData::interpolatedVertices= 0;
+uint32 InterpolationData::lastPoseId= 0;
+
 InterpolationData::InterpolationData(const Mesh *mesh){
 	vertices= NULL;
 	normals= NULL;
+	poseId= 0;
+	poseCount= 0;
+	useCount= 0;
+	poseGeneration= configGeneration;
 	
 	this->mesh= mesh;
 
-	if(mesh->getFrameCount()>1){
-		vertices= new Vec3f[mesh->getVertexCount()];
-		normals= new Vec3f[mesh->getVertexCount()];
+	//quantized meshes have no float frames to fall back on
+	if(mesh->isQuantized()){
+		update(0.f, false);
 	}
 }
 
 InterpolationData::~InterpolationData(){
-	delete [] vertices;
-	delete [] normals;
+	for(int i=0; i<poseCount; ++i){
+		delete [] poses[i].vertices;
+		delete [] poses[i].normals;
+	}
 }
 
 void InterpolationData::update(float t, bool cycle){
-	updateVertices(t, cycle);
-	updateNormals(t, cycle);
+	Pose *pose= findPose(t, cycle);
+	
+	if(pose!=NULL){
+		vertices= pose->vertices;
+		normals= pose->normals;
+		poseId= pose->id;
+	}
 }
 
 void InterpolationData::updateVertices(float t, bool cycle){
+	update(t, cycle);
+}
+
+void InterpolationData::updateNormals(float t, bool cycle){
+	update(t, cycle);
+}
+
+void InterpolationData::setPoseSteps(int poseSteps){
+	if(InterpolationData::poseSteps!=poseSteps){
+		InterpolationData::poseSteps= poseSteps;
+		++configGeneration;
+	}
+}
+
+void InterpolationData::setNormalize(bool normalize){
+	if(InterpolationData::normalize!=normalize){
+		InterpolationData::normalize= normalize;
+		++configGeneration;
+	}
+}
+
+void InterpolationData::resetStats(){
+	poseHits= 0;
+	poseMisses= 0;
+	interpolatedVertices= 0;
+}
+
+// ==================== PRIVATE ==================== 
+
+//returns the cached pose for t, computing it in the least recently used slot if needed
+InterpolationData::Pose *InterpolationData::findPose(float t, bool cycle){
 	assert(t>=0.0f && t<=1.0f);
 	
 	uint32 frameCount= mesh->getFrameCount();
 	uint32 vertexCount= mesh->getVertexCount();
-	const Vec3f *meshVertices= mesh->getVertices();
-
-	if(frameCount>1){
-		//misc vars
-		uint32 prevFrame= min<uint32>(static_cast<uint32>(t*frameCount), frameCount-1);
-		uint32 nextFrame= cycle? (prevFrame+1) % frameCount: min(prevFrame+1, frameCount-1); 
-		float localT= t*frameCount - prevFrame; 
-		uint32 prevFrameBase= prevFrame*vertexCount;
-		uint32 nextFrameBase= nextFrame*vertexCount;
-
-		//assertions
-		assert(prevFrame<frameCount);
-		assert(nextFrame<frameCount);
-
-		//interpolate vertices
-		for(uint32 j=0; j<vertexCount; ++j){
-			vertices[j]= meshVertices[prevFrameBase+j].lerp(localT, meshVertices[nextFrameBase+j]);
+
+	if(frameCount<=1){
+		return NULL;
+	}
+
+	//misc vars
+	uint32 prevFrame= min<uint32>(static_cast<uint32>(t*frameCount), frameCount-1);
+	uint32 nextFrame= cycle? (prevFrame+1) % frameCount: min(prevFrame+1, frameCount-1); 
+	float localT= t*frameCount - prevFrame; 
+	if(poseSteps>0){
+		localT= floorf(localT*poseSteps+0.5f)/poseSteps;
+	}
+
+	//assertions
+	assert(prevFrame<frameCount);
+	assert(nextFrame<frameCount);
+
+	//poses computed with another config are dropped, their slots are reused
+	if(poseGeneration!=configGeneration){
+		for(int i=0; i<poseCount; ++i){
+			poses[i].lastUse= 0;
+			poses[i].localT= -1.f;
 		}
+		poseGeneration= configGeneration;
 	}
+
+	//look up
+	++useCount;
+	Pose *lruPose= NULL;
+	for(int i=0; i<poseCount; ++i){
+		Pose *pose= &poses[i];
+		if(pose->prevFrame==prevFrame && pose->nextFrame==nextFrame && pose->localT==localT){
+			pose->lastUse= useCount;
+			++poseHits;
+			return pose;
+		}
+		if(lruPose==NULL || pose->lastUse<lruPose->lastUse){
+			lruPose= pose;
+		}
+	}
+
+	//take a new slot while there are free ones, otherwise evict
+	Pose *pose= lruPose;
+	if(poseCount<maxPoses){
+		pose= &poses[poseCount++];
+		pose->vertices= new Vec3f[vertexCount];
+		pose->normals= new Vec3f[vertexCount];
+	}
+
+	pose->prevFrame= prevFrame;
+	pose->nextFrame= nextFrame;
+	pose->localT= localT;
+	pose->lastUse= useCount;
+	computePose(pose);
+	++poseMisses;
+	
+	return pose;
 }
 
-void InterpolationData::updateNormals(float t, bool cycle){
-	assert(t>=0.0f && t<=1.0f);
+void InterpolationData::computePose(Pose *pose){
+	uint32 vertexCount= mesh->getVertexCount();
+	uint32 prevFrameBase= pose->prevFrame*vertexCount;
+	uint32 nextFrameBase= pose->nextFrame*vertexCount;
+	float t= pose->localT;
 	
-	uint32 frameCount= mesh->getFrameCount();
+	if(mesh->isQuantized()){
+		computeQuantizedPose(pose);
+	}
+	else{
+		const float *prevVertices= mesh->getVertices()[prevFrameBase].ptr();
+		const float *nextVertices= mesh->getVertices()[nextFrameBase].ptr();
+		const float *prevNormals= mesh->getNormals()[prevFrameBase].ptr();
+		const float *nextNormals= mesh->getNormals()[nextFrameBase].ptr();
+		float *outVertices= pose->vertices[0].ptr();
+		float *outNormals= pose->normals[0].ptr();
+
+		lerpFloats2(
+			t, prevVertices, nextVertices, outVertices, 
+			prevNormals, nextNormals, outNormals, vertexCount*3);
+	}
+
+	//new contents, 0 is kept for the first frame
+	pose->id= ++lastPoseId;
+	if(pose->id==0){
+		pose->id= ++lastPoseId;
+	}
+
+	if(normalize){
+		normalizePose(pose);
+	}
+
+	interpolatedVertices+= vertexCount;
+}
+
+//positions are lerped in the quantized space, which is linear, and then scaled, 
+//normals are decoded first since the octahedral mapping is not
+void InterpolationData::computeQuantizedPose(Pose *pose){
 	uint32 vertexCount= mesh->getVertexCount();
-	const Vec3f *meshNormals= mesh->getNormals();
-
-	if(frameCount>1){
-		//misc vars
-		uint32 prevFrame= min<uint32>(static_cast<uint32>(t*frameCount), frameCount-1);
-		uint32 nextFrame= cycle? (prevFrame+1) % frameCount: min(prevFrame+1, frameCount-1); 
-		float localT= t*frameCount - prevFrame; 
-		uint32 prevFrameBase= prevFrame*vertexCount;
-		uint32 nextFrameBase= nextFrame*vertexCount;
-
-		//assertions
-		assert(prevFrame<frameCount);
-		assert(nextFrame<frameCount);
-
-		//interpolate vertices
-		for(uint32 j=0; j<vertexCount; ++j){
-			normals[j]= meshNormals[prevFrameBase+j].lerp(localT, meshNormals[nextFrameBase+j]); 
+	float t= pose->localT;
+
+	const uint16 *prevVertices= &mesh->getQuantizedVertices()[pose->prevFrame*vertexCount*3];
+	const uint16 *nextVertices= &mesh->getQuantizedVertices()[pose->nextFrame*vertexCount*3];
+	const int16 *prevNormals= &mesh->getEncodedNormals()[pose->prevFrame*vertexCount*2];
+	const int16 *nextNormals= &mesh->getEncodedNormals()[pose->nextFrame*vertexCount*2];
+	const Vec3f &positionMin= mesh->getPositionMin();
+	Vec3f positionScale= mesh->getPositionSize()/65535.f;
+
+	for(uint32 i=0; i<vertexCount; ++i){
+		float *outVertex= pose->vertices[i].ptr();
+		for(int j=0; j<3; ++j){
+			float prev= prevVertices[i*3+j];
+			float next= nextVertices[i*3+j];
+			outVertex[j]= positionMin.ptr()[j] + (prev+(next-prev)*t)*positionScale.ptr()[j];
 		}
+
+		Vec3f prevNormal= decodeOctahedral(&prevNormals[i*2]);
+		Vec3f nextNormal= decodeOctahedral(&nextNormals[i*2]);
+		pose->normals[i]= prevNormal+(nextNormal-prevNormal)*t;
 	}
 }
 
+//lerped normals are shorter than unit length, fix them if GL does not
+void InterpolationData::normalizePose(Pose *pose){
+	normalizeVec3fs(pose->normals, mesh->getVertexCount());
+}
+
 }}//end namespace 
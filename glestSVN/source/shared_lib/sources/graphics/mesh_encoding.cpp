@@ -0,0 +1,226 @@
+// ==============================================================
+//	This file is part of Glest Shared Library (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "mesh_encoding.h"
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#include "leak_dumper.h"
+
+using namespace std;
+
+namespace Shared{ namespace Graphics{
+
+// =====================================================
+//	Mesh encoding
+// =====================================================
+
+//vertex cache simulation, values from Forsyth's linear speed optimizer
+static const int cacheSize= 32;
+static const float cacheDecayPower= 1.5f;
+static const float lastTriangleScore= 0.75f;
+static const float valenceBoostScale= 2.0f;
+static const float valenceBoostPower= 0.5f;
+
+static float computeVertexScore(int cachePosition, int remainingTriangles){
+	if(remainingTriangles==0){
+		return -1.f;
+	}
+
+	float score= 0.f;
+	if(cachePosition>=0){
+		if(cachePosition<3){
+			score= lastTriangleScore;
+		}
+		else{
+			float scaler= 1.f/(cacheSize-3);
+			score= powf(1.f-(cachePosition-3)*scaler, cacheDecayPower);
+		}
+	}
+
+	//vertices with few triangles left go first, so they leave the cache
+	return score + valenceBoostScale*powf(static_cast<float>(remainingTriangles), -valenceBoostPower);
+}
+
+static int16 toSnorm16(float f){
+	f= f<-1.f? -1.f: (f>1.f? 1.f: f);
+	return static_cast<int16>(floorf(f*32767.f+0.5f));
+}
+
+static float signNotZero(float f){
+	return f>=0.f? 1.f: -1.f;
+}
+
+void optimizeVertexCache(uint32 *indices, uint32 indexCount, uint32 vertexCount){
+	uint32 triangleCount= indexCount/3;
+	if(triangleCount==0){
+		return;
+	}
+
+	//triangles of each vertex, the active ones are the first remainingTriangles of its span
+	vector<uint32> triangleStarts(vertexCount+1, 0);
+	for(uint32 i=0; i<triangleCount*3; ++i){
+		++triangleStarts[indices[i]+1];
+	}
+	for(uint32 i=0; i<vertexCount; ++i){
+		triangleStarts[i+1]+= triangleStarts[i];
+	}
+
+	vector<uint32> vertexTriangles(triangleCount*3);
+	vector<int> remainingTriangles(vertexCount, 0);
+	for(uint32 i=0; i<triangleCount; ++i){
+		for(int j=0; j<3; ++j){
+			uint32 v= indices[i*3+j];
+			vertexTriangles[triangleStarts[v]+remainingTriangles[v]]= i;
+			++remainingTriangles[v];
+		}
+	}
+
+	//initial scores
+	vector<int> cachePositions(vertexCount, -1);
+	vector<float> vertexScores(vertexCount);
+	for(uint32 i=0; i<vertexCount; ++i){
+		vertexScores[i]= computeVertexScore(-1, remainingTriangles[i]);
+	}
+
+	vector<float> triangleScores(triangleCount);
+	vector<bool> emitted(triangleCount, false);
+	for(uint32 i=0; i<triangleCount; ++i){
+		triangleScores[i]= vertexScores[indices[i*3]] + vertexScores[indices[i*3+1]] + vertexScores[indices[i*3+2]];
+	}
+
+	vector<uint32> cache;
+	vector<uint32> newCache;
+	vector<uint32> output;
+	output.reserve(triangleCount*3);
+
+	int bestTriangle= -1;
+	while(output.size()<triangleCount*3){
+		
+		//nothing in the cache has triangles left, take the best of all
+		if(bestTriangle<0){
+			for(uint32 i=0; i<triangleCount; ++i){
+				if(!emitted[i] && (bestTriangle<0 || triangleScores[i]>triangleScores[bestTriangle])){
+					bestTriangle= i;
+				}
+			}
+		}
+
+		//emit it and remove it from its vertices
+		uint32 triangle= bestTriangle;
+		emitted[triangle]= true;
+		newCache.clear();
+		for(int i=0; i<3; ++i){
+			uint32 v= indices[triangle*3+i];
+			output.push_back(v);
+			if(find(newCache.begin(), newCache.end(), v)==newCache.end()){
+				newCache.push_back(v);
+			}
+
+			uint32 *span= &vertexTriangles[triangleStarts[v]];
+			for(int j=0; j<remainingTriangles[v]; ++j){
+				if(span[j]==triangle){
+					span[j]= span[remainingTriangles[v]-1];
+					--remainingTriangles[v];
+					break;
+				}
+			}
+		}
+
+		//the vertices used go to the front of the cache
+		for(size_t i=0; i<cache.size(); ++i){
+			if(find(newCache.begin(), newCache.end(), cache[i])==newCache.end()){
+				newCache.push_back(cache[i]);
+			}
+		}
+		for(size_t i=0; i<newCache.size(); ++i){
+			uint32 v= newCache[i];
+			cachePositions[v]= i<cacheSize? static_cast<int>(i): -1;
+			vertexScores[v]= computeVertexScore(cachePositions[v], remainingTriangles[v]);
+		}
+
+		//rescore the triangles of the touched vertices, the best one goes next
+		bestTriangle= -1;
+		for(size_t i=0; i<newCache.size(); ++i){
+			uint32 v= newCache[i];
+			for(int j=0; j<remainingTriangles[v]; ++j){
+				uint32 t= vertexTriangles[triangleStarts[v]+j];
+				triangleScores[t]= vertexScores[indices[t*3]] + vertexScores[indices[t*3+1]] + vertexScores[indices[t*3+2]];
+				if(bestTriangle<0 || triangleScores[t]>triangleScores[bestTriangle]){
+					bestTriangle= t;
+				}
+			}
+		}
+
+		if(newCache.size()>cacheSize){
+			newCache.resize(cacheSize);
+		}
+		cache.swap(newCache);
+	}
+
+	copy(output.begin(), output.end(), indices);
+}
+
+void encodeOctahedral(const Vec3f &normal, int16 *out){
+	float l1= fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+	if(l1==0.f){
+		out[0]= 0;
+		out[1]= 0;
+		return;
+	}
+
+	float x= normal.x/l1;
+	float y= normal.y/l1;
+
+	//lower hemisphere is folded over the diagonals
+	if(normal.z<0.f){
+		float foldedX= (1.f-fabsf(y))*signNotZero(x);
+		float foldedY= (1.f-fabsf(x))*signNotZero(y);
+		x= foldedX;
+		y= foldedY;
+	}
+	out[0]= toSnorm16(x);
+	out[1]= toSnorm16(y);
+}
+
+Vec3f decodeOctahedral(const int16 *in){
+	float x= in[0]/32767.f;
+	float y= in[1]/32767.f;
+	float z= 1.f-fabsf(x)-fabsf(y);
+	
+	if(z<0.f){
+		float unfoldedX= (1.f-fabsf(y))*signNotZero(x);
+		float unfoldedY= (1.f-fabsf(x))*signNotZero(y);
+		x= unfoldedX;
+		y= unfoldedY;
+	}
+	
+	Vec3f normal(x, y, z);
+	normal.normalize();
+	return normal;
+}
+
+uint16 quantize(float value, float minValue, float size){
+	if(size<=0.f){
+		return 0;
+	}
+	
+	float f= floorf((value-minValue)/size*65535.f+0.5f);
+	return static_cast<uint16>(f<0.f? 0.f: (f>65535.f? 65535.f: f));
+}
+
+float dequantize(uint16 value, float minValue, float size){
+	return minValue + value*(size/65535.f);
+}
+
+}}//end namespace
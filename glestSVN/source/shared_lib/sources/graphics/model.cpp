@@ -12,10 +12,13 @@
 #include "model.h"
 
 #include <cstdio>
+#include <cstring>
 #include <cassert>
 #include <stdexcept>
+#include <vector>
 
 #include "interpolation.h"
+#include "mesh_encoding.h"
 #include "conversion.h"
 #include "util.h"
 #include "leak_dumper.h"
@@ -41,15 +44,25 @@ Mesh::Mesh(){
 
 	vertices= NULL;
 	normals= NULL;
+	quantizedVertices= NULL;
+	encodedNormals= NULL;
+	positionMin= Vec3f(0.f);
+	positionSize= Vec3f(0.f);
 	texCoords= NULL;
 	tangents= NULL;
 	indices= NULL;
+	shortIndices= NULL;
 	interpolationData= NULL;
 
 	for(int i=0; i<meshTextureCount; ++i){
 		textures[i]= NULL;
 	}
 
+	diffuseColor= Vec3f(1.f);
+	specularColor= Vec3f(0.f);
+	specularPower= 0.f;
+	opacity= 1.f;
+
 	twoSided= false;
 	customColor= false;
 }
@@ -58,23 +71,56 @@ Mesh::~Mesh(){
 	end();
 }
 
-void Mesh::init(){
-	vertices= new Vec3f[frameCount*vertexCount];
-	normals= new Vec3f[frameCount*vertexCount];
+void Mesh::init(bool quantized){
+	if(quantized){
+		quantizedVertices= new uint16[frameCount*vertexCount*3];
+		encodedNormals= new int16[frameCount*vertexCount*2];
+	}
+	else{
+		vertices= new Vec3f[frameCount*vertexCount];
+		normals= new Vec3f[frameCount*vertexCount];
+	}
 	texCoords= new Vec2f[vertexCount];
-	indices= new uint32[indexCount];
+	if(vertexCount<=maxShortIndexVertexCount){
+		shortIndices= new uint16[indexCount];
+	}
+	else{
+		indices= new uint32[indexCount];
+	}
 }
 
 void Mesh::end(){
 	delete [] vertices;
 	delete [] normals;
+	delete [] quantizedVertices;
+	delete [] encodedNormals;
 	delete [] texCoords;
 	delete [] tangents;
 	delete [] indices;
+	delete [] shortIndices;
 
 	delete interpolationData;
 }
 
+// ==================== get ==================== 
+
+Vec3f Mesh::getVertex(uint32 i) const{
+	if(quantizedVertices==NULL){
+		return vertices[i];
+	}
+	return Vec3f(
+		dequantize(quantizedVertices[i*3], positionMin.x, positionSize.x),
+		dequantize(quantizedVertices[i*3+1], positionMin.y, positionSize.y),
+		dequantize(quantizedVertices[i*3+2], positionMin.z, positionSize.z));
+}
+
+Vec3f Mesh::getNormal(uint32 i) const{
+	if(encodedNormals==NULL){
+		return normals[i];
+	}
+	return decodeOctahedral(&encodedNormals[i*2]);
+}
+
 // ========================== shadows & interpolation =========================
 
 void Mesh::buildInterpolationData(){
@@ -117,27 +163,20 @@ void Mesh::loadV2(const string &dir, FILE *f, TextureManager *textureManager){
 	customColor= false;
 	
 	//texture
-	if(meshHeader.hasTexture && textureManager!=NULL){
-		texturePaths[mtDiffuse]= toLower(reinterpret_cast<char*>(meshHeader.texName));
-		string texPath= dir+"/"+texturePaths[mtDiffuse];
-
-		textures[mtDiffuse]= static_cast<Texture2D*>(textureManager->getTexture(texPath));
-		if(textures[mtDiffuse]==NULL){
-			textures[mtDiffuse]= textureManager->newTexture2D();
-			textures[mtDiffuse]->load(texPath);
-		}
+	if(meshHeader.hasTexture){
+		loadMap(mtDiffuse, dir, toLower(reinterpret_cast<char*>(meshHeader.texName)), textureManager);
 	}
 
 	//read data
 	fread(vertices, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
 	fread(normals, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
-	if(textures[mtDiffuse]!=NULL){
+	if(meshHeader.hasTexture){
 		fread(texCoords, sizeof(Vec2f)*vertexCount, 1, f);
 	}
 	fread(&diffuseColor, sizeof(Vec3f), 1, f);
 	fread(&opacity, sizeof(float32), 1, f);
 	fseek(f, sizeof(Vec4f)*(meshHeader.colorFrameCount-1), SEEK_CUR);
-	fread(indices, sizeof(uint32)*indexCount, 1, f);
+	readIndices(f, false);
 }
 
 void Mesh::loadV3(const string &dir, FILE *f, TextureManager *textureManager){
@@ -162,21 +201,15 @@ void Mesh::loadV3(const string &dir, FILE *f, TextureManager *textureManager){
 	customColor= (meshHeader.properties & mp3CustomColor) != 0;
 	
 	//texture
-	if(!(meshHeader.properties & mp3NoTexture) && textureManager!=NULL){
-		texturePaths[mtDiffuse]= toLower(reinterpret_cast<char*>(meshHeader.texName));
-		string texPath= dir+"/"+texturePaths[mtDiffuse];
-
-		textures[mtDiffuse]= static_cast<Texture2D*>(textureManager->getTexture(texPath));
-		if(textures[mtDiffuse]==NULL){
-			textures[mtDiffuse]= textureManager->newTexture2D();
-			textures[mtDiffuse]->load(texPath);
-		}
+	bool hasTexture= !(meshHeader.properties & mp3NoTexture);
+	if(hasTexture){
+		loadMap(mtDiffuse, dir, toLower(reinterpret_cast<char*>(meshHeader.texName)), textureManager);
 	}
 
 	//read data
 	fread(vertices, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
 	fread(normals, sizeof(Vec3f)*frameCount*vertexCount, 1, f);
-	if(textures[mtDiffuse]!=NULL){
+	if(hasTexture){
 		for(int i=0; i<meshHeader.texCoordFrameCount; ++i){
 			fread(texCoords, sizeof(Vec2f)*vertexCount, 1, f);
 		}
@@ -184,7 +217,7 @@ void Mesh::loadV3(const string &dir, FILE *f, TextureManager *textureManager){
 	fread(&diffuseColor, sizeof(Vec3f), 1, f);
 	fread(&opacity, sizeof(float32), 1, f);
 	fseek(f, sizeof(Vec4f)*(meshHeader.colorFrameCount-1), SEEK_CUR);
-	fread(indices, sizeof(uint32)*indexCount, 1, f);
+	readIndices(f, false);
 }
 
 void Mesh::load(const string &dir, FILE *f, TextureManager *textureManager){
@@ -212,21 +245,10 @@ void Mesh::load(const string &dir, FILE *f, TextureManager *textureManager){
 	//maps
 	uint32 flag= 1;
 	for(int i=0; i<meshTextureCount; ++i){
-		if((meshHeader.textures & flag) && textureManager!=NULL){
+		if(meshHeader.textures & flag){
 			uint8 cMapPath[mapPathSize];
 			fread(cMapPath, mapPathSize, 1, f);
-			string mapPath= toLower(reinterpret_cast<char*>(cMapPath));
-
-			string mapFullPath= dir + "/" + mapPath;
-
-			textures[i]= static_cast<Texture2D*>(textureManager->getTexture(mapFullPath));
-			if(textures[i]==NULL){
-				textures[i]= textureManager->newTexture2D();
-				if(meshTextureChannelCount[i]!=-1){
-					textures[i]->getPixmap()->init(meshTextureChannelCount[i]);
-				}
-				textures[i]->load(mapFullPath);
-			}
+			loadMap(i, dir, toLower(reinterpret_cast<char*>(cMapPath)), textureManager);
 		}
 		flag*= 2;
 	}
@@ -237,7 +259,7 @@ void Mesh::load(const string &dir, FILE *f, TextureManager *textureManager){
 	if(meshHeader.textures!=0){
 		fread(texCoords, sizeof(Vec2f)*vertexCount, 1, f);
 	}
-	fread(indices, sizeof(uint32)*indexCount, 1, f);
+	readIndices(f, false);
 
 	//tangents
 	if(textures[mtNormal]!=NULL){
@@ -245,34 +267,250 @@ void Mesh::load(const string &dir, FILE *f, TextureManager *textureManager){
 	}
 }
 
-void Mesh::save(const string &dir, FILE *f){
-	/*MeshHeader meshHeader;
-	meshHeader.vertexFrameCount= vertexFrameCount;
-	meshHeader.normalFrameCount= normalFrameCount;
-	meshHeader.texCoordFrameCount= texCoordFrameCount;
-	meshHeader.colorFrameCount= colorFrameCount;
-	meshHeader.pointCount= pointCount;
-	meshHeader.indexCount= indexCount;
-	meshHeader.properties= 0;
+void Mesh::loadV5(const string &dir, FILE *f, TextureManager *textureManager){
+	//read header
+	MeshHeaderV5 meshHeader;
+	fread(&meshHeader, sizeof(MeshHeaderV5), 1, f);
+	
+	//init, animated meshes stay quantized and are decoded as they are interpolated
+	frameCount= meshHeader.frameCount;
+	vertexCount= meshHeader.vertexCount;
+	indexCount= meshHeader.indexCount;
+	positionMin= Vec3f(meshHeader.positionMin);
+	positionSize= Vec3f(meshHeader.positionSize);
+
+	bool quantized= frameCount>1;
+	init(quantized);
 
-	if(twoSided) meshHeader.properties|= mpTwoSided;
-	if(customTexture) meshHeader.properties|= mpCustomTexture;
+	//properties
+	customColor= (meshHeader.properties & mpfCustomColor) != 0;
+	twoSided= (meshHeader.properties & mpfTwoSided) != 0;
+	
+	//material
+	diffuseColor= Vec3f(meshHeader.diffuseColor);
+	specularColor= Vec3f(meshHeader.specularColor);
+	specularPower= meshHeader.specularPower;
+	opacity= meshHeader.opacity;
 
-	if(texture==NULL){
-		meshHeader.properties|= mpNoTexture;
-		meshHeader.texName[0]= '\0';
+	//maps
+	uint32 flag= 1;
+	for(int i=0; i<meshTextureCount; ++i){
+		if(meshHeader.textures & flag){
+			uint8 cMapPath[mapPathSize];
+			fread(cMapPath, mapPathSize, 1, f);
+			loadMap(i, dir, toLower(reinterpret_cast<char*>(cMapPath)), textureManager);
+		}
+		flag*= 2;
+	}
+
+	uint32 count= frameCount*vertexCount;
+	vector<uint16> data(count*3);
+
+	//positions, frames after the first one are deltas that wrap around
+	if(count>0){
+		fread(&data[0], sizeof(uint16)*count*3, 1, f);
+	}
+	for(uint32 i=vertexCount*3; i<count*3; ++i){
+		data[i]+= data[i-vertexCount*3];
+	}
+	if(quantized){
+		copy(data.begin(), data.begin()+count*3, quantizedVertices);
 	}
 	else{
-		strcpy(reinterpret_cast<char*>(meshHeader.texName), texName.c_str());
-		texture->getPixmap()->saveTga(dir+"/"+texName);
+		for(uint32 i=0; i<count; ++i){
+			for(int j=0; j<3; ++j){
+				vertices[i].ptr()[j]= dequantize(data[i*3+j], positionMin.ptr()[j], positionSize.ptr()[j]);
+			}
+		}
+	}
+
+	//normals, stored the same way
+	if(count>0){
+		fread(&data[0], sizeof(uint16)*count*2, 1, f);
+	}
+	for(uint32 i=vertexCount*2; i<count*2; ++i){
+		data[i]+= data[i-vertexCount*2];
+	}
+	for(uint32 i=0; i<count; ++i){
+		int16 encodedNormal[2]= {static_cast<int16>(data[i*2]), static_cast<int16>(data[i*2+1])};
+		if(quantized){
+			encodedNormals[i*2]= encodedNormal[0];
+			encodedNormals[i*2+1]= encodedNormal[1];
+		}
+		else{
+			normals[i]= decodeOctahedral(encodedNormal);
+		}
+	}
+	
+	//tex coords and indices
+	if(meshHeader.textures!=0){
+		fread(texCoords, sizeof(Vec2f)*vertexCount, 1, f);
+	}
+	readIndices(f, (meshHeader.encoding & mefShortIndices)!=0);
+
+	//tangents
+	if(textures[mtNormal]!=NULL){
+		computeTangents();
+	}
+}
+
+//writes the mesh in version 5 format
+void Mesh::save(FILE *f) const{
+	uint32 count= frameCount*vertexCount;
+
+	//triangles in vertex cache order
+	vector<uint32> optimizedIndices(indexCount);
+	for(uint32 i=0; i<indexCount; ++i){
+		optimizedIndices[i]= getIndex(i);
+	}
+	if(indexCount>0){
+		optimizeVertexCache(&optimizedIndices[0], indexCount, vertexCount);
+	}
+
+	//quantization box
+	Vec3f minPos(0.f);
+	Vec3f maxPos(0.f);
+	for(uint32 i=0; i<count; ++i){
+		Vec3f v= getVertex(i);
+		if(i==0){
+			minPos= v;
+			maxPos= v;
+		}
+		else{
+			minPos= Vec3f(min(minPos.x, v.x), min(minPos.y, v.y), min(minPos.z, v.z));
+			maxPos= Vec3f(max(maxPos.x, v.x), max(maxPos.y, v.y), max(maxPos.z, v.z));
+		}
+	}
+	Vec3f size= maxPos-minPos;
+
+	//header
+	MeshHeaderV5 meshHeader;
+	memset(&meshHeader, 0, sizeof(MeshHeaderV5));
+	meshHeader.frameCount= frameCount;
+	meshHeader.vertexCount= vertexCount;
+	meshHeader.indexCount= indexCount;
+	for(int i=0; i<3; ++i){
+		meshHeader.diffuseColor[i]= diffuseColor.ptr()[i];
+		meshHeader.specularColor[i]= specularColor.ptr()[i];
+		meshHeader.positionMin[i]= minPos.ptr()[i];
+		meshHeader.positionSize[i]= size.ptr()[i];
+	}
+	meshHeader.specularPower= specularPower;
+	meshHeader.opacity= opacity;
+	meshHeader.properties= (customColor? mpfCustomColor: 0) | (twoSided? mpfTwoSided: 0);
+	for(int i=0; i<meshTextureCount; ++i){
+		if(!texturePaths[i].empty()){
+			meshHeader.textures|= 1<<i;
+		}
+	}
+	bool shortIndices= vertexCount<=maxShortIndexVertexCount;
+	meshHeader.encoding= shortIndices? mefShortIndices: 0;
+	fwrite(&meshHeader, sizeof(MeshHeaderV5), 1, f);
+
+	//maps
+	for(int i=0; i<meshTextureCount; ++i){
+		if(!texturePaths[i].empty()){
+			char cMapPath[mapPathSize];
+			memset(cMapPath, 0, mapPathSize);
+			strncpy(cMapPath, texturePaths[i].c_str(), mapPathSize-1);
+			fwrite(cMapPath, mapPathSize, 1, f);
+		}
+	}
+
+	//positions, each frame as a delta of the previous one
+	vector<uint16> data(count*3);
+	for(uint32 i=0; i<count; ++i){
+		Vec3f v= getVertex(i);
+		for(int j=0; j<3; ++j){
+			data[i*3+j]= quantize(v.ptr()[j], minPos.ptr()[j], size.ptr()[j]);
+		}
+	}
+	for(uint32 i=count*3; i>vertexCount*3; --i){
+		data[i-1]-= data[i-1-vertexCount*3];
+	}
+	if(count>0){
+		fwrite(&data[0], sizeof(uint16)*count*3, 1, f);
+	}
+
+	//normals
+	for(uint32 i=0; i<count; ++i){
+		int16 encodedNormal[2];
+		encodeOctahedral(getNormal(i), encodedNormal);
+		data[i*2]= static_cast<uint16>(encodedNormal[0]);
+		data[i*2+1]= static_cast<uint16>(encodedNormal[1]);
+	}
+	for(uint32 i=count*2; i>vertexCount*2; --i){
+		data[i-1]-= data[i-1-vertexCount*2];
+	}
+	if(count>0){
+		fwrite(&data[0], sizeof(uint16)*count*2, 1, f);
+	}
+
+	//tex coords
+	if(meshHeader.textures!=0){
+		fwrite(texCoords, sizeof(Vec2f)*vertexCount, 1, f);
+	}
+
+	//indices
+	if(shortIndices){
+		vector<uint16> fileIndices(optimizedIndices.begin(), optimizedIndices.end());
+		if(indexCount>0){
+			fwrite(&fileIndices[0], sizeof(uint16)*indexCount, 1, f);
+		}
+	}
+	else if(indexCount>0){
+		fwrite(&optimizedIndices[0], sizeof(uint32)*indexCount, 1, f);
+	}
+}
+
+// ==================== PRIVATE ==================== 
+
+//the path is kept for saving, the texture is only loaded with a texture manager
+void Mesh::loadMap(int i, const string &dir, const string &mapPath, TextureManager *textureManager){
+	texturePaths[i]= mapPath;
+	if(textureManager==NULL){
+		return;
+	}
+
+	string mapFullPath= dir + "/" + mapPath;
+
+	textures[i]= static_cast<Texture2D*>(textureManager->getTexture(mapFullPath));
+	if(textures[i]==NULL){
+		textures[i]= textureManager->newTexture2D();
+		if(meshTextureChannelCount[i]!=-1){
+			textures[i]->getPixmap()->init(meshTextureChannelCount[i]);
+		}
+		textures[i]->load(mapFullPath);
+	}
+}
+
+//reads 16 or 32 bit indices into the storage init chose
+void Mesh::readIndices(FILE *f, bool fileShortIndices){
+	if(indexCount==0){
+		return;
 	}
 	
-	fwrite(&meshHeader, sizeof(MeshHeader), 1, f);
-	fwrite(vertices, sizeof(Vec3f)*vertexFrameCount*pointCount, 1, f);
-	fwrite(normals, sizeof(Vec3f)*normalFrameCount*pointCount, 1, f);
-	fwrite(texCoords, sizeof(Vec2f)*texCoordFrameCount*pointCount, 1, f);
-	fwrite(colors, sizeof(Vec4f)*colorFrameCount, 1, f);
-	fwrite(indices, sizeof(uint32)*indexCount, 1, f);*/
+	if(fileShortIndices && shortIndices!=NULL){
+		fread(shortIndices, sizeof(uint16)*indexCount, 1, f);
+	}
+	else if(fileShortIndices){
+		vector<uint16> fileIndices(indexCount);
+		fread(&fileIndices[0], sizeof(uint16)*indexCount, 1, f);
+		copy(fileIndices.begin(), fileIndices.end(), indices);
+	}
+	else if(shortIndices!=NULL){
+		vector<uint32> fileIndices(indexCount);
+		fread(&fileIndices[0], sizeof(uint32)*indexCount, 1, f);
+		for(uint32 i=0; i<indexCount; ++i){
+			if(fileIndices[i]>=vertexCount){
+				throw runtime_error("Index out of range: " + intToStr(fileIndices[i]));
+			}
+			shortIndices[i]= static_cast<uint16>(fileIndices[i]);
+		}
+	}
+	else{
+		fread(indices, sizeof(uint32)*indexCount, 1, f);
+	}
 }
 
 void Mesh::computeTangents(){
@@ -284,13 +522,13 @@ void Mesh::computeTangents(){
 
 	for(int i=0; i<indexCount; i+=3){
 		for(int j=0; j<3; ++j){
-			uint32 i0= indices[i+j];
-			uint32 i1= indices[i+(j+1)%3];
-			uint32 i2= indices[i+(j+2)%3];
+			uint32 i0= getIndex(i+j);
+			uint32 i1= getIndex(i+(j+1)%3);
+			uint32 i2= getIndex(i+(j+2)%3);
 
-			Vec3f p0= vertices[i0];
-			Vec3f p1= vertices[i1];
-			Vec3f p2= vertices[i2];
+			Vec3f p0= getVertex(i0);
+			Vec3f p1= getVertex(i1);
+			Vec3f p2= getVertex(i2);
 
 			float u0= texCoords[i0].x;
 			float u1= texCoords[i1].x;
@@ -323,6 +561,8 @@ Model::Model(){
 	meshCount= 0;
 	meshes= NULL;
 	textureManager= NULL;
+	boundingCenter= Vec3f(0.f);
+	boundingRadius= 0.f;
 }
 
 Model::~Model(){
@@ -349,6 +589,40 @@ void Model::updateInterpolationVertices(float t, bool cycle) const{
 	}
 }
 
+//sphere around the bounding box of every vertex in every frame
+void Model::computeBounds(){
+	bool empty= true;
+	Vec3f minPos(0.f);
+	Vec3f maxPos(0.f);
+
+	for(uint32 i=0; i<meshCount; ++i){
+		const Mesh *mesh= &meshes[i];
+		uint32 count= mesh->getFrameCount()*mesh->getVertexCount();
+		for(uint32 j=0; j<count; ++j){
+			Vec3f v= mesh->getVertex(j);
+			if(empty){
+				minPos= v;
+				maxPos= v;
+				empty= false;
+			}
+			else{
+				minPos= Vec3f(min(minPos.x, v.x), min(minPos.y, v.y), min(minPos.z, v.z));
+				maxPos= Vec3f(max(maxPos.x, v.x), max(maxPos.y, v.y), max(maxPos.z, v.z));
+			}
+		}
+	}
+
+	boundingCenter= (minPos+maxPos)/2.f;
+	boundingRadius= 0.f;
+	for(uint32 i=0; i<meshCount; ++i){
+		const Mesh *mesh= &meshes[i];
+		uint32 count= mesh->getFrameCount()*mesh->getVertexCount();
+		for(uint32 j=0; j<count; ++j){
+			boundingRadius= max(boundingRadius, boundingCenter.dist(mesh->getVertex(j)));
+		}
+	}
+}
+
 // ==================== get ==================== 
 
 uint32 Model::getTriangleCount() const{
@@ -381,8 +655,8 @@ void Model::load(const string &path){
 
 void Model::save(const string &path){
 	string extension= path.substr(path.find_last_of('.')+1);
-	if(extension=="g3d" ||extension=="G3D" || extension=="s3d" || extension=="S3D"){
-		saveS3d(path);
+	if(extension=="g3d" || extension=="G3D"){
+		saveG3d(path);
 	}
 	else{
 		throw runtime_error("Unknown model format: " + extension);
@@ -446,8 +720,26 @@ void Model::loadG3d(const string &path){
 		}
 		fileVersion= fileHeader.version;
 
+		//version 5
+		if(fileHeader.version==5){
+
+			//model header
+			ModelHeader modelHeader;
+			fread(&modelHeader, sizeof(ModelHeader), 1, f);
+			meshCount= modelHeader.meshCount;
+			if(modelHeader.type!=mtMorphMesh){
+				throw runtime_error("Invalid model type");
+			}
+
+			//load meshes
+			meshes= new Mesh[meshCount];
+			for(uint32 i=0; i<meshCount; ++i){
+				meshes[i].loadV5(dir, f, textureManager);
+				meshes[i].buildInterpolationData();
+			}
+		}
 		//version 4
-		if(fileHeader.version==4){
+		else if(fileHeader.version==4){
 
 			//model header
 			ModelHeader modelHeader;
@@ -489,35 +781,38 @@ void Model::loadG3d(const string &path){
 		}
 
 		fclose(f);
+
+		computeBounds();
     }
 	catch(exception &e){
 		throw runtime_error("Exception caught loading 3d file: " + path +"\n"+ e.what());
 	}
 }
 
-//save a model to a g3d file
-void Model::saveS3d(const string &path){
-	
-	/*FILE *f= fopen(path.c_str(), "wb");
+//save a model to a g3d file, always in the latest version
+void Model::saveG3d(const string &path) const{
+	FILE *f= fopen(path.c_str(), "wb");
 	if(f==NULL){
-		throw runtime_error("Cant open file for writting: "+path);
+		throw runtime_error("Can't open file for writing: "+path);
 	}
 
+	FileHeader fileHeader;
+	fileHeader.id[0]= 'G';
+	fileHeader.id[1]= '3';
+	fileHeader.id[2]= 'D';
+	fileHeader.version= 5;
+	fwrite(&fileHeader, sizeof(FileHeader), 1, f);
+
 	ModelHeader modelHeader;
-	modelHeader.id[0]= 'G';
-	modelHeader.id[1]= '3';
-	modelHeader.id[2]= 'D';
-	modelHeader.version= 3;
 	modelHeader.meshCount= meshCount;
-
-	string dir= cutLastFile(path);
-
+	modelHeader.type= mtMorphMesh;
 	fwrite(&modelHeader, sizeof(ModelHeader), 1, f);
-	for(int i=0; i<meshCount; ++i){
-		meshes[i].save(dir, f);
+
+	for(uint32 i=0; i<meshCount; ++i){
+		meshes[i].save(f);
 	}
 
-	fclose(f);*/
+	fclose(f);
 }
 
 }}//end namespace
@@ -29,9 +29,16 @@ namespace Shared{ namespace Graphics{
 
 ParticleSystem::ParticleSystem(int particleCount){
 
-	//init particle vector
+	//particle arrays, allocated on demand
 	blendMode = bmOne;
-	particles= new Particle[particleCount];
+	positions= NULL;
+	lastPositions= NULL;
+	speeds= NULL;
+	accels= NULL;
+	colors= NULL;
+	sizes= NULL;
+	energies= NULL;
+	particleCapacity= 0;
 	state= sPlay;
 	aliveParticleCount=0;
 	active= true;
@@ -50,10 +57,19 @@ ParticleSystem::ParticleSystem(int particleCount){
 	colorNoEnergy= Vec4f(0.0f);
 	emissionRate= 15;
 	speed= 1.0f;
+	emissionScale= 1.0f;
+	emissionAccum= 0.0f;
+	emissionInterval= 0.0f;
 }
 
 ParticleSystem::~ParticleSystem(){
-	delete [] particles;
+	delete [] positions;
+	delete [] lastPositions;
+	delete [] speeds;
+	delete [] accels;
+	delete [] colors;
+	delete [] sizes;
+	delete [] energies;
 }
 
 
@@ -63,26 +79,21 @@ ParticleSystem::~ParticleSystem(){
 void ParticleSystem::update(){
 
 	if(state!=sPause){
-		for(int i=0; i<aliveParticleCount; ++i){
-			updateParticle(&particles[i]);
-
-			if(deathTest(&particles[i])){
-				
-				//kill the particle
-				killParticle(&particles[i]);
-
-				//mantain alive particles at front of the array
-				if(aliveParticleCount>0){
-					particles[i]= particles[aliveParticleCount];
-				}
-
-			}
-		}
-
-		if(state!=sFade){
-			for(int i=0; i<emissionRate; ++i){
-				Particle *p= createParticle();
-				initParticle(p, i);
+		updateParticles(0, aliveParticleCount);
+		killParticles();
+
+		if(state!=sFade && emissionRate>0){
+			
+			//emit a fraction of the rate when scaled down, carrying the rest over, 
+			//the particles of one update are spread over all of it, not packed at its start
+			float scaledRate= emissionRate*emissionScale;
+			emissionAccum+= scaledRate;
+			int emissionCount= static_cast<int>(emissionAccum);
+			emissionAccum-= emissionCount;
+			emissionInterval= scaledRate>0.0f? 1.0f/scaledRate: 0.0f;
+
+			for(int i=0; i<emissionCount; ++i){
+				initParticle(createParticle(), i);
 			}
 		}
 	}
@@ -149,6 +160,10 @@ void ParticleSystem::setVisible(bool visible){
 	this->visible= visible;
 }
 
+void ParticleSystem::setEmissionScale(float emissionScale){
+	this->emissionScale= clamp(emissionScale, 0.0f, 1.0f);
+}
+
 // =============== MISC =========================
 void ParticleSystem::fade(){
 	assert(state==sPlay);
@@ -167,51 +182,127 @@ int ParticleSystem::isEmpty() const{
 
 // if there is one dead particle it returns it else, return the particle with 
 // less energy
-Particle * ParticleSystem::createParticle(){
+int ParticleSystem::createParticle(){
 
 	//if any dead particles
 	if(aliveParticleCount<particleCount){
+		reserveParticles(aliveParticleCount+1);
 		++aliveParticleCount;
-		return &particles[aliveParticleCount-1];
+		return aliveParticleCount-1;
 	}
 
 	//if not
-	int minEnergy= particles[0].energy;
+	int minEnergy= energies[0];
 	int minEnergyParticle= 0;
 
 	for(int i=0; i<particleCount; ++i){
-		if(particles[i].energy<minEnergy){
-			minEnergy= particles[i].energy;
+		if(energies[i]<minEnergy){
+			minEnergy= energies[i];
 			minEnergyParticle= i;
 		}
 	}
 
-	return &particles[minEnergyParticle];
+	return minEnergyParticle;
 }
 
-void ParticleSystem::initParticle(Particle *p, int particleIndex){
-	p->pos= pos;
-	p->lastPos= p->pos;
-	p->speed= Vec3f(0.0f);
-	p->accel= Vec3f(0.0f);
-	p->color= Vec4f(1.0f, 1.0f, 1.0f, 1.0);
-	p->size= particleSize;
-	p->energy= maxParticleEnergy + random.randRange(-varParticleEnergy, varParticleEnergy);
+void ParticleSystem::moveParticle(int from, int to){
+	positions[to]= positions[from];
+	lastPositions[to]= lastPositions[from];
+	speeds[to]= speeds[from];
+	accels[to]= accels[from];
+	colors[to]= colors[from];
+	sizes[to]= sizes[from];
+	energies[to]= energies[from];
 }
 
-void ParticleSystem::updateParticle(Particle *p){
-	p->lastPos= p->pos;
-	p->pos= p->pos + p->speed;
-	p->speed= p->speed + p->accel;
-	p->energy--;
-}
+//grows the particle arrays so they can hold count particles
+void ParticleSystem::reserveParticles(int count){
+	if(count<=particleCapacity){
+		return;
+	}
+
+	int newCapacity= particleCapacity*2;
+	if(newCapacity<minParticleCapacity){
+		newCapacity= minParticleCapacity;
+	}
+	if(newCapacity<count){
+		newCapacity= count;
+	}
+	if(newCapacity>particleCount){
+		newCapacity= particleCount;
+	}
 
-bool ParticleSystem::deathTest(Particle *p){
-	return p->energy <= 0;
+	Vec3f *newPositions= new Vec3f[newCapacity];
+	Vec3f *newLastPositions= new Vec3f[newCapacity];
+	Vec3f *newSpeeds= new Vec3f[newCapacity];
+	Vec3f *newAccels= new Vec3f[newCapacity];
+	Vec4f *newColors= new Vec4f[newCapacity];
+	float *newSizes= new float[newCapacity];
+	int *newEnergies= new int[newCapacity];
+
+	for(int i=0; i<aliveParticleCount; ++i){
+		newPositions[i]= positions[i];
+		newLastPositions[i]= lastPositions[i];
+		newSpeeds[i]= speeds[i];
+		newAccels[i]= accels[i];
+		newColors[i]= colors[i];
+		newSizes[i]= sizes[i];
+		newEnergies[i]= energies[i];
+	}
+
+	delete [] positions;
+	delete [] lastPositions;
+	delete [] speeds;
+	delete [] accels;
+	delete [] colors;
+	delete [] sizes;
+	delete [] energies;
+
+	positions= newPositions;
+	lastPositions= newLastPositions;
+	speeds= newSpeeds;
+	accels= newAccels;
+	colors= newColors;
+	sizes= newSizes;
+	energies= newEnergies;
+	particleCapacity= newCapacity;
+}
+
+void ParticleSystem::initParticle(int i, int particleIndex){
+	positions[i]= pos;
+	lastPositions[i]= pos;
+	speeds[i]= Vec3f(0.0f);
+	accels[i]= Vec3f(0.0f);
+	colors[i]= Vec4f(1.0f, 1.0f, 1.0f, 1.0);
+	sizes[i]= particleSize;
+	energies[i]= maxParticleEnergy + random.randRange(-varParticleEnergy, varParticleEnergy);
+}
+
+void ParticleSystem::updateParticles(int begin, int end){
+	for(int i=begin; i<end; ++i){
+		lastPositions[i]= positions[i];
+	}
+	for(int i=begin; i<end; ++i){
+		positions[i]+= speeds[i];
+		speeds[i]+= accels[i];
+	}
+	for(int i=begin; i<end; ++i){
+		energies[i]--;
+	}
 }
 
-void ParticleSystem::killParticle(Particle *p){
-	aliveParticleCount--;
+//removes the particles without energy, keeping the alive ones at the front in order
+void ParticleSystem::killParticles(){
+	int alive= 0;
+	for(int i=0; i<aliveParticleCount; ++i){
+		if(energies[i]>0){
+			if(alive!=i){
+				moveParticle(i, alive);
+			}
+			++alive;
+		}
+	}
+	aliveParticleCount= alive;
 }
 
 // ===========================================================================
@@ -229,8 +320,8 @@ FireParticleSystem::FireParticleSystem(int particleCount): ParticleSystem(partic
 	setColorNoEnergy(Vec4f(1.0f, 0.5f, 0.0f, 1.0f));
 }
 
-void FireParticleSystem::initParticle(Particle *p, int particleIndex){
-	ParticleSystem::initParticle(p, particleIndex);
+void FireParticleSystem::initParticle(int i, int particleIndex){
+	ParticleSystem::initParticle(i, particleIndex);
 	
 	float ang= random.randRange(-2.0f*pi, 2.0f*pi);
 	float mod= fabsf(random.randRange(-radius, radius));
@@ -240,28 +331,32 @@ void FireParticleSystem::initParticle(Particle *p, int particleIndex){
 	
 	float radRatio= sqrtf(sqrtf(mod/radius));
 
-	p->color= colorNoEnergy*0.5f + colorNoEnergy*0.5f*radRatio;
-	p->energy= static_cast<int>(maxParticleEnergy*radRatio) + random.randRange(-varParticleEnergy, varParticleEnergy);
-	p->pos= Vec3f(pos.x+x, pos.y+random.randRange(-radius/2, radius/2), pos.z+y); 
-	p->lastPos= pos;
-	p->size= particleSize;
-	p->speed= Vec3f(0, speed+speed*random.randRange(-0.5f, 0.5f), 0) +  windSpeed;
+	colors[i]= colorNoEnergy*0.5f + colorNoEnergy*0.5f*radRatio;
+	energies[i]= static_cast<int>(maxParticleEnergy*radRatio) + random.randRange(-varParticleEnergy, varParticleEnergy);
+	positions[i]= Vec3f(pos.x+x, pos.y+random.randRange(-radius/2, radius/2), pos.z+y); 
+	lastPositions[i]= pos;
+	sizes[i]= particleSize;
+	speeds[i]= Vec3f(0, speed+speed*random.randRange(-0.5f, 0.5f), 0) +  windSpeed;
 }
 
-void FireParticleSystem::updateParticle(Particle *p){
-	p->lastPos= p->pos;
-	p->pos= p->pos+p->speed;
-	p->energy--;
-
-	if(p->color.x>0.0f)
-		p->color.x*= 0.98f;
-	if(p->color.y>0.0f)
-		p->color.y*= 0.98f;
-	if(p->color.w>0.0f)
-		p->color.w*= 0.98f;
-
-	p->speed.x*=1.001f;
-
+void FireParticleSystem::updateParticles(int begin, int end){
+	for(int i=begin; i<end; ++i){
+		lastPositions[i]= positions[i];
+		positions[i]+= speeds[i];
+		speeds[i].x*= 1.001f;
+	}
+	for(int i=begin; i<end; ++i){
+		energies[i]--;
+	}
+	for(int i=begin; i<end; ++i){
+		Vec4f &color= colors[i];
+		if(color.x>0.0f)
+			color.x*= 0.98f;
+		if(color.y>0.0f)
+			color.y*= 0.98f;
+		if(color.w>0.0f)
+			color.w*= 0.98f;
+	}
 }
 
 // ================= SET PARAMS ====================
@@ -295,21 +390,30 @@ void RainParticleSystem::render(ParticleRenderer *pr, ModelRenderer *mr){
 	pr->renderSystemLineAlpha(this);
 }
 
-void RainParticleSystem::initParticle(Particle *p, int particleIndex){
-	ParticleSystem::initParticle(p, particleIndex);
+void RainParticleSystem::initParticle(int i, int particleIndex){
+	ParticleSystem::initParticle(i, particleIndex);
 
 	float x= random.randRange(-radius, radius);
 	float y= random.randRange(-radius, radius);
 	
-	p->color= color;
-	p->energy= 10000;
-	p->pos= Vec3f(pos.x+x, pos.y, pos.z+y); 
-	p->lastPos= p->pos;
-	p->speed= Vec3f(random.randRange(-speed/10, speed/10), -speed, random.randRange(-speed/10, speed/10)) + windSpeed;
-}
-
-bool RainParticleSystem::deathTest(Particle *p){
-	return p->pos.y<0;
+	colors[i]= color;
+	energies[i]= 10000;
+	positions[i]= Vec3f(pos.x+x, pos.y, pos.z+y); 
+	lastPositions[i]= positions[i];
+	speeds[i]= Vec3f(random.randRange(-speed/10, speed/10), -speed, random.randRange(-speed/10, speed/10)) + windSpeed;
+}
+
+void RainParticleSystem::killParticles(){
+	int alive= 0;
+	for(int i=0; i<aliveParticleCount; ++i){
+		if(positions[i].y>=0){
+			if(alive!=i){
+				moveParticle(i, alive);
+			}
+			++alive;
+		}
+	}
+	aliveParticleCount= alive;
 }
 
 void RainParticleSystem::setRadius(float radius){
@@ -337,24 +441,33 @@ SnowParticleSystem::SnowParticleSystem(int particleCount):ParticleSystem(particl
 	setSpeed(0.025f);
 }
 
-void SnowParticleSystem::initParticle(Particle *p, int particleIndex){
+void SnowParticleSystem::initParticle(int i, int particleIndex){
 	
-	ParticleSystem::initParticle(p, particleIndex);
+	ParticleSystem::initParticle(i, particleIndex);
 
 	float x= random.randRange(-radius, radius);
 	float y= random.randRange(-radius, radius);
 	
-	p->color= color;
-	p->energy= 10000;
-	p->pos= Vec3f(pos.x+x, pos.y, pos.z+y); 
-	p->lastPos= p->pos;
-	p->speed= Vec3f(0.0f, -speed, 0.0f) +  windSpeed;
-	p->speed.x+= random.randRange(-0.005f, 0.005f);
-	p->speed.y+= random.randRange(-0.005f, 0.005f);
-}
-
-bool SnowParticleSystem::deathTest(Particle *p){	
-	return p->pos.y<0;
+	colors[i]= color;
+	energies[i]= 10000;
+	positions[i]= Vec3f(pos.x+x, pos.y, pos.z+y); 
+	lastPositions[i]= positions[i];
+	speeds[i]= Vec3f(0.0f, -speed, 0.0f) +  windSpeed;
+	speeds[i].x+= random.randRange(-0.005f, 0.005f);
+	speeds[i].y+= random.randRange(-0.005f, 0.005f);
+}
+
+void SnowParticleSystem::killParticles(){
+	int alive= 0;
+	for(int i=0; i<aliveParticleCount; ++i){
+		if(positions[i].y>=0){
+			if(alive!=i){
+				moveParticle(i, alive);
+			}
+			++alive;
+		}
+	}
+	aliveParticleCount= alive;
 }
 
 void SnowParticleSystem::setRadius(float radius){
@@ -505,29 +618,37 @@ void ProjectileParticleSystem::update(){
 	ParticleSystem::update();
 }
 
-void ProjectileParticleSystem::initParticle(Particle *p, int particleIndex){
+void ProjectileParticleSystem::initParticle(int i, int particleIndex){
 
-	ParticleSystem::initParticle(p, particleIndex);
+	ParticleSystem::initParticle(i, particleIndex);
 		
-	float t= static_cast<float>(particleIndex)/emissionRate;
+	//spaced along the path moved in this update
+	float t= clamp(particleIndex*emissionInterval, 0.0f, 1.0f);
 		
-	p->pos=	pos + (lastPos - pos) * t;
-	p->lastPos= lastPos;
-	p->speed= Vec3f(random.randRange(-0.1f, 0.1f), random.randRange(-0.1f, 0.1f), random.randRange(-0.1f, 0.1f)) * speed;
-	p->accel= Vec3f(0.0f, -gravity, 0.0f);
+	positions[i]= pos + (lastPos - pos) * t;
+	lastPositions[i]= lastPos;
+	speeds[i]= Vec3f(random.randRange(-0.1f, 0.1f), random.randRange(-0.1f, 0.1f), random.randRange(-0.1f, 0.1f)) * speed;
+	accels[i]= Vec3f(0.0f, -gravity, 0.0f);
 	
-	updateParticle(p);
+	updateParticles(i, i+1);
 }
 
-void ProjectileParticleSystem::updateParticle(Particle *p){
-	float energyRatio= clamp(static_cast<float>(p->energy)/maxParticleEnergy, 0.f, 1.f);
-		
-	p->lastPos+= p->speed;
-	p->pos+= p->speed;
-	p->speed+= p->accel;
-	p->color = color * energyRatio + colorNoEnergy * (1.0f-energyRatio);
-	p->size = particleSize * energyRatio + sizeNoEnergy * (1.0f-energyRatio);
-	p->energy--;
+void ProjectileParticleSystem::updateParticles(int begin, int end){
+	float invMaxEnergy= 1.0f/maxParticleEnergy;
+
+	for(int i=begin; i<end; ++i){
+		float energyRatio= clamp(energies[i]*invMaxEnergy, 0.f, 1.f);
+		colors[i]= color * energyRatio + colorNoEnergy * (1.0f-energyRatio);
+		sizes[i]= particleSize * energyRatio + sizeNoEnergy * (1.0f-energyRatio);
+	}
+	for(int i=begin; i<end; ++i){
+		lastPositions[i]+= speeds[i];
+		positions[i]+= speeds[i];
+		speeds[i]+= accels[i];
+	}
+	for(int i=begin; i<end; ++i){
+		energies[i]--;
+	}
 }
 
 void ProjectileParticleSystem::setPath(Vec3f startPos, Vec3f endPos){
@@ -606,42 +727,62 @@ void SplashParticleSystem::update(){
 	}
 }
 
-void SplashParticleSystem::initParticle(Particle *p, int particleIndex){
-	p->pos= pos;
-	p->lastPos= p->pos;
-	p->energy= maxParticleEnergy;
-	p->size= particleSize;
-	p->color= color;
+void SplashParticleSystem::initParticle(int i, int particleIndex){
+	positions[i]= pos;
+	lastPositions[i]= pos;
+	energies[i]= maxParticleEnergy;
+	sizes[i]= particleSize;
+	colors[i]= color;
 	
-	p->speed= Vec3f(
+	Vec3f particleSpeed= Vec3f(
 		horizontalSpreadA * random.randRange(-1.0f, 1.0f) + horizontalSpreadB, 
 		verticalSpreadA * random.randRange(-1.0f, 1.0f) + verticalSpreadB, 
 		horizontalSpreadA * random.randRange(-1.0f, 1.0f) + horizontalSpreadB);
-	p->speed.normalize();
-	p->speed= p->speed * speed;
+	particleSpeed.normalize();
+	speeds[i]= particleSpeed * speed;
 
-	p->accel= Vec3f(0.0f, -gravity, 0.0f);
+	accels[i]= Vec3f(0.0f, -gravity, 0.0f);
 }
 
-void SplashParticleSystem::updateParticle(Particle *p){
-	float energyRatio= clamp(static_cast<float>(p->energy)/maxParticleEnergy, 0.f, 1.f);
-		
-	p->lastPos= p->pos;
-	p->pos= p->pos + p->speed;
-	p->speed= p->speed + p->accel;
-	p->energy--;
-	p->color = color * energyRatio + colorNoEnergy * (1.0f-energyRatio);
-	p->size = particleSize * energyRatio + sizeNoEnergy * (1.0f-energyRatio);
+void SplashParticleSystem::updateParticles(int begin, int end){
+	float invMaxEnergy= 1.0f/maxParticleEnergy;
+
+	for(int i=begin; i<end; ++i){
+		float energyRatio= clamp(energies[i]*invMaxEnergy, 0.f, 1.f);
+		colors[i]= color * energyRatio + colorNoEnergy * (1.0f-energyRatio);
+		sizes[i]= particleSize * energyRatio + sizeNoEnergy * (1.0f-energyRatio);
+	}
+	for(int i=begin; i<end; ++i){
+		lastPositions[i]= positions[i];
+		positions[i]+= speeds[i];
+		speeds[i]+= accels[i];
+	}
+	for(int i=begin; i<end; ++i){
+		energies[i]--;
+	}
 }
 
 // ===========================================================================
 //  ParticleManager
 // ===========================================================================
 
+const float ParticleManager::hiddenEmissionScale= 0.25f;
+
+ParticleManager::ParticleManager(){
+	particleBudget= 0;
+	viewPos= Vec3f(0.0f);
+	lodDistance= 0.0f;
+}
+
 ParticleManager::~ParticleManager(){
 	end();
 }
 
+void ParticleManager::setView(const Vec3f &viewPos, float lodDistance){
+	this->viewPos= viewPos;
+	this->lodDistance= lodDistance;
+}
+
 void ParticleManager::render(ParticleRenderer *pr, ModelRenderer *mr) const{
 	list<ParticleSystem*>::const_iterator it;
 
@@ -655,8 +796,56 @@ void ParticleManager::render(ParticleRenderer *pr, ModelRenderer *mr) const{
 void ParticleManager::update(){
 	list<ParticleSystem*>::iterator it;
 
+	//take the systems and changes handed over since the last update
+	list<Change> pendingChanges;
+	handOverMutex.p();
+	particleSystems.splice(particleSystems.end(), newParticleSystems);
+	pendingChanges.swap(changes);
+	handOverMutex.v();
+
+	for(list<Change>::iterator cit=pendingChanges.begin(); cit!=pendingChanges.end(); ++cit){
+		switch(cit->second){
+		case ctFade:
+			cit->first->fade();
+			break;
+		case ctActivate:
+			cit->first->setActive(true);
+			break;
+		case ctDeactivate:
+			cit->first->setActive(false);
+			break;
+		}
+	}
+
+	//scale down emission when over budget
+	float budgetScale= 1.0f;
+	if(particleBudget>0){
+		int aliveParticleCount= 0;
+		for (it=particleSystems.begin(); it!=particleSystems.end(); it++){
+			aliveParticleCount+= (*it)->getAliveParticleCount();
+		}
+		if(aliveParticleCount>particleBudget){
+			budgetScale= static_cast<float>(particleBudget)/aliveParticleCount;
+		}
+	}
+
 	for (it=particleSystems.begin(); it!=particleSystems.end(); it++){
-		(*it)->update();
+		ParticleSystem *ps= *it;
+		
+		//hidden and far systems emit less
+		float emissionScale= budgetScale;
+		if(!ps->getVisible()){
+			emissionScale*= hiddenEmissionScale;
+		}
+		else if(lodDistance>0.0f){
+			float dist= ps->getPos().dist(viewPos);
+			if(dist>lodDistance){
+				emissionScale*= lodDistance/dist;
+			}
+		}
+		ps->setEmissionScale(emissionScale);
+
+		ps->update();
 		if((*it)->isEmpty()){
 			delete *it;
 			*it= NULL;
@@ -665,11 +854,33 @@ void ParticleManager::update(){
 	particleSystems.remove(NULL);
 }
 
+//the system is rendered from the next update on
 void ParticleManager::manage(ParticleSystem *ps){
-	particleSystems.push_back(ps);
+	handOverMutex.p();
+	newParticleSystems.push_back(ps);
+	handOverMutex.v();
+}
+
+//the system fades from the next update on
+void ParticleManager::fade(ParticleSystem *ps){
+	handOverMutex.p();
+	changes.push_back(Change(ps, ctFade));
+	handOverMutex.v();
+}
+
+//the system is activated or paused from the next update on
+void ParticleManager::setActive(ParticleSystem *ps, bool active){
+	handOverMutex.p();
+	changes.push_back(Change(ps, active? ctActivate: ctDeactivate));
+	handOverMutex.v();
 }
 
 void ParticleManager::end(){
+	handOverMutex.p();
+	particleSystems.splice(particleSystems.end(), newParticleSystems);
+	changes.clear();
+	handOverMutex.v();
+
 	while(!particleSystems.empty()){
 		delete particleSystems.front();
 		particleSystems.pop_front();
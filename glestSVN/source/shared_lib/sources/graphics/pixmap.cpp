@@ -12,6 +12,7 @@
 #include "pixmap.h"
 
 #include <stdexcept>
+#include <algorithm>
 #include <cstdio>
 #include <cassert>
 
@@ -461,6 +462,12 @@ Pixmap2D::~Pixmap2D(){
 }
 
 void Pixmap2D::load(const string &path){
+	if(!PixmapCache::getInstance().take(path, this)){
+		decode(path);
+	}
+}
+
+void Pixmap2D::decode(const string &path){
 	string extension= path.substr(path.find_last_of('.')+1);
 	if(extension=="bmp"){
 		loadBmp(path);
@@ -754,10 +761,111 @@ void Pixmap2D::subCopy(int x, int y, const Pixmap2D *sourcePixmap){
 	delete pixel;
 }
 
+void Pixmap2D::swap(Pixmap2D *pixmap){
+	std::swap(w, pixmap->w);
+	std::swap(h, pixmap->h);
+	std::swap(components, pixmap->components);
+	std::swap(pixels, pixmap->pixels);
+}
+
 bool Pixmap2D::doDimensionsAgree(const Pixmap2D *pixmap){
 	return pixmap->getW() == w && pixmap->getH() == h;
 }
 
+// =====================================================
+//	class PixmapCache
+// =====================================================
+
+PixmapCache::PixmapCache(){
+	enabled= false;
+}
+
+PixmapCache &PixmapCache::getInstance(){
+	static PixmapCache pixmapCache;
+	return pixmapCache;
+}
+
+PixmapCache::~PixmapCache(){
+	clear();
+}
+
+//disabling drops every pixmap nobody took
+void PixmapCache::setEnabled(bool enabled){
+	mutex.p();
+	this->enabled= enabled;
+	if(!enabled){
+		clear();
+	}
+	mutex.v();
+}
+
+void PixmapCache::preload(const string &path){
+	string key= cleanPath(path);
+
+	mutex.p();
+	bool skip= !enabled || pixmaps.find(key)!=pixmaps.end() || claimedPaths.find(key)!=claimedPaths.end();
+	mutex.v();
+	if(skip){
+		return;
+	}
+
+	//decode without holding the lock, the owner may be loading other files
+	Pixmap2D *pixmap= new Pixmap2D();
+	try{
+		pixmap->decode(path);
+	}
+	catch(...){
+		delete pixmap;
+		throw;
+	}
+
+	mutex.p();
+	if(enabled && claimedPaths.find(key)==claimedPaths.end() && pixmaps.find(key)==pixmaps.end()){
+		pixmaps[key]= pixmap;
+		pixmap= NULL;
+	}
+	mutex.v();
+	delete pixmap;
+}
+
+//moves a preloaded pixmap into an empty one, the path is never preloaded again
+bool PixmapCache::take(const string &path, Pixmap2D *pixmap){
+	Pixmap2D *cachedPixmap= NULL;
+
+	mutex.p();
+	if(enabled){
+		string key= cleanPath(path);
+		claimedPaths.insert(key);
+		Pixmaps::iterator it= pixmaps.find(key);
+		if(it!=pixmaps.end()){
+			cachedPixmap= it->second;
+			pixmaps.erase(it);
+		}
+	}
+	mutex.v();
+
+	if(cachedPixmap==NULL){
+		return false;
+	}
+
+	bool compatible= pixmap->getPixels()==NULL && (pixmap->getComponents()==-1 || pixmap->getComponents()==cachedPixmap->getComponents());
+	if(compatible){
+		pixmap->swap(cachedPixmap);
+	}
+	delete cachedPixmap;
+	return compatible;
+}
+
+// ==================== PRIVATE ==================== 
+
+void PixmapCache::clear(){
+	for(Pixmaps::iterator it= pixmaps.begin(); it!=pixmaps.end(); ++it){
+		delete it->second;
+	}
+	pixmaps.clear();
+	claimedPaths.clear();
+}
+
 // =====================================================
 //	class Pixmap3D
 // =====================================================
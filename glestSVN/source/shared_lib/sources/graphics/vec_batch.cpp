@@ -0,0 +1,106 @@
+// ==============================================================
+//	This file is part of Glest Shared Library (www.glest.org)
+//
+//	Copyright (C) 2001-2008 Martio Figueroa
+//
+//	You can redistribute this code and/or modify it under 
+//	the terms of the GNU General Public License as published 
+//	by the Free Software Foundation; either version 2 of the 
+//	License, or (at your option) any later version
+// ==============================================================
+
+#include "vec_batch.h"
+
+#include <cmath>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE__)
+#	include <xmmintrin.h>
+#	define VEC_BATCH_SSE
+#endif
+
+#include "leak_dumper.h"
+
+namespace Shared{ namespace Graphics{
+
+// =====================================================
+//	Batch vector operations
+// =====================================================
+
+void lerpFloats(float t, const float *a, const float *b, float *out, int count){
+	int i= 0;
+
+#ifdef VEC_BATCH_SSE
+	__m128 t4= _mm_set1_ps(t);
+	for(; i+4<=count; i+= 4){
+		__m128 a4= _mm_loadu_ps(a+i);
+		__m128 b4= _mm_loadu_ps(b+i);
+		_mm_storeu_ps(out+i, _mm_add_ps(a4, _mm_mul_ps(t4, _mm_sub_ps(b4, a4))));
+	}
+#endif
+
+	for(; i<count; ++i){
+		out[i]= a[i] + t*(b[i]-a[i]);
+	}
+}
+
+void lerpFloats2(
+	float t, const float *a0, const float *b0, float *out0, 
+	const float *a1, const float *b1, float *out1, int count){
+	int i= 0;
+
+#ifdef VEC_BATCH_SSE
+	__m128 t4= _mm_set1_ps(t);
+	for(; i+4<=count; i+= 4){
+		__m128 a04= _mm_loadu_ps(a0+i);
+		__m128 b04= _mm_loadu_ps(b0+i);
+		__m128 a14= _mm_loadu_ps(a1+i);
+		__m128 b14= _mm_loadu_ps(b1+i);
+		_mm_storeu_ps(out0+i, _mm_add_ps(a04, _mm_mul_ps(t4, _mm_sub_ps(b04, a04))));
+		_mm_storeu_ps(out1+i, _mm_add_ps(a14, _mm_mul_ps(t4, _mm_sub_ps(b14, a14))));
+	}
+#endif
+
+	for(; i<count; ++i){
+		out0[i]= a0[i] + t*(b0[i]-a0[i]);
+		out1[i]= a1[i] + t*(b1[i]-a1[i]);
+	}
+}
+
+void normalizeVec3fs(Vec3f *vectors, int count){
+	int i= 0;
+
+#ifdef VEC_BATCH_SSE
+	//4 vectors are 3 registers, spread the 4 lengths over them to divide
+	__m128 zero= _mm_setzero_ps();
+	__m128 one= _mm_set1_ps(1.f);
+	for(; i+4<=count; i+= 4){
+		float *p= vectors[i].ptr();
+		__m128 lengths= _mm_sqrt_ps(_mm_setr_ps(
+			p[0]*p[0] + p[1]*p[1] + p[2]*p[2],
+			p[3]*p[3] + p[4]*p[4] + p[5]*p[5],
+			p[6]*p[6] + p[7]*p[7] + p[8]*p[8],
+			p[9]*p[9] + p[10]*p[10] + p[11]*p[11]));
+
+		//zero vectors get divided by one
+		__m128 nonZero= _mm_cmpgt_ps(lengths, zero);
+		lengths= _mm_or_ps(_mm_and_ps(nonZero, lengths), _mm_andnot_ps(nonZero, one));
+
+		__m128 d0= _mm_shuffle_ps(lengths, lengths, _MM_SHUFFLE(1, 0, 0, 0));
+		__m128 d1= _mm_shuffle_ps(lengths, lengths, _MM_SHUFFLE(2, 2, 1, 1));
+		__m128 d2= _mm_shuffle_ps(lengths, lengths, _MM_SHUFFLE(3, 3, 3, 2));
+		_mm_storeu_ps(p, _mm_div_ps(_mm_loadu_ps(p), d0));
+		_mm_storeu_ps(p+4, _mm_div_ps(_mm_loadu_ps(p+4), d1));
+		_mm_storeu_ps(p+8, _mm_div_ps(_mm_loadu_ps(p+8), d2));
+	}
+#endif
+
+	for(; i<count; ++i){
+		Vec3f &v= vectors[i];
+		float length= sqrtf(v.x*v.x + v.y*v.y + v.z*v.z);
+		if(length>0.f){
+			v= v/length;
+		}
+	}
+}
+
+}}//end namespace
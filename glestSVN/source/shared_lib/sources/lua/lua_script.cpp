@@ -27,6 +27,8 @@ namespace Shared{ namespace Lua{
 //	class LuaScript
 // =====================================================
 
+char LuaScript::hookKey;
+
 LuaScript::LuaScript(){
 	luaState= luaL_newstate();
 
@@ -37,6 +39,13 @@ LuaScript::LuaScript(){
 	}
 
 	argumentCount= -1;
+	instructionBudget= 0;
+	instructionCount= 0;
+	callDepth= 0;
+
+	//the count hook finds the script through the registry
+	lua_pushlightuserdata(luaState, this);
+	lua_rawsetp(luaState, LUA_REGISTRYINDEX, &hookKey);
 }
 
 LuaScript::~LuaScript(){
@@ -59,10 +68,45 @@ void LuaScript::loadCode(const string &code, const string &name){
 void LuaScript::beginCall(const string& functionName){
 	lua_getglobal(luaState, functionName.c_str());
 	argumentCount= 0;
+	
+	//nested calls share the budget of the outermost one
+	if(callDepth==0){
+		instructionCount= 0;
+	}
+	++callDepth;
+}
+
+void LuaScript::beginCall(int functionRef){
+	lua_rawgeti(luaState, LUA_REGISTRYINDEX, functionRef);
+	argumentCount= 0;
+	if(callDepth==0){
+		instructionCount= 0;
+	}
+	++callDepth;
+}
+
+//returns false if the call failed or ran out of instructions
+bool LuaScript::endCall(){
+	int errorCode= lua_pcall(luaState, argumentCount, 0, 0);
+	--callDepth;
+
+	if(errorCode!=0){
+		
+		//discard the error message, so it does not pile up in the stack
+		lua_pop(luaState, 1);
+		return false;
+	}
+	return true;
 }
 
-void LuaScript::endCall(){
-	lua_pcall(luaState, argumentCount, 0, 0);
+//returns a reference to a global function, or invalidRef if it is not defined
+int LuaScript::getFunctionRef(const string &functionName){
+	lua_getglobal(luaState, functionName.c_str());
+	if(!lua_isfunction(luaState, -1)){
+		lua_pop(luaState, 1);
+		return invalidRef;
+	}
+	return luaL_ref(luaState, LUA_REGISTRYINDEX);
 }
 
 void LuaScript::registerFunction(LuaFunction luaFunction, const string &functionName){
@@ -70,6 +114,16 @@ void LuaScript::registerFunction(LuaFunction luaFunction, const string &function
 	lua_setglobal(luaState, functionName.c_str());
 }
 
+void LuaScript::setInstructionBudget(int instructionBudget){
+	this->instructionBudget= instructionBudget;
+	if(instructionBudget>0){
+		lua_sethook(luaState, countHook, LUA_MASKCOUNT, hookInterval);
+	}
+	else{
+		lua_sethook(luaState, NULL, 0, 0);
+	}
+}
+
 string LuaScript::errorToString(int errorCode){
 
 	string error;
@@ -96,6 +150,18 @@ string LuaScript::errorToString(int errorCode){
 	return error;
 }
 
+//called every hookInterval instructions, aborts calls over the budget
+void LuaScript::countHook(LuaHandle *luaHandle, lua_Debug *debug){
+	lua_rawgetp(luaHandle, LUA_REGISTRYINDEX, &hookKey);
+	LuaScript *luaScript= static_cast<LuaScript*>(lua_touserdata(luaHandle, -1));
+	lua_pop(luaHandle, 1);
+
+	luaScript->instructionCount+= hookInterval;
+	if(luaScript->instructionCount>luaScript->instructionBudget){
+		luaL_error(luaHandle, "Instruction budget exceeded");
+	}
+}
+
 // =====================================================
 //	class LuaArguments
 // =====================================================
@@ -16,8 +16,10 @@
 #include <windows.h>
 
 #include "opengl.h"
+#include "math_util.h"
 #include "leak_dumper.h"
 
+using namespace Shared::Graphics;
 using namespace Shared::Graphics::Gl;
 
 namespace Shared{ namespace Platform{
@@ -79,7 +81,8 @@ void PlatformContextGl::swapBuffers(){
 //	Global Fcs  
 // ======================================
 
-void createGlFontBitmaps(uint32 &base, const string &type, int size, int width, int charCount, FontMetrics &metrics){
+//renders white glyphs on black into a top down dib, and keeps one channel as the atlas alpha
+void createGlFontAtlas(const string &type, int size, int width, int charCount, int columnCount, FontMetrics &metrics, Pixmap2D *atlas, int &cellW, int &cellH, int &baseline){
 	HFONT font= CreateFont(
 		size, 0, 0, 0, width, 0, FALSE, FALSE, ANSI_CHARSET,
 		OUT_DEFAULT_PRECIS, CLIP_DEFAULT_PRECIS, PROOF_QUALITY, 
@@ -87,9 +90,8 @@ void createGlFontBitmaps(uint32 &base, const string &type, int size, int width,
 
 	assert(font!=NULL);
 
-	HDC dc= wglGetCurrentDC();
-	SelectObject(dc, font);
-	BOOL err= wglUseFontBitmaps(dc, 0, charCount, base);
+	HDC dc= CreateCompatibleDC(wglGetCurrentDC());
+	HGDIOBJ oldFont= SelectObject(dc, font);
 		
 	FIXED one;
 	one.value= 1;
@@ -118,9 +120,58 @@ void createGlFontBitmaps(uint32 &base, const string &type, int size, int width,
 		}
 	}
 
-	DeleteObject(font);
+	//cell layout, one pixel apart so glyphs do not bleed
+	TEXTMETRIC textMetric;
+	GetTextMetrics(dc, &textMetric);
+	cellW= textMetric.tmMaxCharWidth+1;
+	cellH= textMetric.tmHeight+1;
+	baseline= cellH-textMetric.tmAscent;
+
+	int rowCount= (charCount+columnCount-1)/columnCount;
+	int w= next2Power(columnCount*cellW);
+	int h= next2Power(rowCount*cellH);
+
+	//glyph bitmap
+	BITMAPINFO bitmapInfo;
+	ZeroMemory(&bitmapInfo, sizeof(bitmapInfo));
+	bitmapInfo.bmiHeader.biSize= sizeof(BITMAPINFOHEADER);
+	bitmapInfo.bmiHeader.biWidth= w;
+	bitmapInfo.bmiHeader.biHeight= -h;
+	bitmapInfo.bmiHeader.biPlanes= 1;
+	bitmapInfo.bmiHeader.biBitCount= 32;
+	bitmapInfo.bmiHeader.biCompression= BI_RGB;
+
+	void *bits= NULL;
+	HBITMAP bitmap= CreateDIBSection(dc, &bitmapInfo, DIB_RGB_COLORS, &bits, NULL, 0);
+	assert(bitmap!=NULL);
+	HGDIOBJ oldBitmap= SelectObject(dc, bitmap);
+
+	RECT rect= {0, 0, w, h};
+	FillRect(dc, &rect, static_cast<HBRUSH>(GetStockObject(BLACK_BRUSH)));
+	SetBkMode(dc, TRANSPARENT);
+	SetTextColor(dc, RGB(255, 255, 255));
+	SetTextAlign(dc, TA_TOP | TA_LEFT);
 
-	assert(err);
+	for(int i=0; i<charCount; ++i){
+		char c= static_cast<char>(i);
+		TextOut(dc, (i%columnCount)*cellW, (i/columnCount)*cellH, &c, 1);
+	}
+	GdiFlush();
+
+	//the first atlas row is the bottom one, as OpenGL expects
+	const uint8 *pixels= static_cast<const uint8*>(bits);
+	atlas->init(w, h, 1);
+	for(int y=0; y<h; ++y){
+		for(int x=0; x<w; ++x){
+			atlas->setComponent(x, h-1-y, 0, pixels[(y*w+x)*4]);
+		}
+	}
+
+	SelectObject(dc, oldBitmap);
+	SelectObject(dc, oldFont);
+	DeleteObject(bitmap);
+	DeleteObject(font);
+	DeleteDC(dc);
 }
 
 // void createGlFontOutlines(uint32 &base, const string &type, int width, float depth, int charCount, FontMetrics &metrics){
@@ -13,6 +13,7 @@
 
 #include <io.h>
 #include <DbgHelp.h>
+#include <mmsystem.h>
 
 #include <cassert>
 
@@ -31,8 +32,6 @@ namespace Shared{ namespace Platform{
 // =====================================================
 
 void PerformanceTimer::init(int fps, int maxTimes){
-	int64 freq;
-
 	if(QueryPerformanceFrequency((LARGE_INTEGER*) &freq)==0){
 		throw runtime_error("Performance counters not supported");
 	}
@@ -62,6 +61,15 @@ void PerformanceTimer::reset(){
 	lastTicks= thisTicks;
 }
 
+//0 if the timer is already due
+int64 PerformanceTimer::getMicrosToNext() const{
+	int64 ticks;
+	QueryPerformanceCounter((LARGE_INTEGER*) &ticks);
+
+	int64 ticksToNext= lastTicks+updateTicks-ticks;
+	return ticksToNext<=0? 0: ticksToNext*1000000/freq;
+}
+
 // =====================================================
 //	class Chrono
 // =====================================================
@@ -254,6 +262,15 @@ void sleep(int millis){
 	Sleep(millis);
 }
 
+//makes sleep() accurate to a millisecond instead of the scheduler tick
+void beginPreciseSleep(){
+	timeBeginPeriod(1);
+}
+
+void endPreciseSleep(){
+	timeEndPeriod(1);
+}
+
 void showCursor(bool b){
 	ShowCursor(b);
 }
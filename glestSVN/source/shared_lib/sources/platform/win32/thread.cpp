@@ -43,6 +43,11 @@ void Thread::resume(){
 	ResumeThread(threadHandle);
 }
 
+void Thread::join(){
+	WaitForSingleObject(threadHandle, INFINITE);
+	CloseHandle(threadHandle);
+}
+
 // =====================================================
 //	class Mutex
 // =====================================================
@@ -59,8 +64,37 @@ void Mutex::p(){
     EnterCriticalSection(&mutex);
 }
 
+bool Mutex::tryP(){
+    return TryEnterCriticalSection(&mutex)!=0;
+}
+
 void Mutex::v(){
     LeaveCriticalSection(&mutex);
 }
 
+// =====================================================
+//	class Semaphore
+// =====================================================
+
+Semaphore::Semaphore(int initialCount){
+	semaphore= CreateSemaphore(NULL, initialCount, LONG_MAX, NULL);
+}
+
+Semaphore::~Semaphore(){
+	CloseHandle(semaphore);
+}
+
+void Semaphore::p(){
+	WaitForSingleObject(semaphore, INFINITE);
+}
+
+//false if the count was still 0 after the given time
+bool Semaphore::p(int milliseconds){
+	return WaitForSingleObject(semaphore, milliseconds)==WAIT_OBJECT_0;
+}
+
+void Semaphore::v(int count){
+	ReleaseSemaphore(semaphore, count, NULL);
+}
+
 }}//end namespace
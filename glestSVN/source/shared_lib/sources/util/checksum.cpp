@@ -39,6 +39,12 @@ void Checksum::addByte(int8 value){
 	sum+= cipher;
 }
 
+void Checksum::addInt(int32 value){
+	for(int i= 0; i<4; ++i){
+		addByte(static_cast<int8>(value >> (i*8)));
+	}
+}
+
 void Checksum::addString(const string &value){
 	for(int i= 0; i<value.size(); ++i){
 		addByte(value[i]);
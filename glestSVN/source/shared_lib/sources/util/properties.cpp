@@ -88,6 +88,10 @@ void Properties::clear(){
 	propertyVector.clear();
 }
 
+bool Properties::hasKey(const string &key) const{
+	return propertyMap.find(key)!=propertyMap.end();
+}
+
 bool Properties::getBool(const string &key) const{
 	try{
 		return strToBool(getString(key));
@@ -16,6 +16,7 @@
 #include <stdexcept>
 #include <cstring>
 #include <cstdio>
+#include <vector>
 
 #include "leak_dumper.h"
 
@@ -115,6 +116,36 @@ string toLower(const string &s){
 	return rs;
 }
 
+//lower case, forward slashes, no "." or ".." segments, so equal files give equal strings
+string cleanPath(const string &s){
+	vector<string> segments;
+	string segment;
+	string path= toLower(replaceBy(s, '\\', '/')) + "/";
+
+	for(size_t i=0; i<path.size(); ++i){
+		if(path[i]!='/'){
+			segment+= path[i];
+			continue;
+		}
+		if(segment==".." && !segments.empty() && segments.back()!=".."){
+			segments.pop_back();
+		}
+		else if(!segment.empty() && segment!="."){
+			segments.push_back(segment);
+		}
+		segment.clear();
+	}
+
+	string rs;
+	for(size_t i=0; i<segments.size(); ++i){
+		if(i>0){
+			rs+= '/';
+		}
+		rs+= segments[i];
+	}
+	return rs;
+}
+
 void copyStringToBuffer(char *buffer, int bufferSize, const string& s){
 	strncpy(buffer, s.c_str(), bufferSize-1);
 	buffer[bufferSize-1]= '\0';
@@ -15,6 +15,7 @@
 #include <stdexcept>
 
 #include "conversion.h"
+#include "util.h"
 
 #include <xercesc/dom/DOM.hpp>
 #include <xercesc/util/PlatformUtils.hpp>
@@ -72,6 +73,8 @@ XmlIo::XmlIo(){
 	catch(const DOMException){
 		throw runtime_error("Exception while creating XML parser");
 	}
+
+	preloadEnabled= false;
 }
 
 XmlIo &XmlIo::getInstance(){
@@ -80,30 +83,16 @@ XmlIo &XmlIo::getInstance(){
 }
 
 XmlIo::~XmlIo(){
+	clearPreloaded();
 	XMLPlatformUtils::Terminate();
 }
 
 XmlNode *XmlIo::load(const string &path){
-	
-	try{
-		ErrorHandler errorHandler;
-		DOMBuilder *parser= (static_cast<DOMImplementationLS*>(implementation))->createDOMBuilder(DOMImplementationLS::MODE_SYNCHRONOUS, 0);
-		parser->setErrorHandler(&errorHandler);
-		parser->setFeature(XMLUni::fgXercesSchemaFullChecking, true);
-		parser->setFeature(XMLUni::fgDOMValidation, true);
-		DOMDocument *document= parser->parseURI(path.c_str());
-		
-		if(document==NULL){
-			throw runtime_error("Can not parse URL: " + path);
-		}
-
-		XmlNode *rootNode= new XmlNode(document->getDocumentElement());
-		parser->release();
-		return rootNode;
+	XmlNode *rootNode= takePreloaded(path);
+	if(rootNode==NULL){
+		rootNode= parse(path);
 	}
-	catch(const DOMException &e){
-		throw runtime_error("Exception while loading: " + path + ": " + XMLString::transcode(e.msg));
-	}	
+	return rootNode;
 }
 
 void XmlIo::save(const string &path, const XmlNode *node){
@@ -128,6 +117,90 @@ void XmlIo::save(const string &path, const XmlNode *node){
 		throw runtime_error("Exception while saving: " + path + ": " + XMLString::transcode(e.msg));
 	}	
 }
+
+//disabling drops every document nobody took
+void XmlIo::setPreloadEnabled(bool preloadEnabled){
+	preloadMutex.p();
+	this->preloadEnabled= preloadEnabled;
+	if(!preloadEnabled){
+		clearPreloaded();
+	}
+	preloadMutex.v();
+}
+
+void XmlIo::preload(const string &path){
+	string key= cleanPath(path);
+
+	preloadMutex.p();
+	bool skip= !preloadEnabled || preloadedNodes.find(key)!=preloadedNodes.end() || claimedPaths.find(key)!=claimedPaths.end();
+	preloadMutex.v();
+	if(skip){
+		return;
+	}
+
+	//every parse has its own builder, so this can run next to the owner's loads
+	XmlNode *rootNode= parse(path);
+
+	preloadMutex.p();
+	if(preloadEnabled && claimedPaths.find(key)==claimedPaths.end() && preloadedNodes.find(key)==preloadedNodes.end()){
+		preloadedNodes[key]= rootNode;
+		rootNode= NULL;
+	}
+	preloadMutex.v();
+	delete rootNode;
+}
+
+// ==================== PRIVATE ==================== 
+
+XmlNode *XmlIo::parse(const string &path){
+	
+	try{
+		ErrorHandler errorHandler;
+		DOMBuilder *parser= (static_cast<DOMImplementationLS*>(implementation))->createDOMBuilder(DOMImplementationLS::MODE_SYNCHRONOUS, 0);
+		parser->setErrorHandler(&errorHandler);
+		parser->setFeature(XMLUni::fgXercesSchemaFullChecking, true);
+		parser->setFeature(XMLUni::fgDOMValidation, true);
+		DOMDocument *document= parser->parseURI(path.c_str());
+		
+		if(document==NULL){
+			throw runtime_error("Can not parse URL: " + path);
+		}
+
+		XmlNode *rootNode= new XmlNode(document->getDocumentElement());
+		parser->release();
+		return rootNode;
+	}
+	catch(const DOMException &e){
+		throw runtime_error("Exception while loading: " + path + ": " + XMLString::transcode(e.msg));
+	}	
+}
+
+XmlNode *XmlIo::takePreloaded(const string &path){
+	XmlNode *rootNode= NULL;
+
+	preloadMutex.p();
+	if(preloadEnabled){
+		string key= cleanPath(path);
+		claimedPaths.insert(key);
+		Nodes::iterator it= preloadedNodes.find(key);
+		if(it!=preloadedNodes.end()){
+			rootNode= it->second;
+			preloadedNodes.erase(it);
+		}
+	}
+	preloadMutex.v();
+
+	return rootNode;
+}
+
+void XmlIo::clearPreloaded(){
+	for(Nodes::iterator it= preloadedNodes.begin(); it!=preloadedNodes.end(); ++it){
+		delete it->second;
+	}
+	preloadedNodes.clear();
+	claimedPaths.clear();
+}
+
 // =====================================================
 //	class XmlTree
 // =====================================================